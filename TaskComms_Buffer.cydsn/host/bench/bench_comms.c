@@ -0,0 +1,305 @@
+/**
+* \file bench_comms.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Throughput and latency benchmark of the comms layer on the host
+*
+* Starts the unchanged application on the ErikaOS shim, injects a burst of
+* messages through the UART receiver and observes the forwarded lines of
+* tsk_uart. The first two bytes of every message carry its sequence number,
+* so latency (EOM received -> line forwarded) is measured per message and
+* lost messages are detected.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "project.h"
+#include "cpuload.h"
+#include "tft.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define BENCH_MESSAGES          1000        /**< \brief Default number of messages */
+#define BENCH_LENGTH            8           /**< \brief Default data bytes per message (without EOM) */
+#define BENCH_MAX_LENGTH        126         /**< \brief Longest message the comms layer accepts */
+#define BENCH_SEQ_BASE          250         /**< \brief Sequence digits, values 1..250 avoid the EOM marker */
+#define BENCH_START_TIMEOUT_MS  5000        /**< \brief Time allowed for tsk_init */
+#define BENCH_IDLE_TIMEOUT_MS   1000        /**< \brief Stop waiting once no line arrived for this time */
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+extern int app_main();
+
+static uint32_t             bench_messages = BENCH_MESSAGES;
+static uint64_t            *bench_eomNs;            /**< \brief Time the EOM of message i was received */
+static uint64_t            *bench_latencyNs;        /**< \brief Latency of every received message */
+static volatile uint32_t    bench_received;         /**< \brief Forwarded lines */
+static volatile uint32_t    bench_matched;          /**< \brief Forwarded lines with a valid sequence */
+static volatile uint64_t    bench_lastNs;           /**< \brief Time of the last forwarded line */
+
+static uint8_t              bench_field;            /**< \brief Number of the next value in the current line, 0 = outside */
+static uint32_t             bench_seq;              /**< \brief Sequence number being parsed */
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Observes the UART output of tsk_uart: "\r\nReceived: " v0 ", " v1 ... ".\n\r"
+ */
+static void bench_txHook(const char *string)
+{
+    if (0 == strcmp(string, "\r\nReceived: "))
+    {
+        bench_field = 1;
+        bench_seq   = 0;
+    }
+    else if ((0 != bench_field) && (0 == strcmp(string, ".\n\r")))
+    {
+        uint64_t now = HOST_getTimeNs();
+
+        if ((bench_field > 2) && (bench_seq < bench_messages) && (0 != bench_eomNs[bench_seq]))
+        {
+            bench_latencyNs[bench_matched++] = now - bench_eomNs[bench_seq];
+            bench_eomNs[bench_seq] = 0;     /* count duplicates only once */
+        }
+        bench_received++;
+        bench_lastNs = now;
+        bench_field  = 0;
+    }
+    else if ((0 != bench_field) && (bench_field <= 2) && (string[0] >= '0') && (string[0] <= '9'))
+    {
+        bench_seq = bench_seq * BENCH_SEQ_BASE + (uint32_t)(atoi(string) - 1);
+        bench_field++;
+    }
+}
+
+/**
+ * Runs the application, StartOS does not return.
+ */
+static void *bench_appThread(void *arg)
+{
+    (void)arg;
+    app_main();
+    return NULL;
+}
+
+/**
+ * Wait until tsk_init has terminated and the consumers wait for events.
+ */
+static int bench_waitStartup(void)
+{
+    for (uint32_t ms = 0; ms < BENCH_START_TIMEOUT_MS; ms++)
+    {
+        if ((HOST_OS_getTaskState(tsk_init)   == HOST_TASK_SUSPENDED)
+         && (HOST_OS_getTaskState(tsk_sender) == HOST_TASK_WAITING)
+         && (HOST_OS_getTaskState(tsk_tft)    == HOST_TASK_WAITING)
+         && (HOST_OS_getTaskState(tsk_uart)   == HOST_TASK_WAITING))
+        {
+            return 0;
+        }
+        usleep(1000);
+    }
+    return -1;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-n messages] [-l length] [-b baud] [-s script] [-v]\n"
+            "  -n  number of messages (default %u)\n"
+            "  -l  data bytes per message, 2..%u (default %u)\n"
+            "  -b  pace injection like a UART with this baud rate, 0 = back to back (default %u)\n"
+            "  -s  inject a script file instead of generated messages\n"
+            "  -v  echo the UART output of the application\n",
+            name, BENCH_MESSAGES, BENCH_MAX_LENGTH, BENCH_LENGTH, HOST_UART_BAUD);
+}
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t    length = BENCH_LENGTH;
+    uint32_t    baud   = HOST_UART_BAUD;
+    const char *script = NULL;
+    int         opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:l:b:s:vh")))
+    {
+        switch (opt)
+        {
+            case 'n': bench_messages = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': length         = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': baud           = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': script         = optarg;                              break;
+            case 'v': HOST_UART_setEcho(1);                                 break;
+            default:  bench_usage(argv[0]);                                 return 1;
+        }
+    }
+    if ((length < 2) || (length > BENCH_MAX_LENGTH) || (0 == bench_messages)
+        || (bench_messages > BENCH_SEQ_BASE * BENCH_SEQ_BASE))
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    bench_eomNs     = calloc(bench_messages, sizeof(uint64_t));
+    bench_latencyNs = calloc(bench_messages, sizeof(uint64_t));
+    if ((NULL == bench_eomNs) || (NULL == bench_latencyNs))
+    {
+        return 1;
+    }
+
+    /* Start the application and let tsk_init finish. */
+    pthread_t app;
+    pthread_create(&app, NULL, bench_appThread, NULL);
+    if (0 != bench_waitStartup())
+    {
+        fprintf(stderr, "application did not start\n");
+        return 1;
+    }
+
+    HOST_UART_setTxHook(bench_txHook);
+    HOST_UART_setBaud(baud);
+
+    uint64_t tftBytes0 = HOST_TFT_getTxBytes();
+    uint32_t switches0 = HOST_OS_getContextSwitches();
+    uint32_t dispatch0[EE_MAX_TASK];
+    for (TaskType t = 0; t < EE_MAX_TASK; t++)
+    {
+        dispatch0[t] = HOST_OS_getDispatches(t);
+    }
+    CPULOAD_resetPeak();
+
+    uint64_t start = HOST_getTimeNs();
+    uint32_t sent  = 0;
+
+    if (NULL != script)
+    {
+        int32_t n = HOST_UART_injectScript(script);
+        if (n < 0)
+        {
+            fprintf(stderr, "can not open %s\n", script);
+            return 1;
+        }
+        sent = (uint32_t)n;
+    }
+    else
+    {
+        uint8_t msg[BENCH_MAX_LENGTH + 1];
+        const uint8_t eom = '\0';
+
+        for (uint32_t i = 0; i < bench_messages; i++)
+        {
+            msg[0] = (uint8_t)(i / BENCH_SEQ_BASE + 1);
+            msg[1] = (uint8_t)(i % BENCH_SEQ_BASE + 1);
+            for (uint32_t k = 2; k < length; k++)
+            {
+                msg[k] = (uint8_t)((i + k) % BENCH_SEQ_BASE + 1);
+            }
+
+            HOST_UART_inject(msg, (uint16_t)length);
+            bench_eomNs[i] = HOST_getTimeNs();
+            HOST_UART_inject(&eom, 1);
+        }
+        sent = bench_messages;
+    }
+    uint64_t injected = HOST_getTimeNs();
+
+    /* Wait for the consumers to drain. */
+    bench_lastNs = injected;
+    while ((bench_received < sent)
+           && ((HOST_getTimeNs() - bench_lastNs) < (uint64_t)BENCH_IDLE_TIMEOUT_MS * 1000000u))
+    {
+        usleep(1000);
+    }
+    uint64_t end = (bench_received > 0) ? bench_lastNs : injected;
+
+    /* Report */
+    double   durationMs = (double)(end - start) / 1e6;
+    uint64_t tftBytes   = HOST_TFT_getTxBytes() - tftBytes0;
+    uint32_t switches   = HOST_OS_getContextSwitches() - switches0;
+
+    if (NULL != script)
+    {
+        printf("bench_comms: %u messages from %s, ", sent, script);
+    }
+    else
+    {
+        printf("bench_comms: %u messages x %u bytes, ", sent, length);
+    }
+    if (0 == baud)
+    {
+        printf("injected back to back\n");
+    }
+    else
+    {
+        printf("injected at %u baud\n", baud);
+    }
+    printf("  received       %u / %u (%u lost)\n", bench_received, sent,
+           (bench_received < sent) ? sent - bench_received : 0u);
+    printf("  duration       %.3f ms (injection %.3f ms)\n", durationMs, (double)(injected - start) / 1e6);
+    printf("  throughput     %.0f msg/s\n", (durationMs > 0.0) ? bench_received * 1000.0 / durationMs : 0.0);
+
+    if (bench_matched > 0)
+    {
+        uint64_t sum = 0;
+        qsort(bench_latencyNs, bench_matched, sizeof(uint64_t), bench_cmp);
+        for (uint32_t i = 0; i < bench_matched; i++)
+        {
+            sum += bench_latencyNs[i];
+        }
+        printf("  latency [us]   min %.1f  avg %.1f  p50 %.1f  p99 %.1f  max %.1f\n",
+               bench_latencyNs[0] / 1e3,
+               (double)sum / bench_matched / 1e3,
+               bench_latencyNs[bench_matched / 2] / 1e3,
+               bench_latencyNs[(bench_matched * 99u) / 100u] / 1e3,
+               bench_latencyNs[bench_matched - 1] / 1e3);
+    }
+
+    printf("  ctx switches   %u (%.2f per message)\n", switches, sent ? (double)switches / sent : 0.0);
+    printf("  dispatches     sender %u  tft %u  uart %u\n",
+           HOST_OS_getDispatches(tsk_sender) - dispatch0[tsk_sender],
+           HOST_OS_getDispatches(tsk_tft)    - dispatch0[tsk_tft],
+           HOST_OS_getDispatches(tsk_uart)   - dispatch0[tsk_uart]);
+    printf("  TFT SPI bytes  %llu (%.0f per message, %.3f ms bus time @ %u bit/s)\n",
+           (unsigned long long)tftBytes, sent ? (double)tftBytes / sent : 0.0,
+           tftBytes * 8.0 * 1000.0 / HOST_TFT_SPI_BITRATE, HOST_TFT_SPI_BITRATE);
+    printf("  TFT stream     %llu ST7735 errors, %u waits for room in the ringbuffer\n",
+           (unsigned long long)HOST_TFT_getStreamErrors(), TFT_getTxWaitCount());
+    printf("  CPU load peak  %u%%\n", CPULOAD_getPeak());
+
+    return ((bench_received == sent) && (0 == HOST_TFT_getStreamErrors())) ? 0 : 2;
+}
+
+/* [bench_comms.c] END OF FILE */
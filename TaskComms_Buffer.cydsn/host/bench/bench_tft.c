@@ -0,0 +1,877 @@
+/**
+* \file bench_tft.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief SPI traffic and time per character of the TFT text rendering
+*
+* Draws the printable characters of the classic font and of a large custom
+* font (FreeSans18pt7b, transparent by design) with the TFT driver on
+* the host stubs and reports per character: SPI bytes, command bytes (DC
+* low), SPI bus time and the execution time of the virtual time cost model
+* (function entries, register accesses, writes to a full TX FIFO). The TX
+* columns give the runs of the SPI TX service routine per byte and the share
+* of the execution time the bus is busy. The digits case redraws the same
+* few glyphs like a dashboard and shows the effect of the glyph cache. The
+* RLE cases draw the same digits from the run length coded subset font
+* FreeSans18pt7bDigits (host/tools/fontsubset).
+*
+* The frame cases repeat the pattern of tsk_tft (clear screen, title, the
+* values of a record) immediately and with the strip renderer
+* (TFT_beginFrame / TFT_endFrame) and report the traffic per frame. Build
+* with -DCFG_TFT_STRIP_BPP=8 or 4 for the palette strip buffer, with
+* -DCFG_TFT_STRIP_SKIP=ON to skip the unchanged full width strips.
+*
+* The shape cases draw outlines, filled shapes and lines and report the SPI
+* bytes per shape, build with -DCFG_TFT_SHAPE_SPANS=OFF to compare with the
+* scanline per line and pixel per point drawing.
+*
+* The fill cases compare solid fills. The CPU column is the execution time
+* without the time the CPU sleeps (WFI) while the TX interrupt or the DMA
+* moves the bytes, the DMA column counts the started TD chains.
+*
+* The call cases run every other drawing primitive of the TFT API once per
+* call, and the text measurement (TFT_getTextBounds with a repeated and a
+* new value, TFT_getNumberWidth) for its model time. The console case adds
+* a line to a full TFT console, which scrolls instead of redrawing the
+* screen (compare clearScreen). The queue cases put numbers into the draw
+* queue, which renders every 4th call, and show the cost of a queued call
+* and the traffic saved by dropping overdrawn numbers (compare printInt).
+* The bitmap cases draw a 16x16 icon from RGB565 pixels, from 1 bit pixels
+* and through a pixel source, each sends one window and 512 pixel bytes.
+* The font cases print
+* a line of text with every font. Both report
+* the traffic split by the ST7735 emulation of the stubs: command and data
+* bytes, CASET/RASET commands and RAMWR windows. The SPI clock of the bus
+* times is set with -s, -o writes a PPM image of the emulated panel after
+* every call and font case into a directory.
+*
+* All output passes the ST7735 command stream checker of the stubs, the
+* benchmark fails if it found a violation.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "project.h"
+#include "tft.h"
+#include "FreeMono12pt7b.h"
+#include "FreeMono18pt7b.h"
+#include "FreeMono24pt7b.h"
+#include "FreeMono9pt7b.h"
+#include "FreeMonoBold12pt7b.h"
+#include "FreeMonoBold18pt7b.h"
+#include "FreeMonoBold24pt7b.h"
+#include "FreeMonoBold9pt7b.h"
+#include "FreeMonoBoldOblique12pt7b.h"
+#include "FreeMonoBoldOblique18pt7b.h"
+#include "FreeMonoBoldOblique24pt7b.h"
+#include "FreeMonoBoldOblique9pt7b.h"
+#include "FreeMonoOblique12pt7b.h"
+#include "FreeMonoOblique18pt7b.h"
+#include "FreeMonoOblique24pt7b.h"
+#include "FreeMonoOblique9pt7b.h"
+#include "FreeSans12pt7b.h"
+#include "FreeSans18pt7b.h"
+#include "FreeSans18pt7bDigits.h"
+#include "FreeSans24pt7b.h"
+#include "FreeSans9pt7b.h"
+#include "FreeSansBold12pt7b.h"
+#include "FreeSansBold18pt7b.h"
+#include "FreeSansBold24pt7b.h"
+#include "FreeSansBold9pt7b.h"
+#include "FreeSansBoldOblique12pt7b.h"
+#include "FreeSansBoldOblique18pt7b.h"
+#include "FreeSansBoldOblique24pt7b.h"
+#include "FreeSansBoldOblique9pt7b.h"
+#include "FreeSansOblique12pt7b.h"
+#include "FreeSansOblique18pt7b.h"
+#include "FreeSansOblique24pt7b.h"
+#include "FreeSansOblique9pt7b.h"
+#include "FreeSerif12pt7b.h"
+#include "FreeSerif18pt7b.h"
+#include "FreeSerif24pt7b.h"
+#include "FreeSerif9pt7b.h"
+#include "FreeSerifBold12pt7b.h"
+#include "FreeSerifBold18pt7b.h"
+#include "FreeSerifBold24pt7b.h"
+#include "FreeSerifBold9pt7b.h"
+#include "FreeSerifBoldItalic12pt7b.h"
+#include "FreeSerifBoldItalic18pt7b.h"
+#include "FreeSerifBoldItalic24pt7b.h"
+#include "FreeSerifBoldItalic9pt7b.h"
+#include "FreeSerifItalic12pt7b.h"
+#include "FreeSerifItalic18pt7b.h"
+#include "FreeSerifItalic24pt7b.h"
+#include "FreeSerifItalic9pt7b.h"
+#include "Org_01.h"
+#include "Picopixel.h"
+#include "Tiny3x3a2pt7b.h"
+#include "TomThumb.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define BENCH_ROUNDS            20          /**< \brief Default passes over the printable characters */
+#define BENCH_FIRST_CHAR        ' '
+#define BENCH_LAST_CHAR         '~'
+#define BENCH_FRAMES            50          /**< \brief Frames per frame case */
+#define BENCH_VALUES            8           /**< \brief Values per record */
+#define BENCH_FILLS             20          /**< \brief Fills per fill case */
+#define BENCH_SHAPES            20          /**< \brief Shapes per shape case */
+#define BENCH_CALLS             20          /**< \brief Calls per call case */
+#define BENCH_ICON              16          /**< \brief Width and height of the icon of the bitmap cases */
+#define BENCH_FONT_TEXT         "Task Comms 0123456789"    /**< \brief Text of the font cases */
+
+/**
+ * \brief One measured rendering case
+ */
+typedef struct {
+    const char  *name;
+    uint8_t     size;                       /**< \brief Text size */
+    TFT_color_t color;                      /**< \brief Foreground */
+    TFT_color_t bg;                         /**< \brief Background, equal to color = transparent */
+    const char  *text;                      /**< \brief Characters of one pass, NULL = all printable */
+    const GFXfont *font;                    /**< \brief Custom font, NULL = classic font */
+} bench_case_t;
+
+/**
+ * \brief One measured frame case
+ */
+typedef struct {
+    const char  *name;
+    uint8_t     strips;                     /**< \brief Use the strip renderer */
+    uint8_t     changes;                    /**< \brief Values changing per frame */
+} bench_frame_t;
+
+/**
+ * \brief One measured fill case
+ */
+typedef struct {
+    const char  *name;
+    int16_t     w, h;                       /**< \brief Size, 0 = full screen */
+    TFT_color_t color;
+} bench_fill_t;
+
+ /**
+ * \brief Shapes of the shape cases
+ */
+typedef enum {
+    BENCH_CIRCLE,
+    BENCH_FILL_CIRCLE,
+    BENCH_ROUND_RECT,
+    BENCH_FILL_ROUND_RECT,
+    BENCH_TRIANGLE,
+    BENCH_FILL_TRIANGLE,
+    BENCH_RECT,
+    BENCH_LINE,
+    BENCH_CHART
+} bench_shape_kind_t;
+
+/**
+ * \brief One measured shape case
+ */
+typedef struct {
+    const char  *name;
+    bench_shape_kind_t kind;
+    int16_t     w, h;                       /**< \brief Bounding box */
+    int16_t     r;                          /**< \brief Radius of circles and corners */
+} bench_shape_t;
+
+/**
+ * \brief Primitives of the call cases
+ */
+typedef enum {
+    BENCH_PIXEL,
+    BENCH_HLINE,
+    BENCH_VLINE,
+    BENCH_CLEAR,
+    BENCH_PRINT,
+    BENCH_PRINT_INT,
+    BENCH_FIELD,
+    BENCH_INVERT,
+    BENCH_ROTATION,
+    BENCH_BOUNDS_SAME,
+    BENCH_BOUNDS_NEW,
+    BENCH_NUMBER_WIDTH,
+    BENCH_CONSOLE,
+    BENCH_QUEUE_SAME,
+    BENCH_QUEUE_MOVING,
+    BENCH_BITMAP565,
+    BENCH_BITMAP1,
+    BENCH_BITMAP_STREAM
+} bench_call_kind_t;
+
+/**
+ * \brief One measured call case
+ */
+typedef struct {
+    const char  *name;
+    bench_call_kind_t kind;
+    int16_t     len;                        /**< \brief Length of lines */
+} bench_call_t;
+
+/**
+ * \brief One font of the font cases
+ */
+typedef struct {
+    const char  *name;
+    const GFXfont *font;                    /**< \brief NULL = classic font */
+} bench_font_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+static uint32_t     bench_bitrate = HOST_TFT_SPI_BITRATE;  /**< \brief SPI clock of the bus times */
+static const char  *bench_ppmDir;           /**< \brief Directory of the PPM images, NULL = none */
+static TFT_field_t  bench_field = TFT_FIELD_INVALID;
+static uint16_t     bench_icon565[BENCH_ICON * BENCH_ICON];     /**< \brief Icon of the bitmap cases */
+static uint8_t      bench_icon1[BENCH_ICON * BENCH_ICON / 8];   /**< \brief Icon of the bitmap cases, 1 bit */
+
+static const bench_case_t bench_cases[] = {
+    { "drawChar 1x opaque",      1, WHITE, BLACK, NULL,           NULL },
+    { "drawChar 1x transparent", 1, WHITE, WHITE, NULL,           NULL },
+    { "drawChar 2x opaque",      2, WHITE, BLACK, NULL,           NULL },
+    { "drawChar 3x opaque",      3, WHITE, BLACK, NULL,           NULL },
+    { "drawChar 1x digits",      1, WHITE, BLACK, "0123456789.:", NULL },
+    { "drawChar 2x digits",      2, WHITE, BLACK, "0123456789.:", NULL },
+    { "FreeSans18pt 1x",         1, WHITE, WHITE, NULL,           &FreeSans18pt7b },
+    { "FreeSans18pt 1x digits",  1, WHITE, WHITE, "0123456789.:", &FreeSans18pt7b },
+    { "FreeSans18pt 2x digits",  2, WHITE, WHITE, "0123456789.:", &FreeSans18pt7b },
+    { "FreeSans18 RLE 1x digits", 1, WHITE, WHITE, "0123456789.:", &FreeSans18pt7bDigits },
+    { "FreeSans18 RLE 2x digits", 2, WHITE, WHITE, "0123456789.:", &FreeSans18pt7bDigits },
+};
+
+static const bench_frame_t bench_frames[] = {
+    { "immediate, 1 value new",  0, 1 },
+    { "strips, 1 value new",     1, 1 },
+    { "strips, all values new",  1, BENCH_VALUES },
+    { "strips, unchanged",       1, 0 },
+};
+
+static const bench_fill_t bench_fills[] = {
+    { "fillScreen black",        0,  0,  BLACK },
+    { "fillScreen blue",         0,  0,  BLUE },
+    { "fillRect 64x64",          64, 64, GREEN },
+    { "fillRect 16x16",          16, 16, GREEN },
+    { "fillRect 4x4",            4,  4,  GREEN },
+};
+
+static const bench_shape_t bench_shapes[] = {
+    { "drawCircle r=30",         BENCH_CIRCLE,          61, 61, 30 },
+    { "fillCircle r=30",         BENCH_FILL_CIRCLE,     61, 61, 30 },
+    { "fillCircle r=8",          BENCH_FILL_CIRCLE,     17, 17, 8 },
+    { "drawRoundRect 60x40 r=8", BENCH_ROUND_RECT,      60, 40, 8 },
+    { "fillRoundRect 60x40 r=8", BENCH_FILL_ROUND_RECT, 60, 40, 8 },
+    { "drawTriangle 60x40",      BENCH_TRIANGLE,        60, 40, 0 },
+    { "fillTriangle 60x40",      BENCH_FILL_TRIANGLE,   60, 40, 0 },
+    { "drawRect 60x40",          BENCH_RECT,            60, 40, 0 },
+    { "writeLine 60x1",          BENCH_LINE,            60, 1,  0 },
+    { "writeLine 1x60",          BENCH_LINE,            1,  60, 0 },
+    { "writeLine 60x10",         BENCH_LINE,            60, 10, 0 },
+    { "writeLine 10x60",         BENCH_LINE,            10, 60, 0 },
+    { "writeLine 40x40",         BENCH_LINE,            40, 40, 0 },
+    { "chart 12 segments 96x48", BENCH_CHART,           96, 48, 0 },
+};
+
+static const bench_call_t bench_calls[] = {
+    { "drawPixel",               BENCH_PIXEL,           0 },
+    { "fastHLine 60",            BENCH_HLINE,           60 },
+    { "fastVLine 60",            BENCH_VLINE,           60 },
+    { "clearScreen",             BENCH_CLEAR,           0 },
+    { "print 10 chars",          BENCH_PRINT,           0 },
+    { "printInt 5 digits",       BENCH_PRINT_INT,       0 },
+    { "field_set 1 of 7 new",    BENCH_FIELD,           0 },
+    { "invertDisplay",           BENCH_INVERT,          0 },
+    { "setRotation",             BENCH_ROTATION,        0 },
+    { "getTextBounds same value", BENCH_BOUNDS_SAME,    0 },
+    { "getTextBounds new value", BENCH_BOUNDS_NEW,      0 },
+    { "getNumberWidth",          BENCH_NUMBER_WIDTH,    0 },
+    { "console_print full",      BENCH_CONSOLE,         0 },
+    { "queue_number same place", BENCH_QUEUE_SAME,      0 },
+    { "queue_number moving",     BENCH_QUEUE_MOVING,    0 },
+    { "drawBitmap565 16x16",     BENCH_BITMAP565,       BENCH_ICON },
+    { "drawBitmap1 16x16",       BENCH_BITMAP1,         BENCH_ICON },
+    { "drawBitmapStream 16x16",  BENCH_BITMAP_STREAM,   BENCH_ICON },
+};
+
+static const bench_font_t bench_fonts[] = {
+    { "classic (glcdfont)", NULL },
+    { "FreeMono12pt7b", &FreeMono12pt7b },
+    { "FreeMono18pt7b", &FreeMono18pt7b },
+    { "FreeMono24pt7b", &FreeMono24pt7b },
+    { "FreeMono9pt7b", &FreeMono9pt7b },
+    { "FreeMonoBold12pt7b", &FreeMonoBold12pt7b },
+    { "FreeMonoBold18pt7b", &FreeMonoBold18pt7b },
+    { "FreeMonoBold24pt7b", &FreeMonoBold24pt7b },
+    { "FreeMonoBold9pt7b", &FreeMonoBold9pt7b },
+    { "FreeMonoBoldOblique12pt7b", &FreeMonoBoldOblique12pt7b },
+    { "FreeMonoBoldOblique18pt7b", &FreeMonoBoldOblique18pt7b },
+    { "FreeMonoBoldOblique24pt7b", &FreeMonoBoldOblique24pt7b },
+    { "FreeMonoBoldOblique9pt7b", &FreeMonoBoldOblique9pt7b },
+    { "FreeMonoOblique12pt7b", &FreeMonoOblique12pt7b },
+    { "FreeMonoOblique18pt7b", &FreeMonoOblique18pt7b },
+    { "FreeMonoOblique24pt7b", &FreeMonoOblique24pt7b },
+    { "FreeMonoOblique9pt7b", &FreeMonoOblique9pt7b },
+    { "FreeSans12pt7b", &FreeSans12pt7b },
+    { "FreeSans18pt7b", &FreeSans18pt7b },
+    { "FreeSans24pt7b", &FreeSans24pt7b },
+    { "FreeSans9pt7b", &FreeSans9pt7b },
+    { "FreeSansBold12pt7b", &FreeSansBold12pt7b },
+    { "FreeSansBold18pt7b", &FreeSansBold18pt7b },
+    { "FreeSansBold24pt7b", &FreeSansBold24pt7b },
+    { "FreeSansBold9pt7b", &FreeSansBold9pt7b },
+    { "FreeSansBoldOblique12pt7b", &FreeSansBoldOblique12pt7b },
+    { "FreeSansBoldOblique18pt7b", &FreeSansBoldOblique18pt7b },
+    { "FreeSansBoldOblique24pt7b", &FreeSansBoldOblique24pt7b },
+    { "FreeSansBoldOblique9pt7b", &FreeSansBoldOblique9pt7b },
+    { "FreeSansOblique12pt7b", &FreeSansOblique12pt7b },
+    { "FreeSansOblique18pt7b", &FreeSansOblique18pt7b },
+    { "FreeSansOblique24pt7b", &FreeSansOblique24pt7b },
+    { "FreeSansOblique9pt7b", &FreeSansOblique9pt7b },
+    { "FreeSerif12pt7b", &FreeSerif12pt7b },
+    { "FreeSerif18pt7b", &FreeSerif18pt7b },
+    { "FreeSerif24pt7b", &FreeSerif24pt7b },
+    { "FreeSerif9pt7b", &FreeSerif9pt7b },
+    { "FreeSerifBold12pt7b", &FreeSerifBold12pt7b },
+    { "FreeSerifBold18pt7b", &FreeSerifBold18pt7b },
+    { "FreeSerifBold24pt7b", &FreeSerifBold24pt7b },
+    { "FreeSerifBold9pt7b", &FreeSerifBold9pt7b },
+    { "FreeSerifBoldItalic12pt7b", &FreeSerifBoldItalic12pt7b },
+    { "FreeSerifBoldItalic18pt7b", &FreeSerifBoldItalic18pt7b },
+    { "FreeSerifBoldItalic24pt7b", &FreeSerifBoldItalic24pt7b },
+    { "FreeSerifBoldItalic9pt7b", &FreeSerifBoldItalic9pt7b },
+    { "FreeSerifItalic12pt7b", &FreeSerifItalic12pt7b },
+    { "FreeSerifItalic18pt7b", &FreeSerifItalic18pt7b },
+    { "FreeSerifItalic24pt7b", &FreeSerifItalic24pt7b },
+    { "FreeSerifItalic9pt7b", &FreeSerifItalic9pt7b },
+    { "Org_01", &Org_01 },
+    { "Picopixel", &Picopixel },
+    { "Tiny3x3a2pt7b", &Tiny3x3a2pt7b },
+    { "TomThumb", &TomThumb },
+};
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Host time independent of the virtual clock.
+ */
+static uint64_t bench_hostNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Wait until the TFT driver has sent everything, counts as execution time.
+ */
+static void bench_drain(void)
+{
+    while (!HOST_TFT_isTxIdle())
+    {
+        HOST_SIM_idle();
+    }
+}
+
+/**
+ * SPI bus time of a number of bytes at the configured clock.
+ */
+static double bench_busUs(double bytes)
+{
+    return bytes * 8.0 * 1e6 / bench_bitrate;
+}
+
+/**
+ * Save the emulated panel as <dir>/<prefix>_<name>.ppm if -o was given.
+ */
+static void bench_snapshot(const char *prefix, const char *name)
+{
+    char path[256];
+    int  n;
+
+    if (NULL == bench_ppmDir)
+    {
+        return;
+    }
+    bench_drain();
+    n = snprintf(path, sizeof(path), "%s/%s_", bench_ppmDir, prefix);
+    for (const char *c = name; (*c != '\0') && (n < (int)sizeof(path) - 5); c++)
+    {
+        path[n++] = (((*c >= '0') && (*c <= '9')) || ((*c >= 'A') && (*c <= 'Z')) || ((*c >= 'a') && (*c <= 'z')))
+                  ? *c : '_';
+    }
+    strcpy(&path[n], ".ppm");
+    if (0 != HOST_TFT_writePpm(path))
+    {
+        fprintf(stderr, "bench_tft: can not write %s\n", path);
+    }
+}
+
+/**
+ * Print the traffic of a call or font case per unit.
+ */
+static void bench_stats(const char *name, const HOST_TFT_stats_t *s0, uint64_t model0, double units)
+{
+    HOST_TFT_stats_t s;
+
+    HOST_TFT_getStats(&s);
+    printf("  %-26s %10.1f %10.1f %10.1f %8.2f %8.2f %8.2f %10.1f %10.1f\n", name,
+           (double)(s.txBytes - s0->txBytes) / units,
+           (double)(s.cmdBytes - s0->cmdBytes) / units,
+           (double)(s.dataBytes - s0->dataBytes) / units,
+           (double)(s.caset - s0->caset) / units,
+           (double)(s.raset - s0->raset) / units,
+           (double)(s.ramwr - s0->ramwr) / units,
+           bench_busUs((double)(s.txBytes - s0->txBytes) / units),
+           (double)(HOST_SIM_now() - model0) / units / 1e3);
+}
+
+/**
+ * Pixel source of the stream case, hands out the icon in chunks of 8 pixels
+ * like a ringbuffer filled by the UART.
+ */
+static uint16_t bench_iconSource(TFT_color_t *pixels, uint16_t n, void *arg)
+{
+    uint16_t *pos = (uint16_t *)arg;
+    uint16_t  i;
+
+    for (i = 0; (i < n) && (i < 8) && (*pos < BENCH_ICON * BENCH_ICON); i++)
+    {
+        pixels[i] = bench_icon565[(*pos)++];
+    }
+    return i;
+}
+
+/**
+ * Call of a call case, the position changes with the call number.
+ */
+static void bench_call(const bench_call_t *bc, uint32_t n)
+{
+    int16_t x = (int16_t)((n * 7) % (TFT_width() - bc->len));
+    int16_t y = (int16_t)((n * 13) % (TFT_height() - bc->len));
+    char    text[CFG_TFT_FIELD_LEN + 8];
+
+    switch (bc->kind)
+    {
+        case BENCH_PIXEL:       TFT_drawPixel(x, y, (n & 1) ? YELLOW : BLUE); break;
+        case BENCH_HLINE:       TFT_fastHLine(x, y, bc->len, (n & 1) ? YELLOW : BLUE); break;
+        case BENCH_VLINE:       TFT_fastVLine(x, y, bc->len, (n & 1) ? YELLOW : BLUE); break;
+        case BENCH_CLEAR:       TFT_clearScreen(); break;
+        case BENCH_PRINT:
+            TFT_setCursor(x % 64, y % (TFT_height() - 8));
+            TFT_print("Task Comms");
+            break;
+        case BENCH_PRINT_INT:
+            TFT_setCursor(x % 64, y % (TFT_height() - 8));
+            TFT_printInt((uint16_t)(10000 + n));
+            break;
+        case BENCH_FIELD:
+            /* One of seven values changes, like a dashboard line. */
+            for (uint32_t v = 0; v < 7; v++)
+            {
+                snprintf(&text[v * 3], 4, "%2u ", (unsigned)((n % 7 == v) ? n % 100 : v));
+            }
+            (void)TFT_field_set(bench_field, text);
+            break;
+        case BENCH_INVERT:      TFT_invertDisplay((n & 1) ? TRUE : FALSE); break;
+        case BENCH_ROTATION:    TFT_setRotation((TFT_rotation_t)((CFG_TFT_ORIENTATION + n + 1) % 4)); break;
+        case BENCH_BOUNDS_SAME:
+        case BENCH_BOUNDS_NEW:
+        {
+            /* Right aligning a 5 digit value, which stays or changes per call. */
+            int16_t  x1, y1;
+            uint16_t w, h;
+            snprintf(text, sizeof(text), "%u", (unsigned)((BENCH_BOUNDS_NEW == bc->kind) ? 10000 + n : 12345));
+            TFT_getTextBounds(text, x, y, &x1, &y1, &w, &h);
+            break;
+        }
+        case BENCH_NUMBER_WIDTH: (void)TFT_getNumberWidth((int32_t)(10000 + n)); break;
+        case BENCH_CONSOLE:
+            /* One log line per received message. */
+            snprintf(text, sizeof(text), "rec %5u: %3u %3u %3u", (unsigned)n, (unsigned)(n % 7), (unsigned)(n % 100), 42u);
+            (void)TFT_console_print(text);
+            break;
+        case BENCH_QUEUE_SAME:
+        case BENCH_QUEUE_MOVING:
+            /* A counter updated faster than the render task runs. */
+            if (BENCH_QUEUE_SAME == bc->kind)
+            {
+                x = 40;
+                y = 40;
+            }
+            (void)TFT_queue_number(x % 64, y % (TFT_height() - 8), (int32_t)(10000 + n), 5, WHITE, BLACK, 1);
+            if (3 == (n % 4))
+            {
+                (void)TFT_queue_render();
+            }
+            break;
+        case BENCH_BITMAP565:   TFT_drawBitmap565(x, y, BENCH_ICON, BENCH_ICON, bench_icon565); break;
+        case BENCH_BITMAP1:     TFT_drawBitmap1(x, y, BENCH_ICON, BENCH_ICON, bench_icon1, YELLOW, BLUE); break;
+        case BENCH_BITMAP_STREAM:
+        {
+            uint16_t pos = 0;
+            (void)TFT_drawBitmapStream(x, y, BENCH_ICON, BENCH_ICON, bench_iconSource, &pos);
+            break;
+        }
+    }
+}
+
+/**
+ * Frame of tsk_tft: clear, title, values of the latest record.
+ */
+static void bench_frame(const bench_frame_t *bf, uint32_t frame)
+{
+    if (0 != bf->strips)
+    {
+        TFT_beginFrame();
+    }
+    TFT_clearScreen();
+    TFT_setCursor(0, 0);
+    TFT_print("Task Comms\n");
+    for (uint8_t i = 0; i < BENCH_VALUES; i++)
+    {
+        TFT_setCursor(0 + i * 16, 20);
+        TFT_printInt((uint16_t)((i < bf->changes) ? (frame + i) % 100 : 10 + i));
+    }
+    if (0 != bf->strips)
+    {
+        TFT_endFrame();
+    }
+}
+
+/**
+ * Shape of a shape case at x, y.
+ */
+static void bench_shape(const bench_shape_t *bs, int16_t x, int16_t y, TFT_color_t color)
+{
+    switch (bs->kind)
+    {
+        case BENCH_CIRCLE:          TFT_drawCircle(x + bs->r, y + bs->r, bs->r, color); break;
+        case BENCH_FILL_CIRCLE:     TFT_fillCircle(x + bs->r, y + bs->r, bs->r, color); break;
+        case BENCH_ROUND_RECT:      TFT_drawRoundRect(x, y, bs->w, bs->h, bs->r, color); break;
+        case BENCH_FILL_ROUND_RECT: TFT_fillRoundRect(x, y, bs->w, bs->h, bs->r, color); break;
+        case BENCH_TRIANGLE:
+            TFT_drawTriangle(x + bs->w / 2, y, x, y + bs->h - 1, x + bs->w - 1, y + bs->h - 1, color);
+            break;
+        case BENCH_FILL_TRIANGLE:
+            TFT_fillTriangle(x + bs->w / 2, y, x, y + bs->h - 1, x + bs->w - 1, y + bs->h - 1, color);
+            break;
+        case BENCH_RECT:            TFT_drawRect(x, y, bs->w, bs->h, color); break;
+        case BENCH_LINE:            TFT_writeLine(x, y, x + bs->w - 1, y + bs->h - 1, color); break;
+        case BENCH_CHART:
+            /* Polyline of a value curve like a trend chart. */
+            for (int16_t i = 0; i < 12; i++)
+            {
+                static const uint8_t v[13] = { 20, 34, 41, 30, 12, 5, 18, 44, 47, 39, 25, 22, 28 };
+                int16_t dx = bs->w / 12;
+                TFT_writeLine(x + i * dx, y + v[i] * (bs->h - 1) / 47, x + (i + 1) * dx, y + v[i + 1] * (bs->h - 1) / 47, color);
+            }
+            break;
+    }
+}
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t rounds = BENCH_ROUNDS;
+    int      opt;
+
+    while (-1 != (opt = getopt(argc, argv, "r:s:o:h")))
+    {
+        switch (opt)
+        {
+            case 'r': rounds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': bench_bitrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': bench_ppmDir = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-r rounds] [-s SPI bit/s] [-o PPM directory]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (0 == bench_bitrate)
+    {
+        fprintf(stderr, "bench_tft: SPI clock must not be 0\n");
+        return 1;
+    }
+
+    /* Virtual time gives the modelled execution time, no OS is started. */
+    HOST_SIM_cost_t cost = HOST_SIM_COST_DEFAULT;
+    cost.spiByteNs = (uint32_t)((8ull * 1000000000u) / bench_bitrate);
+    HOST_SIM_enable(&cost);
+    TFT_init();
+
+    printf("bench_tft: %u passes per case, SPI %u bit/s, TX %s%s\n", rounds, bench_bitrate,
+           (CFG_TFT_SPI_TX_IRQ == ON) ? "interrupt" : "polled", (CFG_TFT_DMA == ON) ? ", DMA" : "");
+    printf("  %-24s %10s %10s %10s %10s %10s %10s %10s %10s\n", "per character", "SPI bytes", "cmd bytes", "bus [us]",
+           "model [us]", "host [ns]", "cache hit", "TX runs/B", "bus load");
+
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++)
+    {
+        const bench_case_t *bc = &bench_cases[k];
+        int16_t  ch    = (NULL == bc->font) ? 8 * bc->size : bc->font->yAdvance * bc->size;
+        int16_t  y0    = (NULL == bc->font) ? 0 : ch;  /* custom fonts are drawn at the baseline */
+        uint32_t chars = 0;
+        int16_t  x     = 0;
+        int16_t  y     = y0;
+
+        TFT_setFont(bc->font);
+
+        uint32_t hits0, misses0, hits, misses;
+
+        TFT_clearGlyphCache();
+        TFT_getGlyphCacheStats(&hits0, &misses0);
+        bench_drain();
+
+        uint64_t bytes0 = HOST_TFT_getTxBytes();
+        uint64_t cmd0   = HOST_TFT_getCmdBytes();
+        uint32_t isr0   = TFT_getTxIsrCount();
+        uint64_t model0 = HOST_SIM_now();
+        uint64_t host0  = bench_hostNs();
+
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            for (unsigned char c = BENCH_FIRST_CHAR; c <= BENCH_LAST_CHAR; c++)
+            {
+                if ((NULL != bc->text) && (NULL == strchr(bc->text, c)))
+                {
+                    continue;
+                }
+                int16_t cw = (NULL == bc->font) ? 6 * bc->size
+                           : bc->font->glyph[c - bc->font->first].xAdvance * bc->size;
+
+                /* Fill the screen line by line, like the application does. */
+                if ((x + cw) > TFT_width())
+                {
+                    x  = 0;
+                    y += ch;
+                    if ((y + ch) > TFT_height())
+                    {
+                        y = y0;
+                    }
+                }
+                TFT_drawChar(x, y, c, bc->color, bc->bg, bc->size);
+                chars++;
+                x += cw;
+            }
+        }
+
+        bench_drain();
+        TFT_getGlyphCacheStats(&hits, &misses);
+        hits   -= hits0;
+        misses -= misses0;
+
+        double bytes = (double)(HOST_TFT_getTxBytes() - bytes0) / chars;
+        double model = (double)(HOST_SIM_now() - model0) / chars / 1e3;
+        printf("  %-24s %10.1f %10.1f %10.1f %10.1f %10.0f %9.0f%% %10.3f %9.0f%%\n", bc->name,
+               bytes,
+               (double)(HOST_TFT_getCmdBytes() - cmd0) / chars,
+               bytes * 8.0 * 1e6 / bench_bitrate,
+               model,
+               (double)(bench_hostNs() - host0) / chars,
+               (hits + misses) ? 100.0 * hits / (hits + misses) : 0.0,
+               (double)(TFT_getTxIsrCount() - isr0) / chars / bytes,
+               100.0 * bytes * 8.0 * 1e6 / bench_bitrate / model);
+    }
+
+    printf("\n  %-24s %10s %10s %10s %10s %10s %10s %10s %10s\n", "per frame", "SPI bytes", "cmd bytes", "bus [us]",
+           "model [us]", "CPU [us]", "host [ns]", "TX runs/B", "bus load");
+    TFT_setFont(NULL);
+    for (size_t k = 0; k < sizeof(bench_frames) / sizeof(bench_frames[0]); k++)
+    {
+        const bench_frame_t *bf = &bench_frames[k];
+
+        bench_frame(bf, 0);                 /* screen content of the previous frame */
+        bench_drain();
+
+        uint64_t bytes0 = HOST_TFT_getTxBytes();
+        uint64_t cmd0   = HOST_TFT_getCmdBytes();
+        uint32_t isr0   = TFT_getTxIsrCount();
+        uint64_t model0 = HOST_SIM_now();
+        uint64_t idle0  = HOST_SIM_getIdleNs();
+        uint64_t host0  = bench_hostNs();
+
+        for (uint32_t f = 1; f <= BENCH_FRAMES; f++)
+        {
+            bench_frame(bf, f);
+        }
+        bench_drain();
+
+        double bytes = (double)(HOST_TFT_getTxBytes() - bytes0) / BENCH_FRAMES;
+        double model = (double)(HOST_SIM_now() - model0) / BENCH_FRAMES / 1e3;
+        printf("  %-24s %10.0f %10.1f %10.1f %10.1f %10.1f %10.0f %10.3f %9.0f%%\n", bf->name,
+               bytes,
+               (double)(HOST_TFT_getCmdBytes() - cmd0) / BENCH_FRAMES,
+               bytes * 8.0 * 1e6 / bench_bitrate,
+               model,
+               model - (double)(HOST_SIM_getIdleNs() - idle0) / BENCH_FRAMES / 1e3,
+               (double)(bench_hostNs() - host0) / BENCH_FRAMES,
+               (bytes > 0.0) ? (double)(TFT_getTxIsrCount() - isr0) / BENCH_FRAMES / bytes : 0.0,
+               100.0 * bytes * 8.0 * 1e6 / bench_bitrate / model);
+    }
+
+    printf("\n  %-24s %10s %10s %10s %10s %10s\n", "per shape", "SPI bytes", "cmd bytes", "bus [us]",
+           "model [us]", "host [ns]");
+    for (size_t k = 0; k < sizeof(bench_shapes) / sizeof(bench_shapes[0]); k++)
+    {
+        const bench_shape_t *bs = &bench_shapes[k];
+
+        bench_drain();
+
+        uint64_t bytes0 = HOST_TFT_getTxBytes();
+        uint64_t cmd0   = HOST_TFT_getCmdBytes();
+        uint64_t model0 = HOST_SIM_now();
+        uint64_t host0  = bench_hostNs();
+
+        /* Different places, a shape never starts with the window of the previous one. */
+        for (uint32_t f = 0; f < BENCH_SHAPES; f++)
+        {
+            bench_shape(bs, (int16_t)((f * 7) % (TFT_width() - bs->w)), (int16_t)((f * 13) % (TFT_height() - bs->h)),
+                        (f & 1) ? YELLOW : BLUE);
+        }
+        bench_drain();
+
+        double bytes = (double)(HOST_TFT_getTxBytes() - bytes0) / BENCH_SHAPES;
+        printf("  %-24s %10.0f %10.1f %10.1f %10.1f %10.0f\n", bs->name,
+               bytes,
+               (double)(HOST_TFT_getCmdBytes() - cmd0) / BENCH_SHAPES,
+               bytes * 8.0 * 1e6 / bench_bitrate,
+               (double)(HOST_SIM_now() - model0) / BENCH_SHAPES / 1e3,
+               (double)(bench_hostNs() - host0) / BENCH_SHAPES);
+    }
+
+    printf("\n  %-24s %10s %10s %10s %10s %10s %10s %10s\n", "per fill", "SPI bytes", "bus [us]", "model [us]",
+           "CPU [us]", "host [ns]", "TX runs/B", "DMA");
+    for (size_t k = 0; k < sizeof(bench_fills) / sizeof(bench_fills[0]); k++)
+    {
+        const bench_fill_t *bf = &bench_fills[k];
+        int16_t w = (0 == bf->w) ? TFT_width()  : bf->w;
+        int16_t h = (0 == bf->h) ? TFT_height() : bf->h;
+
+        bench_drain();
+
+        uint64_t bytes0 = HOST_TFT_getTxBytes();
+        uint32_t isr0   = TFT_getTxIsrCount();
+        uint32_t dma0   = TFT_getDmaCount();
+        uint64_t model0 = HOST_SIM_now();
+        uint64_t idle0  = HOST_SIM_getIdleNs();
+        uint64_t host0  = bench_hostNs();
+
+        for (uint32_t f = 0; f < BENCH_FILLS; f++)
+        {
+            TFT_fillRect(0, 0, w, h, bf->color);
+        }
+        bench_drain();
+
+        double bytes = (double)(HOST_TFT_getTxBytes() - bytes0) / BENCH_FILLS;
+        double model = (double)(HOST_SIM_now() - model0) / BENCH_FILLS / 1e3;
+        printf("  %-24s %10.0f %10.1f %10.1f %10.1f %10.0f %10.3f %10.1f\n", bf->name,
+               bytes,
+               bytes * 8.0 * 1e6 / bench_bitrate,
+               model,
+               model - (double)(HOST_SIM_getIdleNs() - idle0) / BENCH_FILLS / 1e3,
+               (double)(bench_hostNs() - host0) / BENCH_FILLS,
+               (double)(TFT_getTxIsrCount() - isr0) / BENCH_FILLS / bytes,
+               (double)(TFT_getDmaCount() - dma0) / BENCH_FILLS);
+    }
+
+    printf("\n  %-26s %10s %10s %10s %8s %8s %8s %10s %10s\n", "per call", "SPI bytes", "cmd bytes", "data bytes",
+           "CASET", "RASET", "RAMWR", "bus [us]", "model [us]");
+    TFT_setFont(NULL);
+    TFT_setTextSize(1);
+    TFT_setColors(WHITE, BLACK);
+    bench_field = TFT_field_create(0, 150, 21, NULL);
+    for (uint16_t i = 0; i < BENCH_ICON * BENCH_ICON; i++)
+    {
+        /* Gradient with a diagonal cross. */
+        uint16_t px = i % BENCH_ICON, py = i / BENCH_ICON;
+        bench_icon565[i] = ((px == py) || (px + py == BENCH_ICON - 1)) ? WHITE : (uint16_t)((px << 12) | (py << 1));
+        if ((px == py) || (px + py == BENCH_ICON - 1))
+        {
+            bench_icon1[i / 8] |= (uint8_t)(0x80 >> (i % 8));
+        }
+    }
+    for (size_t k = 0; k < sizeof(bench_calls) / sizeof(bench_calls[0]); k++)
+    {
+        const bench_call_t *bc = &bench_calls[k];
+        HOST_TFT_stats_t    s0;
+
+        TFT_clearScreen();
+        if (BENCH_CONSOLE == bc->kind)
+        {
+            /* Steady state: every line scrolls the oldest one out. */
+            (void)TFT_console_start(0, 0);
+            for (uint32_t n = 0; n < BENCH_CALLS; n++)
+            {
+                (void)TFT_console_print("filler");
+            }
+        }
+        bench_drain();
+        HOST_TFT_getStats(&s0);
+        uint64_t model0 = HOST_SIM_now();
+
+        for (uint32_t n = 0; n < BENCH_CALLS; n++)
+        {
+            bench_call(bc, n);
+        }
+        bench_drain();
+        bench_stats(bc->name, &s0, model0, BENCH_CALLS);
+        bench_snapshot("call", bc->name);
+        TFT_console_stop();
+    }
+    TFT_setRotation(CFG_TFT_ORIENTATION);
+    TFT_invertDisplay(FALSE);
+
+    printf("\n  %-26s %10s %10s %10s %8s %8s %8s %10s %10s\n", "per character of a line", "SPI bytes", "cmd bytes",
+           "data bytes", "CASET", "RASET", "RAMWR", "bus [us]", "model [us]");
+    for (size_t k = 0; k < sizeof(bench_fonts) / sizeof(bench_fonts[0]); k++)
+    {
+        const bench_font_t *bf = &bench_fonts[k];
+        HOST_TFT_stats_t    s0;
+
+        TFT_clearScreen();
+        TFT_setFont(bf->font);
+        TFT_clearGlyphCache();
+        bench_drain();
+        HOST_TFT_getStats(&s0);
+        uint64_t model0 = HOST_SIM_now();
+
+        /* custom fonts are drawn at the baseline */
+        TFT_setCursor(0, (NULL == bf->font) ? 0 : bf->font->yAdvance);
+        TFT_print(BENCH_FONT_TEXT);
+        bench_drain();
+        bench_stats(bf->name, &s0, model0, strlen(BENCH_FONT_TEXT));
+        bench_snapshot("font", bf->name);
+    }
+    TFT_setFont(NULL);
+
+    printf("\n  DC changes while the SPI was busy: %llu\n", (unsigned long long)HOST_TFT_getDcGlitches());
+    printf("  ST7735 stream errors: %llu\n", (unsigned long long)HOST_TFT_getStreamErrors());
+    printf("  waits for room in the ringbuffer: %u\n", TFT_getTxWaitCount());
+
+    return (0 == HOST_TFT_getStreamErrors()) ? 0 : 2;
+}
+
+/* [bench_tft.c] END OF FILE */
@@ -0,0 +1,1254 @@
+/**
+* \file check_tft.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Pixel check of the TFT driver against a reference rasteriser
+*
+* Draws random instances of every drawing primitive and characters of every
+* font with the TFT driver on the host stubs and compares the frame memory
+* of the ST7735 emulation (HOST_TFT_getPixel) with the same calls rendered
+* pixel by pixel by the plain Adafruit GFX algorithms below. The driver
+* draws the same pixels in fewer SPI transfers (windows, runs, spans, glyph
+* blits, caches), any difference is an error.
+*
+* Every call is compared in the area the reference touched, the whole screen
+* at the end of every case. The first differing pixel of a case is reported
+* with the call that drew it, the check fails on a difference or on an error
+* of the ST7735 command stream checker.
+*
+* The frame case records random frames of shapes and characters between
+* TFT_beginFrame and TFT_endFrame, with more colors than a palette holds,
+* and compares them with the same calls drawn immediately. The strip buffer
+* must give the same screen at every CFG_TFT_STRIP_BPP, make check runs it
+* in builds with 8 and 4 bpp as well, the 8 bpp one with CFG_TFT_STRIP_SKIP.
+* A build with all optional TFT features OFF runs every case too, fonts
+* which need CFG_TFT_FONT_RLE are skipped there.
+*
+* The queue case puts random batches of fills, texts and numbers into the
+* draw queue, many of them covering earlier ones, and compares the screen
+* after TFT_queue_render with all commands drawn in order. Commands dropped
+* as overdrawn must not make a difference.
+*
+* The bounds case measures random strings (newlines, characters outside the
+* font, wrapping on and off, positions off the screen) with TFT_getTextBounds
+* and compares them with the uncached Adafruit measurement. Strings repeat
+* in runs of the same font and size to hit the cache, two strings with the
+* same FNV-1a hash and length are measured one after the other. Run it in a
+* build with -DCFG_TFT_BOUNDS_CACHE=0 as well (make bench does).
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "project.h"
+#include "tft.h"
+#include "glcdfont.h"
+#include "FreeMono12pt7b.h"
+#include "FreeMono18pt7b.h"
+#include "FreeMono24pt7b.h"
+#include "FreeMono9pt7b.h"
+#include "FreeMonoBold12pt7b.h"
+#include "FreeMonoBold18pt7b.h"
+#include "FreeMonoBold24pt7b.h"
+#include "FreeMonoBold9pt7b.h"
+#include "FreeMonoBoldOblique12pt7b.h"
+#include "FreeMonoBoldOblique18pt7b.h"
+#include "FreeMonoBoldOblique24pt7b.h"
+#include "FreeMonoBoldOblique9pt7b.h"
+#include "FreeMonoOblique12pt7b.h"
+#include "FreeMonoOblique18pt7b.h"
+#include "FreeMonoOblique24pt7b.h"
+#include "FreeMonoOblique9pt7b.h"
+#include "FreeSans12pt7b.h"
+#include "FreeSans18pt7b.h"
+#include "FreeSans18pt7bDigits.h"
+#include "FreeSans24pt7b.h"
+#include "FreeSans9pt7b.h"
+#include "FreeSansBold12pt7b.h"
+#include "FreeSansBold18pt7b.h"
+#include "FreeSansBold24pt7b.h"
+#include "FreeSansBold9pt7b.h"
+#include "FreeSansBoldOblique12pt7b.h"
+#include "FreeSansBoldOblique18pt7b.h"
+#include "FreeSansBoldOblique24pt7b.h"
+#include "FreeSansBoldOblique9pt7b.h"
+#include "FreeSansOblique12pt7b.h"
+#include "FreeSansOblique18pt7b.h"
+#include "FreeSansOblique24pt7b.h"
+#include "FreeSansOblique9pt7b.h"
+#include "FreeSerif12pt7b.h"
+#include "FreeSerif18pt7b.h"
+#include "FreeSerif24pt7b.h"
+#include "FreeSerif9pt7b.h"
+#include "FreeSerifBold12pt7b.h"
+#include "FreeSerifBold18pt7b.h"
+#include "FreeSerifBold24pt7b.h"
+#include "FreeSerifBold9pt7b.h"
+#include "FreeSerifBoldItalic12pt7b.h"
+#include "FreeSerifBoldItalic18pt7b.h"
+#include "FreeSerifBoldItalic24pt7b.h"
+#include "FreeSerifBoldItalic9pt7b.h"
+#include "FreeSerifItalic12pt7b.h"
+#include "FreeSerifItalic18pt7b.h"
+#include "FreeSerifItalic24pt7b.h"
+#include "FreeSerifItalic9pt7b.h"
+#include "Org_01.h"
+#include "Picopixel.h"
+#include "Tiny3x3a2pt7b.h"
+#include "TomThumb.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define CHECK_CALLS             200         /**< \brief Default calls per case */
+#define CHECK_SEED              1           /**< \brief Default seed of the random calls */
+#define CHECK_W                 ((int16_t)HOST_TFT_GRAM_W)  /**< \brief Screen width in TFT_rot_180 */
+#define CHECK_H                 ((int16_t)HOST_TFT_GRAM_H)  /**< \brief Screen height in TFT_rot_180 */
+#define CHECK_MARGIN            20          /**< \brief Random positions reach this far outside the screen */
+#define CHECK_BITMAP_MAX        40          /**< \brief Largest random bitmap */
+#define CHECK_TEXT_LEN          24          /**< \brief Longest random string of the bounds case */
+#define CHECK_TEXT_POOL         16          /**< \brief Recent strings measured again */
+#define CHECK_TEXT_RUN          50          /**< \brief Measurements with the same font, size and wrapping */
+#define CHECK_FRAME_COLORS      300         /**< \brief Most colors of a frame, more than a 4 or 8 bpp palette holds */
+#define CHECK_FRAME_SIMPLE      5           /**< \brief First shapes which record one or a few rectangles */
+#define CHECK_QUEUE_BATCH       CFG_TFT_QUEUE_CMDS  /**< \brief Most commands per batch of the queue case */
+
+#define _swap_int16_t(a, b)     { int16_t t = a; a = b; b = t; }
+
+/**
+ * \brief Primitives of the shape cases
+ */
+typedef enum {
+    CHECK_PIXEL,
+    CHECK_FILL_RECT,
+    CHECK_RECT,
+    CHECK_HLINE,
+    CHECK_VLINE,
+    CHECK_LINE,
+    CHECK_CIRCLE,
+    CHECK_FILL_CIRCLE,
+    CHECK_ROUND_RECT,
+    CHECK_FILL_ROUND_RECT,
+    CHECK_TRIANGLE,
+    CHECK_FILL_TRIANGLE,
+    CHECK_BITMAP565,
+    CHECK_BITMAP1,
+    CHECK_BITMAP_STREAM
+} check_shape_kind_t;
+
+/**
+ * \brief One shape case
+ */
+typedef struct {
+    const char  *name;
+    check_shape_kind_t kind;
+    uint8_t     clip;                       /**< \brief Positions may be negative */
+} check_shape_t;
+
+/**
+ * \brief One font of the font cases
+ */
+typedef struct {
+    const char  *name;
+    const GFXfont *font;                    /**< \brief NULL = classic font */
+} check_font_t;
+
+/**
+ * \brief Box of a queued command, later commands of the batch cover it on purpose
+ */
+typedef struct {
+    int16_t     x, y, w, h;
+    uint8_t     number;                     /**< \brief Queued by TFT_queue_number */
+    uint8_t     digits;
+    uint8_t     size;
+} check_queued_t;
+
+/**
+ * \brief Pixel source of the stream case, random chunks of a bitmap
+ */
+typedef struct {
+    const uint16_t *pixels;
+    uint32_t    pos;
+    uint32_t    end;
+} check_source_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+static uint32_t     check_seed = CHECK_SEED;
+static uint16_t     check_ref[CHECK_H][CHECK_W];    /**< \brief Reference screen */
+static int16_t      check_x0, check_y0, check_x1, check_y1; /**< \brief Area touched by the reference since the last compare */
+static uint16_t     check_bitmap565[CHECK_BITMAP_MAX * CHECK_BITMAP_MAX];
+static uint8_t      check_bitmap1[(CHECK_BITMAP_MAX + 7) / 8 * CHECK_BITMAP_MAX];
+static uint16_t     check_palette[CHECK_FRAME_COLORS];  /**< \brief Colors of the current frame */
+static int16_t      check_colors;                       /**< \brief Used entries of check_palette, 0 = any color */
+static char         check_text[CHECK_TEXT_POOL][CHECK_TEXT_LEN + 1];    /**< \brief Strings of the bounds case */
+
+/** \brief Strings with the same FNV-1a hash and length but different bounds in a proportional font */
+static const char  *check_collision[2] = { "jj:l:jlijw:i", ".j.W:Wjii.lW" };
+static const check_font_t check_collisionFont = { "FreeSans12pt7b", &FreeSans12pt7b };
+
+static const check_shape_t check_shapes[] = {
+    { "drawPixel",               CHECK_PIXEL,           1 },
+    { "fillRect",                CHECK_FILL_RECT,       1 },
+    { "drawRect",                CHECK_RECT,            1 },
+    { "fastHLine",               CHECK_HLINE,           1 },
+    { "fastVLine",               CHECK_VLINE,           1 },
+    { "writeLine",               CHECK_LINE,            1 },
+    { "drawCircle",              CHECK_CIRCLE,          1 },
+    { "fillCircle",              CHECK_FILL_CIRCLE,     1 },
+    { "drawRoundRect",           CHECK_ROUND_RECT,      1 },
+    { "fillRoundRect",           CHECK_FILL_ROUND_RECT, 1 },
+    { "drawTriangle",            CHECK_TRIANGLE,        1 },
+    { "fillTriangle",            CHECK_FILL_TRIANGLE,   1 },
+    { "drawBitmap565",           CHECK_BITMAP565,       1 },
+    { "drawBitmap1",             CHECK_BITMAP1,         1 },
+    { "drawBitmapStream",        CHECK_BITMAP_STREAM,   1 },
+};
+
+static const check_font_t check_fonts[] = {
+    { "classic (glcdfont)", NULL },
+    { "FreeMono12pt7b", &FreeMono12pt7b },
+    { "FreeMono18pt7b", &FreeMono18pt7b },
+    { "FreeMono24pt7b", &FreeMono24pt7b },
+    { "FreeMono9pt7b", &FreeMono9pt7b },
+    { "FreeMonoBold12pt7b", &FreeMonoBold12pt7b },
+    { "FreeMonoBold18pt7b", &FreeMonoBold18pt7b },
+    { "FreeMonoBold24pt7b", &FreeMonoBold24pt7b },
+    { "FreeMonoBold9pt7b", &FreeMonoBold9pt7b },
+    { "FreeMonoBoldOblique12pt7b", &FreeMonoBoldOblique12pt7b },
+    { "FreeMonoBoldOblique18pt7b", &FreeMonoBoldOblique18pt7b },
+    { "FreeMonoBoldOblique24pt7b", &FreeMonoBoldOblique24pt7b },
+    { "FreeMonoBoldOblique9pt7b", &FreeMonoBoldOblique9pt7b },
+    { "FreeMonoOblique12pt7b", &FreeMonoOblique12pt7b },
+    { "FreeMonoOblique18pt7b", &FreeMonoOblique18pt7b },
+    { "FreeMonoOblique24pt7b", &FreeMonoOblique24pt7b },
+    { "FreeMonoOblique9pt7b", &FreeMonoOblique9pt7b },
+    { "FreeSans12pt7b", &FreeSans12pt7b },
+    { "FreeSans18pt7b", &FreeSans18pt7b },
+    { "FreeSans18pt7bDigits (RLE)", &FreeSans18pt7bDigits },
+    { "FreeSans24pt7b", &FreeSans24pt7b },
+    { "FreeSans9pt7b", &FreeSans9pt7b },
+    { "FreeSansBold12pt7b", &FreeSansBold12pt7b },
+    { "FreeSansBold18pt7b", &FreeSansBold18pt7b },
+    { "FreeSansBold24pt7b", &FreeSansBold24pt7b },
+    { "FreeSansBold9pt7b", &FreeSansBold9pt7b },
+    { "FreeSansBoldOblique12pt7b", &FreeSansBoldOblique12pt7b },
+    { "FreeSansBoldOblique18pt7b", &FreeSansBoldOblique18pt7b },
+    { "FreeSansBoldOblique24pt7b", &FreeSansBoldOblique24pt7b },
+    { "FreeSansBoldOblique9pt7b", &FreeSansBoldOblique9pt7b },
+    { "FreeSansOblique12pt7b", &FreeSansOblique12pt7b },
+    { "FreeSansOblique18pt7b", &FreeSansOblique18pt7b },
+    { "FreeSansOblique24pt7b", &FreeSansOblique24pt7b },
+    { "FreeSansOblique9pt7b", &FreeSansOblique9pt7b },
+    { "FreeSerif12pt7b", &FreeSerif12pt7b },
+    { "FreeSerif18pt7b", &FreeSerif18pt7b },
+    { "FreeSerif24pt7b", &FreeSerif24pt7b },
+    { "FreeSerif9pt7b", &FreeSerif9pt7b },
+    { "FreeSerifBold12pt7b", &FreeSerifBold12pt7b },
+    { "FreeSerifBold18pt7b", &FreeSerifBold18pt7b },
+    { "FreeSerifBold24pt7b", &FreeSerifBold24pt7b },
+    { "FreeSerifBold9pt7b", &FreeSerifBold9pt7b },
+    { "FreeSerifBoldItalic12pt7b", &FreeSerifBoldItalic12pt7b },
+    { "FreeSerifBoldItalic18pt7b", &FreeSerifBoldItalic18pt7b },
+    { "FreeSerifBoldItalic24pt7b", &FreeSerifBoldItalic24pt7b },
+    { "FreeSerifBoldItalic9pt7b", &FreeSerifBoldItalic9pt7b },
+    { "FreeSerifItalic12pt7b", &FreeSerifItalic12pt7b },
+    { "FreeSerifItalic18pt7b", &FreeSerifItalic18pt7b },
+    { "FreeSerifItalic24pt7b", &FreeSerifItalic24pt7b },
+    { "FreeSerifItalic9pt7b", &FreeSerifItalic9pt7b },
+    { "Org_01", &Org_01 },
+    { "Picopixel", &Picopixel },
+    { "Tiny3x3a2pt7b", &Tiny3x3a2pt7b },
+    { "TomThumb", &TomThumb },
+};
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Random number 0 ... n - 1, the same sequence for the same seed.
+ */
+static int16_t check_rand(int16_t n)
+{
+    check_seed = check_seed * 1103515245u + 12345u;
+    return (n > 0) ? (int16_t)((check_seed >> 8) % (uint32_t)n) : 0;
+}
+
+/**
+ * Random position on the screen, with clipping up to CHECK_MARGIN outside.
+ */
+static int16_t check_pos(int16_t size, uint8_t clip)
+{
+    return clip ? check_rand(size + 2 * CHECK_MARGIN) - CHECK_MARGIN : check_rand(size + CHECK_MARGIN);
+}
+
+/**
+ * Random color, from the colors of the current frame if there is one. Any
+ * other color has the lowest bit as given, so text and background differ.
+ */
+static uint16_t check_color(uint16_t low)
+{
+    return (check_colors > 0) ? check_palette[check_rand(check_colors)] : (uint16_t)check_rand(0x7FFF) * 2 + low;
+}
+
+/**
+ * Characters of the font can be drawn, run length coded fonts need
+ * CFG_TFT_FONT_RLE.
+ */
+static uint8_t check_drawable(const check_font_t *cf)
+{
+    return (CFG_TFT_FONT_RLE == ON) || (NULL == cf->font) || !(cf->font->flags & TFT_FONT_RLE);
+}
+
+/**
+ * Wait until the TFT driver has sent everything.
+ */
+static void check_drain(void)
+{
+    while (!HOST_TFT_isTxIdle())
+    {
+        HOST_SIM_idle();
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+/* Reference rasteriser, one pixel at a time                                 */
+/*---------------------------------------------------------------------------*/
+
+static void ref_pixel(int16_t x, int16_t y, uint16_t color)
+{
+    if ((x < 0) || (y < 0) || (x >= CHECK_W) || (y >= CHECK_H))
+    {
+        return;
+    }
+    check_ref[y][x] = color;
+    if (x < check_x0) check_x0 = x;
+    if (x > check_x1) check_x1 = x;
+    if (y < check_y0) check_y0 = y;
+    if (y > check_y1) check_y1 = y;
+}
+
+static void ref_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    for (int16_t j = 0; j < h; j++)
+    {
+        for (int16_t i = 0; i < w; i++)
+        {
+            ref_pixel(x + i, y + j, color);
+        }
+    }
+}
+
+static void ref_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+
+    if (steep)
+    {
+        _swap_int16_t(x0, y0);
+        _swap_int16_t(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        _swap_int16_t(x0, x1);
+        _swap_int16_t(y0, y1);
+    }
+
+    int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2, ystep = (y0 < y1) ? 1 : -1;
+
+    for (; x0 <= x1; x0++)
+    {
+        if (steep) ref_pixel(y0, x0, color);
+        else       ref_pixel(x0, y0, color);
+        err -= dy;
+        if (err < 0)
+        {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+static void ref_circleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color)
+{
+    int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        if (cornername & 0x4) { ref_pixel(x0 + x, y0 + y, color); ref_pixel(x0 + y, y0 + x, color); }
+        if (cornername & 0x2) { ref_pixel(x0 + x, y0 - y, color); ref_pixel(x0 + y, y0 - x, color); }
+        if (cornername & 0x8) { ref_pixel(x0 - y, y0 + x, color); ref_pixel(x0 - x, y0 + y, color); }
+        if (cornername & 0x1) { ref_pixel(x0 - y, y0 - x, color); ref_pixel(x0 - x, y0 - y, color); }
+    }
+}
+
+static void ref_fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, uint16_t color)
+{
+    int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        if (cornername & 0x1)
+        {
+            ref_fillRect(x0 + x, y0 - y, 1, 2 * y + 1 + delta, color);
+            ref_fillRect(x0 + y, y0 - x, 1, 2 * x + 1 + delta, color);
+        }
+        if (cornername & 0x2)
+        {
+            ref_fillRect(x0 - x, y0 - y, 1, 2 * y + 1 + delta, color);
+            ref_fillRect(x0 - y, y0 - x, 1, 2 * x + 1 + delta, color);
+        }
+    }
+}
+
+static void ref_circle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    ref_pixel(x0, y0 + r, color);
+    ref_pixel(x0, y0 - r, color);
+    ref_pixel(x0 + r, y0, color);
+    ref_pixel(x0 - r, y0, color);
+    ref_circleHelper(x0, y0, r, 0xF, color);
+}
+
+static void ref_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    ref_fillRect(x0, y0 - r, 1, 2 * r + 1, color);
+    ref_fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+static void ref_roundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+    ref_fillRect(x + r, y, w - 2 * r, 1, color);
+    ref_fillRect(x + r, y + h - 1, w - 2 * r, 1, color);
+    ref_fillRect(x, y + r, 1, h - 2 * r, color);
+    ref_fillRect(x + w - 1, y + r, 1, h - 2 * r, color);
+    ref_circleHelper(x + r, y + r, r, 1, color);
+    ref_circleHelper(x + w - r - 1, y + r, r, 2, color);
+    ref_circleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+    ref_circleHelper(x + r, y + h - r - 1, r, 8, color);
+}
+
+static void ref_fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+    ref_fillRect(x + r, y, w - 2 * r, h, color);
+    ref_fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+    ref_fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+}
+
+static void ref_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    int16_t a, b, y, last;
+
+    if (y0 > y1) { _swap_int16_t(y0, y1); _swap_int16_t(x0, x1); }
+    if (y1 > y2) { _swap_int16_t(y2, y1); _swap_int16_t(x2, x1); }
+    if (y0 > y1) { _swap_int16_t(y0, y1); _swap_int16_t(x0, x1); }
+
+    if (y0 == y2)
+    {
+        a = b = x0;
+        if (x1 < a) a = x1; else if (x1 > b) b = x1;
+        if (x2 < a) a = x2; else if (x2 > b) b = x2;
+        ref_fillRect(a, y0, b - a + 1, 1, color);
+        return;
+    }
+
+    int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+
+    last = (y1 == y2) ? y1 : y1 - 1;
+    for (y = y0; y <= last; y++)
+    {
+        a = x0 + sa / dy01;
+        b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        if (a > b) _swap_int16_t(a, b);
+        ref_fillRect(a, y, b - a + 1, 1, color);
+    }
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        a = x1 + sa / dy12;
+        b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        if (a > b) _swap_int16_t(a, b);
+        ref_fillRect(a, y, b - a + 1, 1, color);
+    }
+}
+
+/**
+ * Pixel of a custom font glyph, plain bitmap or run length coded.
+ */
+static uint8_t ref_glyphBit(const GFXfont *font, const GFXglyph *glyph, uint16_t bit)
+{
+    const uint8_t *p = &font->bitmap[glyph->bitmapOffset];
+
+    if (0 == (font->flags & TFT_FONT_RLE))
+    {
+        return (p[bit / 8] >> (7 - bit % 8)) & 1;
+    }
+
+    /* Pairs of clear (high nibble) and set (low nibble) pixels, 0 ends */
+    uint16_t pos = 0;
+    for (; *p != 0; p++)
+    {
+        pos += *p >> 4;
+        if (bit < pos) return 0;
+        pos += *p & 0x0F;
+        if (bit < pos) return 1;
+    }
+    return 0;
+}
+
+static void ref_char(const GFXfont *gfx, int16_t x, int16_t y, uint8_t c, uint16_t color, uint16_t bg, uint8_t size)
+{
+    if (NULL == gfx)
+    {
+        for (int16_t i = 0; i < 6; i++)
+        {
+            uint8_t line = (i < 5) ? font[c * 5 + i] : 0;
+            for (int16_t j = 0; j < 8; j++, line >>= 1)
+            {
+                if ((line & 1) || (bg != color))
+                {
+                    ref_fillRect(x + i * size, y + j * size, size, size, (line & 1) ? color : bg);
+                }
+            }
+        }
+        return;
+    }
+
+    const GFXglyph *glyph = &gfx->glyph[c - gfx->first];
+    for (uint16_t yy = 0; yy < glyph->height; yy++)
+    {
+        for (uint16_t xx = 0; xx < glyph->width; xx++)
+        {
+            if (ref_glyphBit(gfx, glyph, yy * glyph->width + xx))
+            {
+                ref_fillRect(x + (glyph->xOffset + xx) * size, y + (glyph->yOffset + yy) * size, size, size, color);
+            }
+        }
+    }
+}
+
+/**
+ * Text bounds as measured by Adafruit GFX, charBounds without any cache.
+ */
+static void ref_charBounds(const GFXfont *gfx, uint8_t size, uint8_t wrap, char c, int16_t *x, int16_t *y,
+                           int16_t *minx, int16_t *miny, int16_t *maxx, int16_t *maxy)
+{
+    if (c == '\n')
+    {
+        *x = 0;
+        *y += size * ((NULL == gfx) ? 8 : gfx->yAdvance);
+        return;
+    }
+    if (c == '\r')
+    {
+        return;
+    }
+    if (NULL == gfx)
+    {
+        if (wrap && ((*x + size * 6) > CHECK_W))
+        {
+            *x = 0;
+            *y += size * 8;
+        }
+        int x2 = *x + size * 6 - 1, y2 = *y + size * 8 - 1;
+        if (x2 > *maxx) *maxx = x2;
+        if (y2 > *maxy) *maxy = y2;
+        if (*x < *minx) *minx = *x;
+        if (*y < *miny) *miny = *y;
+        *x += size * 6;
+        return;
+    }
+    if (((uint8_t)c < gfx->first) || ((uint8_t)c > gfx->last))
+    {
+        return;
+    }
+
+    const GFXglyph *glyph = &gfx->glyph[(uint8_t)c - gfx->first];
+    if (wrap && ((*x + ((int16_t)glyph->xOffset + glyph->width) * size) > CHECK_W))
+    {
+        *x = 0;
+        *y += size * gfx->yAdvance;
+    }
+    int16_t x1 = *x + glyph->xOffset * size, y1 = *y + glyph->yOffset * size,
+            x2 = x1 + glyph->width * size - 1, y2 = y1 + glyph->height * size - 1;
+    if (x1 < *minx) *minx = x1;
+    if (y1 < *miny) *miny = y1;
+    if (x2 > *maxx) *maxx = x2;
+    if (y2 > *maxy) *maxy = y2;
+    *x += glyph->xAdvance * size;
+}
+
+static void ref_textBounds(const GFXfont *gfx, uint8_t size, uint8_t wrap, const char *str, int16_t x, int16_t y,
+                           int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h)
+{
+    int16_t minx = CHECK_W, miny = CHECK_H, maxx = -1, maxy = -1;
+
+    *x1 = x;
+    *y1 = y;
+    *w = *h = 0;
+    while (*str)
+    {
+        ref_charBounds(gfx, size, wrap, *str++, &x, &y, &minx, &miny, &maxx, &maxy);
+    }
+    if (maxx >= minx)
+    {
+        *x1 = minx;
+        *w  = maxx - minx + 1;
+    }
+    if (maxy >= miny)
+    {
+        *y1 = miny;
+        *h  = maxy - miny + 1;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+/* Comparison                                                                */
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Compare the area touched by the reference since the last call, or the
+ * whole screen. Reports the first difference and takes the screen as the
+ * new reference, so one error is not reported again by every later call.
+ * @return number of differing pixels
+ */
+static uint32_t check_compare(const char *name, uint32_t call, uint8_t full)
+{
+    uint32_t bad = 0;
+
+    check_drain();
+    if (full)
+    {
+        check_x0 = 0;
+        check_y0 = 0;
+        check_x1 = CHECK_W - 1;
+        check_y1 = CHECK_H - 1;
+    }
+    for (int16_t y = check_y0; y <= check_y1; y++)
+    {
+        for (int16_t x = check_x0; x <= check_x1; x++)
+        {
+            uint16_t px = HOST_TFT_getPixel((uint16_t)x, (uint16_t)y);
+            if (px != check_ref[y][x])
+            {
+                if (0 == bad)
+                {
+                    printf("  %-26s call %u: pixel %d,%d is %04x instead of %04x\n", name, call, x, y, px, check_ref[y][x]);
+                }
+                check_ref[y][x] = px;
+                bad++;
+            }
+        }
+    }
+    check_x0 = CHECK_W;
+    check_y0 = CHECK_H;
+    check_x1 = -1;
+    check_y1 = -1;
+    return bad;
+}
+
+/**
+ * Fill the screen and the reference with a random color.
+ */
+static void check_clear(void)
+{
+    uint16_t color = (uint16_t)check_rand(0x7FFF) * 2;
+
+    TFT_fillScreen(color);
+    ref_fillRect(0, 0, CHECK_W, CHECK_H, color);
+    (void)check_compare("fillScreen", 0, 1);
+}
+
+/**
+ * Pixel source of the stream case, hands out random chunks.
+ */
+static uint16_t check_source(TFT_color_t *pixels, uint16_t n, void *arg)
+{
+    check_source_t *s = (check_source_t *)arg;
+    uint16_t        chunk = (uint16_t)(1 + check_rand((int16_t)n));
+    uint16_t        i;
+
+    for (i = 0; (i < chunk) && (s->pos < s->end); i++)
+    {
+        pixels[i] = s->pixels[s->pos++];
+    }
+    return i;
+}
+
+/**
+ * One random call of a shape case, drawn by the driver and the reference.
+ */
+static void check_shape(const check_shape_t *cs)
+{
+    int16_t  x = check_pos(CHECK_W, cs->clip), y = check_pos(CHECK_H, cs->clip);
+    int16_t  x1 = check_pos(CHECK_W, cs->clip), y1 = check_pos(CHECK_H, cs->clip);
+    int16_t  x2 = check_pos(CHECK_W, cs->clip), y2 = check_pos(CHECK_H, cs->clip);
+    int16_t  w = 1 + check_rand(70), h = 1 + check_rand(70), r = check_rand(40);
+    uint16_t color = check_color(1);
+
+    switch (cs->kind)
+    {
+        case CHECK_PIXEL:
+            TFT_drawPixel(x, y, color);
+            ref_pixel(x, y, color);
+            break;
+        case CHECK_FILL_RECT:
+            TFT_fillRect(x, y, w, h, color);
+            ref_fillRect(x, y, w, h, color);
+            break;
+        case CHECK_RECT:
+            TFT_drawRect(x, y, w, h, color);
+            ref_fillRect(x, y, w, 1, color);
+            ref_fillRect(x, y + h - 1, w, 1, color);
+            ref_fillRect(x, y, 1, h, color);
+            ref_fillRect(x + w - 1, y, 1, h, color);
+            break;
+        case CHECK_HLINE:
+            TFT_fastHLine(x, y, w, color);
+            ref_fillRect(x, y, w, 1, color);
+            break;
+        case CHECK_VLINE:
+            TFT_fastVLine(x, y, h, color);
+            ref_fillRect(x, y, 1, h, color);
+            break;
+        case CHECK_LINE:
+            /* Every 4th line horizontal or vertical */
+            if (0 == check_rand(4))
+            {
+                if (check_rand(2)) y1 = y; else x1 = x;
+            }
+            TFT_writeLine(x, y, x1, y1, color);
+            ref_line(x, y, x1, y1, color);
+            break;
+        case CHECK_CIRCLE:
+            TFT_drawCircle(x, y, r, color);
+            ref_circle(x, y, r, color);
+            break;
+        case CHECK_FILL_CIRCLE:
+            TFT_fillCircle(x, y, r, color);
+            ref_fillCircle(x, y, r, color);
+            break;
+        case CHECK_ROUND_RECT:
+        case CHECK_FILL_ROUND_RECT:
+            if (2 * r > w) r = w / 2;
+            if (2 * r > h) r = h / 2;
+            if (CHECK_ROUND_RECT == cs->kind)
+            {
+                TFT_drawRoundRect(x, y, w, h, r, color);
+                ref_roundRect(x, y, w, h, r, color);
+            }
+            else
+            {
+                TFT_fillRoundRect(x, y, w, h, r, color);
+                ref_fillRoundRect(x, y, w, h, r, color);
+            }
+            break;
+        case CHECK_TRIANGLE:
+            TFT_drawTriangle(x, y, x1, y1, x2, y2, color);
+            ref_line(x, y, x1, y1, color);
+            ref_line(x1, y1, x2, y2, color);
+            ref_line(x2, y2, x, y, color);
+            break;
+        case CHECK_FILL_TRIANGLE:
+            TFT_fillTriangle(x, y, x1, y1, x2, y2, color);
+            ref_fillTriangle(x, y, x1, y1, x2, y2, color);
+            break;
+        case CHECK_BITMAP565:
+        case CHECK_BITMAP1:
+        case CHECK_BITMAP_STREAM:
+        {
+            uint16_t bg = check_color(0);
+            int16_t  stride;
+            uint32_t end;
+
+            w = check_rand(CHECK_BITMAP_MAX + 1);
+            h = check_rand(CHECK_BITMAP_MAX + 1);
+            stride = (w + 7) / 8;
+            for (int16_t i = 0; i < CHECK_BITMAP_MAX * CHECK_BITMAP_MAX; i++)
+            {
+                check_bitmap565[i] = (uint16_t)(check_rand(0x7FFF) * 2 + check_rand(2));
+                check_bitmap1[i % sizeof(check_bitmap1)] = (uint8_t)check_rand(256);
+            }
+            if (CHECK_BITMAP565 == cs->kind)
+            {
+                TFT_drawBitmap565(x, y, w, h, check_bitmap565);
+                end = (uint32_t)w * h;
+            }
+            else if (CHECK_BITMAP1 == cs->kind)
+            {
+                TFT_drawBitmap1(x, y, w, h, check_bitmap1, color, bg);
+                for (int16_t j = 0; j < h; j++)
+                {
+                    for (int16_t i = 0; i < w; i++)
+                    {
+                        ref_pixel(x + i, y + j, ((check_bitmap1[j * stride + i / 8] << (i % 8)) & 0x80) ? color : bg);
+                    }
+                }
+                break;
+            }
+            else
+            {
+                /* Every 5th source ends in the middle, the rest is black */
+                check_source_t s = { check_bitmap565, 0, (uint32_t)w * h };
+                if (0 == check_rand(5))
+                {
+                    s.end /= 2;
+                }
+                end = s.end;
+                (void)TFT_drawBitmapStream(x, y, w, h, check_source, &s);
+            }
+            for (int16_t j = 0; j < h; j++)
+            {
+                for (int16_t i = 0; i < w; i++)
+                {
+                    ref_pixel(x + i, y + j, ((uint32_t)(j * w + i) < end) ? check_bitmap565[j * w + i] : 0);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * One random character of a font case. Classic characters are opaque or
+ * transparent, sizes 1 to 3. Custom fonts are transparent by design, sizes
+ * 1 and 2, positioned at the baseline.
+ */
+static void check_char(const check_font_t *cf)
+{
+    uint8_t  size = (uint8_t)(1 + check_rand((NULL == cf->font) ? 3 : 2));
+    uint16_t color = check_color(1);
+    uint16_t bg = check_rand(2) ? color : check_color(0);
+    int16_t  x, y;
+    uint8_t  c;
+
+    if (NULL == cf->font)
+    {
+        x = check_pos(CHECK_W, 1);
+        y = check_pos(CHECK_H, 1);
+        c = (uint8_t)check_rand(256);
+    }
+    else
+    {
+        x = check_pos(CHECK_W, 1);
+        y = check_pos(CHECK_H, 1);
+        c = (uint8_t)(cf->font->first + check_rand(cf->font->last - cf->font->first + 1));
+        bg = color;
+    }
+    TFT_drawChar(x, y, c, color, bg, size);
+    ref_char(cf->font, x, y, c, color, bg, size);
+}
+
+/**
+ * Measure a string with the driver and the reference.
+ * @return 1 if the bounds differ
+ */
+static uint32_t check_bounds(const check_font_t *cf, uint8_t size, uint8_t wrap, char *str, int16_t x, int16_t y)
+{
+    int16_t  x1, y1, rx1, ry1;
+    uint16_t w, h, rw, rh;
+
+    TFT_getTextBounds(str, x, y, &x1, &y1, &w, &h);
+    ref_textBounds(cf->font, size, wrap, str, x, y, &rx1, &ry1, &rw, &rh);
+    if ((x1 == rx1) && (y1 == ry1) && (w == rw) && (h == rh))
+    {
+        return 0;
+    }
+    printf("  %-26s %s size %u wrap %u \"%s\" at %d,%d: %d,%d %ux%u instead of %d,%d %ux%u\n", "getTextBounds",
+           cf->name, size, wrap, str, x, y, x1, y1, w, h, rx1, ry1, rw, rh);
+    return 1;
+}
+
+/**
+ * One random frame of the frame case, shapes and characters recorded between
+ * TFT_beginFrame and TFT_endFrame and drawn by the reference as they come.
+ * A frame takes 5 to CHECK_FRAME_COLORS colors and up to twice
+ * CFG_TFT_STRIP_CMDS calls, half of them pixels, rectangles and lines which
+ * record few rectangles, so a full 4 bpp palette as well as a full list are
+ * rendered in between. Every other frame starts with a band across the
+ * screen, its strips are full width like after a clear. The font is the
+ * classic one or a random custom font.
+ */
+static void check_frame(void)
+{
+    const check_font_t *cf = &check_fonts[check_rand(2) ? 0 : check_rand(sizeof(check_fonts) / sizeof(check_fonts[0]))];
+    int16_t n = 1 + check_rand(2 * CFG_TFT_STRIP_CMDS);
+
+    if (!check_drawable(cf))
+    {
+        cf = &check_fonts[0];
+    }
+    check_colors = 5 + check_rand(CHECK_FRAME_COLORS - 4);
+    for (int16_t i = 0; i < check_colors; i++)
+    {
+        check_palette[i] = (uint16_t)(check_rand(0x7FFF) * 2 + check_rand(2));
+    }
+    TFT_setFont(cf->font);
+    TFT_beginFrame();
+    if (check_rand(2))
+    {
+        int16_t  y = check_rand(CHECK_H), h = 1 + check_rand(CHECK_H - y);
+        uint16_t color = check_color(0);
+
+        TFT_fillRect(0, y, CHECK_W, h, color);
+        ref_fillRect(0, y, CHECK_W, h, color);
+    }
+    for (int16_t i = 0; i < n; i++)
+    {
+        int16_t k = check_rand(4);
+
+        if (0 == k)
+        {
+            check_char(cf);
+        }
+        else if (1 == k)
+        {
+            check_shape(&check_shapes[check_rand(sizeof(check_shapes) / sizeof(check_shapes[0]))]);
+        }
+        else
+        {
+            check_shape(&check_shapes[check_rand(CHECK_FRAME_SIMPLE)]);
+        }
+    }
+    TFT_endFrame();
+    TFT_setFont(NULL);
+    check_colors = 0;
+}
+
+/**
+ * Queued classic text as drawn without the queue, one character cell after
+ * the other.
+ */
+static void ref_text(int16_t x, int16_t y, const char *text, uint8_t len, uint16_t color, uint16_t bg, uint8_t size)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        ref_char(NULL, x + i * 6 * size, y, (uint8_t)text[i], color, bg, size);
+    }
+}
+
+/**
+ * One random batch of the queue case. The commands are queued, rendered by
+ * TFT_queue_render and drawn by the reference in queue order without any
+ * overdraw elimination. Every third command is placed over an earlier one of
+ * the batch: a fill which covers its box or misses it by one pixel, or a
+ * number in the same place, opaque or transparent.
+ */
+static void check_queue(void)
+{
+    check_queued_t q[CHECK_QUEUE_BATCH];
+    uint8_t  n = (uint8_t)(1 + check_rand(CHECK_QUEUE_BATCH));
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        check_queued_t *c = &q[i];
+        const check_queued_t *p = &q[check_rand(i + 1)];
+        uint8_t  cover = (i > 0) && (0 == check_rand(3));
+        int16_t  kind = check_rand(3);
+        uint16_t color = (uint16_t)check_rand(0x7FFF) * 2 + 1;
+        uint16_t bg = check_rand(2) ? color : (uint16_t)check_rand(0x7FFF) * 2;
+        char     text[CFG_TFT_QUEUE_TEXT + 5];
+
+        c->number = 0;
+        c->x = check_pos(CHECK_W, 1);
+        c->y = check_pos(CHECK_H, 1);
+        c->size = (uint8_t)(1 + check_rand(3));
+        if (cover && p->number && check_rand(2))
+        {
+            kind = 2;
+            c->x = p->x;
+            c->y = p->y;
+            c->size = p->size;
+            c->digits = p->digits;
+        }
+        else if (cover)
+        {
+            kind = 0;
+            c->x = p->x - check_rand(3);
+            c->y = p->y - check_rand(3);
+            c->w = p->w + (p->x - c->x) + check_rand(3) - (int16_t)(0 == check_rand(4));
+            c->h = p->h + (p->y - c->y) + check_rand(3) - (int16_t)(0 == check_rand(4));
+        }
+
+        if (0 == kind)
+        {
+            if (!cover)
+            {
+                c->w = 1 + check_rand(CHECK_W / 2);
+                c->h = 1 + check_rand(CHECK_H / 2);
+            }
+            if ((c->w > 0) && (c->h > 0) && (RC_SUCCESS == TFT_queue_fill(c->x, c->y, c->w, c->h, color)))
+            {
+                ref_fillRect(c->x, c->y, c->w, c->h, color);
+            }
+        }
+        else if (1 == kind)
+        {
+            int16_t len = check_rand(sizeof(text));
+
+            for (int16_t k = 0; k < len; k++)
+            {
+                text[k] = (char)(check_rand(8) ? 0x20 + check_rand(0x5F) : 0x80 + check_rand(0x80));
+            }
+            text[len] = '\0';
+            if (len > CFG_TFT_QUEUE_TEXT)
+            {
+                len = CFG_TFT_QUEUE_TEXT;
+            }
+            c->w = (int16_t)(len * 6 * c->size);
+            c->h = (int16_t)(8 * c->size);
+            if (RC_SUCCESS == TFT_queue_text(c->x, c->y, text, color, bg, c->size))
+            {
+                ref_text(c->x, c->y, text, (uint8_t)len, color, bg, c->size);
+            }
+        }
+        else
+        {
+            int32_t value = (int32_t)check_rand(0x7FFF) * (check_rand(2) ? 1 : 100000) * (check_rand(2) ? 1 : -1);
+            char    digits[16];
+            int     len;
+
+            if (0 == check_rand(20))
+            {
+                value = INT32_MIN;
+            }
+            if (!(cover && p->number))
+            {
+                c->digits = (uint8_t)(1 + check_rand(11));
+            }
+            c->number = 1;
+            c->w = (int16_t)(c->digits * 6 * c->size);
+            c->h = (int16_t)(8 * c->size);
+            len = sprintf(digits, "%ld", (long)value);
+            memset(text, (len > c->digits) ? '#' : ' ', c->digits);
+            if (len <= c->digits)
+            {
+                memcpy(&text[c->digits - len], digits, (size_t)len);
+            }
+            if (RC_SUCCESS == TFT_queue_number(c->x, c->y, value, c->digits, color, bg, c->size))
+            {
+                ref_text(c->x, c->y, text, c->digits, color, bg, c->size);
+            }
+        }
+    }
+    (void)TFT_queue_render();
+}
+
+/**
+ * Random string for the bounds case, mostly printable characters.
+ */
+static void check_string(char *str)
+{
+    int16_t len = check_rand(CHECK_TEXT_LEN + 1);
+
+    for (int16_t i = 0; i < len; i++)
+    {
+        int16_t k = check_rand(20);
+        str[i] = (char)((k == 0) ? '\n' : (k == 1) ? '\r' : (k == 2) ? 0x80 + check_rand(0x80) : 0x20 + check_rand(0x5F));
+    }
+    str[len] = '\0';
+}
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t calls = CHECK_CALLS;
+    uint32_t failed = 0;
+    int      opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:h")))
+    {
+        switch (opt)
+        {
+            case 'n': calls = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': check_seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n calls per case] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    HOST_SIM_cost_t cost = HOST_SIM_COST_DEFAULT;
+    HOST_SIM_enable(&cost);
+    TFT_init();
+    TFT_setRotation(TFT_rot_180);       /* screen = frame memory */
+    check_x0 = CHECK_W;
+    check_y0 = CHECK_H;
+    check_x1 = -1;
+    check_y1 = -1;
+
+    printf("check_tft: %u calls per case, seed %u, TX %s%s\n", calls, check_seed,
+           (CFG_TFT_SPI_TX_IRQ == ON) ? "interrupt" : "polled", (CFG_TFT_DMA == ON) ? ", DMA" : "");
+
+    for (size_t k = 0; k < sizeof(check_shapes) / sizeof(check_shapes[0]); k++)
+    {
+        const check_shape_t *cs = &check_shapes[k];
+        uint32_t bad = 0;
+
+        check_clear();
+        for (uint32_t n = 0; n < calls; n++)
+        {
+            check_shape(cs);
+            bad += check_compare(cs->name, n, 0);
+        }
+        bad += check_compare(cs->name, calls, 1);
+        printf("  %-26s %s\n", cs->name, (0 == bad) ? "ok" : "FAILED");
+        failed += (0 != bad);
+    }
+
+    for (size_t k = 0; k < sizeof(check_fonts) / sizeof(check_fonts[0]); k++)
+    {
+        const check_font_t *cf = &check_fonts[k];
+        uint32_t bad = 0;
+
+        if (!check_drawable(cf))
+        {
+            printf("  %-26s skipped, CFG_TFT_FONT_RLE is OFF\n", cf->name);
+            continue;
+        }
+        check_clear();
+        TFT_setFont(cf->font);
+        TFT_clearGlyphCache();
+        for (uint32_t n = 0; n < calls; n++)
+        {
+            check_char(cf);
+            bad += check_compare(cf->name, n, 0);
+        }
+        bad += check_compare(cf->name, calls, 1);
+        printf("  %-26s %s\n", cf->name, (0 == bad) ? "ok" : "FAILED");
+        failed += (0 != bad);
+    }
+    TFT_setFont(NULL);
+
+    /* Frames: every 5th frame repeats the one before, CFG_TFT_STRIP_SKIP skips its strips */
+    {
+        uint32_t bad = 0, seed = check_seed;
+
+        check_clear();
+        for (uint32_t n = 0; n < calls; n++)
+        {
+            if (4 == n % 5)
+            {
+                check_seed = seed;
+            }
+            seed = check_seed;
+            check_frame();
+            bad += check_compare("TFT_endFrame", n, 0);
+        }
+        bad += check_compare("TFT_endFrame", calls, 1);
+        printf("  %-26s %s, %u bpp\n", "TFT_endFrame", (0 == bad) ? "ok" : "FAILED", (unsigned)CFG_TFT_STRIP_BPP);
+        failed += (0 != bad);
+    }
+
+    /* Queue: batches with overdrawn commands against drawing them all */
+    {
+        uint32_t bad = 0, drawn, dropped;
+
+        check_clear();
+        for (uint32_t n = 0; n < calls; n++)
+        {
+            check_queue();
+            bad += check_compare("TFT_queue_render", n, 0);
+        }
+        bad += check_compare("TFT_queue_render", calls, 1);
+        TFT_getQueueStats(&drawn, &dropped);
+        printf("  %-26s %s, %u drawn, %u dropped\n", "TFT_queue_render", (0 == bad) ? "ok" : "FAILED", drawn, dropped);
+        failed += (0 != bad);
+    }
+
+    /* Bounds: runs of one font, size and wrapping, strings from a pool */
+    {
+        const check_font_t *cf = &check_fonts[0];
+        uint8_t  size = 1, wrap = 1;
+        uint32_t bad = 0, hits, misses;
+
+        for (uint32_t n = 0; n < 50 * calls; n++)
+        {
+            char *str = check_text[check_rand(CHECK_TEXT_POOL)];
+
+            if (0 == n % CHECK_TEXT_RUN)
+            {
+                cf   = &check_fonts[check_rand(sizeof(check_fonts) / sizeof(check_fonts[0]))];
+                size = (uint8_t)(1 + check_rand(3));
+                wrap = (uint8_t)check_rand(2);
+                TFT_setFont(cf->font);
+                TFT_setTextSize(size);
+                TFT_setTextWrap(wrap ? TRUE : FALSE);
+            }
+            if (0 == check_rand(3))
+            {
+                check_string(str);
+            }
+            bad += check_bounds(cf, size, wrap, str, check_rand(400) - 150, check_rand(300) - 70);
+        }
+
+        /* Same hash and length, different glyphs */
+        TFT_setFont(check_collisionFont.font);
+        TFT_setTextSize(1);
+        for (int i = 0; i < 2; i++)
+        {
+            strcpy(check_text[0], check_collision[i]);
+            bad += check_bounds(&check_collisionFont, 1, wrap, check_text[0], 10, 40);
+        }
+        TFT_setFont(NULL);
+        TFT_setTextSize(1);
+        TFT_setTextWrap(TRUE);
+        TFT_getBoundsCacheStats(&hits, &misses);
+        printf("  %-26s %s, %u of %u from the cache\n", "getTextBounds", (0 == bad) ? "ok" : "FAILED", hits, hits + misses);
+        failed += (0 != bad);
+    }
+
+    printf("  ST7735 stream errors: %llu\n", (unsigned long long)HOST_TFT_getStreamErrors());
+    printf("check_tft: %u of %u cases failed\n", failed,
+           (unsigned)(sizeof(check_shapes) / sizeof(check_shapes[0]) + sizeof(check_fonts) / sizeof(check_fonts[0]) + 3));
+
+    return ((0 == failed) && (0 == HOST_TFT_getStreamErrors())) ? 0 : 2;
+}
+
+/* [check_tft.c] END OF FILE */
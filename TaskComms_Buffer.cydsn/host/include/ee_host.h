@@ -0,0 +1,278 @@
+/**
+* \file ee_host.h
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief pthread based shim of the ErikaOS (OSEK) API used by the application
+*
+* All tasks share one virtual CPU: exactly one task (or ISR) executes at any
+* time, selected by OSEK priority rules (ready priority, dispatch priority of
+* non-preemptive tasks, resource ceilings). Preemption happens in OS services
+* and, for code compiled with -finstrument-functions, at every function
+* entry, which is where a pending ISR gets the CPU.
+*
+* With #HOST_SIM_enable the CPU runs on a virtual clock instead: every
+* preemption point, OS service and modelled hardware access charges a cost,
+* ISRs are taken from a time ordered event queue. Runs are reproducible.
+*
+* Configuration (tasks, priorities, events, resources) mirrors the generated
+* ErikaOS_eecfg.inc of the PSoC project and has to be kept in sync with it.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+#ifndef EE_HOST_H
+#define EE_HOST_H
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdint.h>
+
+/*****************************************************************************/
+/* OSEK types and symbols                                                    */
+/*****************************************************************************/
+
+typedef uint32_t    EventMaskType;          /**< \brief Event mask */
+typedef uint32_t   *EventMaskRefType;       /**< \brief Reference to an event mask */
+typedef int32_t     TaskType;               /**< \brief Task identifier */
+typedef uint32_t    ResourceType;           /**< \brief Resource identifier */
+typedef uint32_t    CounterType;            /**< \brief Counter identifier */
+typedef uint32_t    AppModeType;            /**< \brief Application mode */
+typedef uint8_t     StatusType;             /**< \brief Return value of OS services */
+
+#define E_OK                0               /**< \brief Service succeeded */
+#define E_OS_ACCESS         1               /**< \brief Object not accessible (e.g. basic task) */
+#define E_OS_ID             3               /**< \brief Invalid object identifier */
+#define E_OS_LIMIT          4               /**< \brief Too many activations */
+#define E_OS_RESOURCE       6               /**< \brief Resource still occupied */
+#define E_OS_STATE          7               /**< \brief Object in wrong state */
+
+#define OSDEFAULTAPPMODE    1               /**< \brief Default application mode */
+#define INVALID_TASK        (-1)            /**< \brief No task */
+
+#define TASK(t)             void Func##t(void)  /**< \brief Task body definition */
+#define ISR2(f)             void f(void)        /**< \brief Category 2 ISR definition */
+#define ISR(f)              void f(void)        /**< \brief ISR definition (category 2 on Cortex-M) */
+#define DeclareTask(t)      extern void Func##t(void)   /**< \brief Task body declaration */
+
+/*****************************************************************************/
+/* Configuration, mirrors ErikaOS_eecfg.inc                                  */
+/*****************************************************************************/
+
+#define tsk_init            0               /**< \brief Init task, autostart, non-preemptive, prio 1 */
+#define tsk_background      1               /**< \brief Background task, prio 1 */
+#define tsk_sender          2               /**< \brief Sender task, prio 16 */
+#define tsk_tft             3               /**< \brief TFT consumer, prio 8 */
+#define tsk_uart            4               /**< \brief UART consumer, prio 8 */
+#define EE_MAX_TASK         5               /**< \brief Number of tasks */
+
+#define ev_sender           0x1U            /**< \brief Complete message in streaming buffer */
+#define ev_tft              0x2U            /**< \brief Payload for the TFT */
+#define ev_uart             0x4U            /**< \brief Payload for the UART */
+
+#define res_dyn             0               /**< \brief Dynamic payload buffer */
+#define res_stream          1               /**< \brief Streaming buffer */
+#define EE_MAX_RESOURCE     2               /**< \brief Number of resources */
+
+#define cnt_systick         0               /**< \brief 1 ms system counter */
+#define alrm_50ms           0               /**< \brief Only alarm of the configuration (not emulated) */
+
+#define __USE_SYSTICK__                     /**< \brief Host always provides a tick source */
+
+/** \brief Convert milliseconds into ticks of the given reference clock */
+#define MILLISECONDS_TO_TICKS(X_MILLISECS, REF_FREQ_HZ) \
+    ((uint32_t)(((uint64_t)(X_MILLISECS) * (REF_FREQ_HZ)) / 1000u))
+
+/*****************************************************************************/
+/* OSEK API                                                                  */
+/*****************************************************************************/
+
+StatusType ActivateTask(TaskType TaskID);
+StatusType TerminateTask(void);
+StatusType GetTaskID(TaskType *TaskID);
+StatusType SetEvent(TaskType TaskID, EventMaskType Mask);
+StatusType ClearEvent(EventMaskType Mask);
+StatusType GetEvent(TaskType TaskID, EventMaskRefType Event);
+StatusType WaitEvent(EventMaskType Mask);
+StatusType GetResource(ResourceType ResID);
+StatusType ReleaseResource(ResourceType ResID);
+StatusType CounterTick(CounterType CounterID);
+void       StartOS(AppModeType Mode);
+
+/*****************************************************************************/
+/* Cortex-M port API                                                         */
+/*****************************************************************************/
+
+void EE_system_init(void);
+void EE_systick_set_period(uint32_t period);
+void EE_systick_enable_int(void);
+void EE_systick_start(void);
+
+/*****************************************************************************/
+/* Host API                                                                  */
+/*****************************************************************************/
+
+/**
+ * \brief Task states as seen by the host harness
+ */
+typedef enum {
+    HOST_TASK_SUSPENDED,                    /**< \brief Not activated */
+    HOST_TASK_READY,                        /**< \brief Activated or released, waiting for the CPU */
+    HOST_TASK_RUNNING,                      /**< \brief Owns the CPU (or is interrupted by an ISR) */
+    HOST_TASK_WAITING                       /**< \brief Blocked in WaitEvent */
+} HOST_OS_taskState_t;
+
+/**
+ * \brief Executes an ISR on the virtual CPU
+ *
+ * Blocks the calling (non task) thread until the running task reaches a
+ * preemption point, runs the ISR and dispatches afterwards. ISRs do not nest.
+ * @param isr   ISR body, e.g. isr_uartRX
+ */
+void HOST_OS_raiseIsr(void (*isr)(void));
+
+/**
+ * \brief Preemption point, hands the CPU to a pending ISR
+ *
+ * Called from the -finstrument-functions hook, may be called by stubs which
+ * model long blocking hardware accesses.
+ */
+void HOST_OS_preemptionPoint(void);
+
+/**
+ * \brief State of a task
+ * @param TaskID    Task identifier
+ * @return state of the task
+ */
+HOST_OS_taskState_t HOST_OS_getTaskState(TaskType TaskID);
+
+/**
+ * \brief Number of times the CPU was handed from one task or ISR to another
+ * @return context switches since StartOS
+ */
+uint32_t HOST_OS_getContextSwitches(void);
+
+/**
+ * \brief Number of times a task got the CPU since StartOS
+ * @param TaskID    Task identifier
+ * @return dispatches of the task
+ */
+uint32_t HOST_OS_getDispatches(TaskType TaskID);
+
+/**
+ * \brief Ready priority of a task
+ * @param TaskID    Task identifier
+ * @return priority
+ */
+uint8_t HOST_OS_getPriority(TaskType TaskID);
+
+/**
+ * \brief Override the priority of a task, only allowed before StartOS
+ *
+ * The dispatch priority follows unless the task is non-preemptive, resource
+ * ceilings are recalculated by StartOS.
+ * @param TaskID    Task identifier
+ * @param prio      New ready priority (1..254)
+ * @return E_OK, E_OS_ID or E_OS_STATE once the OS is running
+ */
+StatusType HOST_OS_setPriority(TaskType TaskID, uint8_t prio);
+
+/*****************************************************************************/
+/* Virtual time (deterministic simulation)                                   */
+/*****************************************************************************/
+
+/**
+ * \brief Execution costs of the virtual CPU in ns
+ */
+typedef struct {
+    uint32_t callNs;                        /**< \brief Function entry of application code */
+    uint32_t osNs;                          /**< \brief OSEK service call */
+    uint32_t switchNs;                      /**< \brief Handing the CPU to another task or ISR */
+    uint32_t isrNs;                         /**< \brief ISR entry and exit */
+    uint32_t spiByteNs;                     /**< \brief One TFT SPI byte on the wire, writes block on a full TX FIFO */
+    uint32_t uartCharNs;                    /**< \brief Blocking transmit of one UART_LOG character */
+} HOST_SIM_cost_t;
+
+/**
+ * \brief Switch the shim to virtual time, has to be called before StartOS
+ *
+ * The virtual clock advances only by the charged costs, ISRs come from the
+ * event queue instead of other threads. The CPU starts halted, see
+ * #HOST_SIM_run.
+ * @param cost  Cost model, copied
+ */
+void HOST_SIM_enable(const HOST_SIM_cost_t *cost);
+
+/**
+ * \brief Virtual time is used
+ * @return 0 = real time, otherwise virtual time
+ */
+uint8_t HOST_SIM_isActive(void);
+
+/**
+ * \brief Cost model in use
+ * @return cost model
+ */
+const HOST_SIM_cost_t *HOST_SIM_getCost(void);
+
+/**
+ * \brief Current virtual time
+ * @return time in ns
+ */
+uint64_t HOST_SIM_now(void);
+
+/**
+ * \brief Let the virtual CPU execute for the given time
+ *
+ * Consumes the charged costs, runs due events as ISRs and skips idle time.
+ * Returns with the CPU halted, called from a non task thread.
+ * @param durationNs    Virtual time to run
+ * @return virtual time after the run
+ */
+uint64_t HOST_SIM_run(uint64_t durationNs);
+
+/**
+ * \brief Account execution time of the caller on the virtual CPU
+ *
+ * Due events preempt at the matching point in time, no-op in real time.
+ * @param ns    Execution time
+ */
+void HOST_SIM_charge(uint64_t ns);
+
+/**
+ * \brief Queue an ISR for the given virtual time, equal times keep their order
+ * @param atNs  Virtual time
+ * @param isr   ISR body, gets arg
+ * @param arg   Argument, e.g. a received byte
+ */
+void HOST_SIM_schedule(uint64_t atNs, void (*isr)(uint32_t arg), uint32_t arg);
+
+/**
+ * \brief Sleep until the next event (WFI), yields the CPU in real time
+ */
+void HOST_SIM_idle(void);
+
+/**
+ * \brief Virtual time spent sleeping in #HOST_SIM_idle, the rest is execution time
+ * @return time in ns
+ */
+uint64_t HOST_SIM_getIdleNs(void);
+
+/**
+ * \brief Mask events of the virtual time, e.g. for critical sections
+ * @param masked    0 = events are taken, otherwise they stay pending
+ * @return previous state
+ */
+uint8_t HOST_SIM_maskIsr(uint8_t masked);
+
+#endif /*EE_HOST_H*/
+
+/* [ee_host.h] END OF FILE */
@@ -0,0 +1,301 @@
+/**
+* \file hw_host.h
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Host stubs of the PSoC components (UART_LOG, TFT pins/SPI/PWM, CyLib)
+*
+* The UART receive path is driven by a scripted byte injector, which raises
+* isr_uartRX on the virtual CPU for every byte. Transmitted UART text can be
+* echoed and observed through a hook, SPI traffic to the TFT is counted. In
+* virtual time the TFT_SPI TX FIFO, its status and its interrupt are modelled.
+* The ST7735 behind the SPI is emulated: its frame memory can be read back
+* and saved as PPM image.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+#ifndef HW_HOST_H
+#define HW_HOST_H
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdint.h>
+
+/*****************************************************************************/
+/* Configuration                                                             */
+/*****************************************************************************/
+
+#define BCLK__BUS_CLK__HZ           24000000U   /**< \brief Bus clock of the PSoC project (cyfitter.h) */
+#define HOST_CYCLES_HZ              1000000000U /**< \brief Frequency of #HOST_getCycles (ns) */
+#define HOST_TFT_SPI_BITRATE        12000000U   /**< \brief TFT_SPI bit rate (24 MHz IntClock / 2) */
+#define HOST_UART_BAUD              115200U     /**< \brief UART_LOG baud rate */
+#define HOST_TFT_GRAM_W             128U        /**< \brief Columns of the emulated ST7735 frame memory (panel width) */
+#define HOST_TFT_GRAM_H             160U        /**< \brief Rows of the emulated ST7735 frame memory (panel height) */
+
+/** \brief Convert CPU cycles of the target (CPU runs with the bus clock) into ns */
+#define HOST_CYCLES_NS(c)           ((uint32_t)(((uint64_t)(c) * 1000000000u) / BCLK__BUS_CLK__HZ))
+
+/** \brief Virtual time cost model of the board, initializer of HOST_SIM_cost_t */
+#define HOST_SIM_COST_DEFAULT                                                   \
+    {                                                                           \
+        .callNs     = HOST_CYCLES_NS(20),                                       \
+        .osNs       = HOST_CYCLES_NS(60),                                       \
+        .switchNs   = HOST_CYCLES_NS(100),                                      \
+        .isrNs      = HOST_CYCLES_NS(40),                                       \
+        .spiByteNs  = (uint32_t)((8ull * 1000000000u) / HOST_TFT_SPI_BITRATE),  \
+        .uartCharNs = (uint32_t)((10ull * 1000000000u) / HOST_UART_BAUD),       \
+    }
+
+/*****************************************************************************/
+/* CyLib                                                                     */
+/*****************************************************************************/
+
+#define CyGlobalIntEnable           do { } while (0)    /**< \brief Interrupts are always enabled on the host */
+#define CY_PM_WFI                   HOST_SIM_idle()     /**< \brief Sleep until the next interrupt */
+
+void    CyDelay(uint32_t milliseconds);
+void    CyDelayUs(uint16_t microseconds);
+uint8_t CyEnterCriticalSection(void);
+void    CyExitCriticalSection(uint8_t savedIntrStatus);
+
+/*****************************************************************************/
+/* UART_LOG / isr_uartRX                                                     */
+/*****************************************************************************/
+
+void    UART_LOG_Start(void);
+void    UART_LOG_PutString(const char *string);
+void    UART_LOG_PutChar(uint8_t txDataByte);
+uint8_t UART_LOG_GetByte(void);
+void    isr_uartRX_ClearPending(void);
+
+/*****************************************************************************/
+/* TFT SPI, pins and backlight                                               */
+/*****************************************************************************/
+
+#define TFT_SPI_FIFO_SIZE           4u          /**< \brief Depth of the TX FIFO, the shifter holds one more byte */
+#define TFT_SPI_STS_SPI_DONE        0x01u       /**< \brief Last byte shifted out, sticky, cleared on read */
+#define TFT_SPI_STS_TX_FIFO_EMPTY   0x02u       /**< \brief TX FIFO empty */
+#define TFT_SPI_STS_TX_FIFO_NOT_FULL 0x04u      /**< \brief TX FIFO has room for a byte */
+#define TFT_SPI_STS_BYTE_COMPLETE   0x08u       /**< \brief Byte shifted out, not modelled */
+#define TFT_SPI_STS_SPI_IDLE        0x10u       /**< \brief Nothing to shift */
+
+void    TFT_SPI_Start(void);
+void    TFT_SPI_WriteTxData(uint8_t txData);
+uint8_t TFT_SPI_ReadTxStatus(void);
+void    TFT_SPI_SetTxInterruptMode(uint8_t intSrc);
+void    isr_tftTx_StartEx(void (*address)(void));
+void    TFT_DC_Write(uint8_t value);
+void    TFT_RES_Write(uint8_t value);
+void    TFT_BackLight_Start(void);
+void    TFT_BackLight_WriteCompare(uint8_t compare);
+uint8_t TFT_BackLight_ReadCompare(void);
+
+/*****************************************************************************/
+/* CyDmac, TFT_TxDma (DRQ: TFT_SPI tx_interrupt, nrq: ISR2 isr_tftDma)       */
+/*****************************************************************************/
+
+#define CYDEV_SRAM_BASE             0x1FFF8000u
+#define CYDEV_PERIPH_BASE           0x40004000u
+#define TFT_SPI_TXDATA_PTR          ((volatile uint8_t *)0x40006400u)  /**< \brief TX FIFO, the DMA model ignores the destination */
+
+#define CYRET_SUCCESS               0x00u       /**< \brief Status of the CyDmac calls */
+#define CYRET_BAD_PARAM             0x01u
+#define CY_DMA_DISABLE_TD           0xFEu       /**< \brief Next TD of the last TD, the channel disables itself */
+#define DMA_INVALID_TD              0xFFu       /**< \brief No TD left */
+#define TD_INC_SRC_ADR              0x01u
+#define TD_INC_DST_ADR              0x02u
+#define TD_TERMOUT0_EN              0x04u
+#define TD_TERMOUT1_EN              0x08u
+#define TD_AUTO_EXEC_NEXT           0x20u
+#define TFT_TxDma__TD_TERMOUT_EN    TD_TERMOUT0_EN  /**< \brief nrq of the channel */
+
+/*
+ * The TD chain is executed when the channel is enabled while the TX request
+ * is unmasked: every byte enters the TX FIFO as soon as it has room, the
+ * CPU is not charged, the nrq is raised after the last byte of a TD with
+ * TERMOUT. Source addresses are 32 bit bus addresses, they are resolved
+ * within the 4 GiB of the host image, so sources have to be static.
+ */
+uint8_t TFT_TxDma_DmaInitialize(uint8_t burstCount, uint8_t requestPerBurst, uint16_t upperSrcAddress,
+                                uint16_t upperDestAddress);
+uint8_t CyDmaTdAllocate(void);
+void    CyDmaTdFree(uint8_t tdHandle);
+uint8_t CyDmaTdSetConfiguration(uint8_t tdHandle, uint16_t transferCount, uint8_t nextTd, uint8_t configuration);
+uint8_t CyDmaTdSetAddress(uint8_t tdHandle, uint16_t source, uint16_t destination);
+uint8_t CyDmaChSetExtendedAddress(uint8_t chHandle, uint16_t source, uint16_t destination);
+uint8_t CyDmaChSetInitialTd(uint8_t chHandle, uint8_t startTd);
+uint8_t CyDmaChEnable(uint8_t chHandle, uint8_t preserveTds);
+uint8_t CyDmaChDisable(uint8_t chHandle);
+
+/*****************************************************************************/
+/* Host API                                                                  */
+/*****************************************************************************/
+
+/**
+ * \brief Free running 32 bit counter with #HOST_CYCLES_HZ
+ * @return counter value
+ */
+uint32_t HOST_getCycles(void);
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * @return time
+ */
+uint64_t HOST_getTimeNs(void);
+
+/**
+ * \brief Hook called for every string the application transmits via UART_LOG
+ */
+typedef void (*HOST_UART_txHook_t)(const char *string);
+
+/**
+ * \brief Echo transmitted UART text to stdout
+ * @param on    0 = quiet, otherwise echo
+ */
+void HOST_UART_setEcho(uint8_t on);
+
+/**
+ * \brief Install a hook observing the transmitted UART text
+ * @param hook  Hook or NULL
+ */
+void HOST_UART_setTxHook(HOST_UART_txHook_t hook);
+
+/**
+ * \brief Hook called for every message injected from a script
+ */
+typedef void (*HOST_UART_rxHook_t)(const uint8_t *msg, uint16_t len, uint64_t eomNs);
+
+/**
+ * \brief Install a hook observing the messages of #HOST_UART_injectScript
+ * @param hook  Hook or NULL, gets the message without EOM and the time its EOM was received
+ */
+void HOST_UART_setRxHook(HOST_UART_rxHook_t hook);
+
+/**
+ * \brief Pace injected bytes like a real UART
+ * @param baud  Baud rate (8N1, 10 bit per byte), 0 = inject back to back
+ */
+void HOST_UART_setBaud(uint32_t baud);
+
+/**
+ * \brief Inject bytes into the UART receiver, raises isr_uartRX per byte
+ *
+ * In virtual time the bytes are queued behind the previous ones.
+ * @param data  Received bytes
+ * @param len   Number of bytes
+ * @return time the last byte was (or will be) received
+ */
+uint64_t HOST_UART_inject(const uint8_t *data, uint16_t len);
+
+/**
+ * \brief Keep the receive line idle after the last injected byte
+ * @param microseconds  Idle time
+ */
+void HOST_UART_pause(uint32_t microseconds);
+
+/**
+ * \brief Inject the messages of a script file
+ *
+ * One message per line, decimal byte values separated by ',' or blanks, the
+ * EOM marker is appended. "delay <ms>" pauses, '#' starts a comment. A
+ * leading "@<us>" starts the message at this time after the call (captured
+ * traces), later than the previous message at the earliest.
+ * @param path  Script file
+ * @return number of injected messages, -1 if the file can not be opened
+ */
+int32_t HOST_UART_injectScript(const char *path);
+
+/**
+ * \brief Received bytes lost because the RX FIFO was full (virtual time only)
+ * @return byte count
+ */
+uint32_t HOST_UART_getOverruns(void);
+
+/**
+ * \brief Bytes written to the TFT SPI since start
+ * @return byte count
+ */
+uint64_t HOST_TFT_getTxBytes(void);
+
+/**
+ * \brief Command bytes (DC low) written to the TFT SPI since start
+ * @return byte count
+ */
+uint64_t HOST_TFT_getCmdBytes(void);
+
+/**
+ * \brief Changes of the DC pin while a byte was still on the wire (virtual time only)
+ * @return count, every change corrupts the type of a byte
+ */
+uint64_t HOST_TFT_getDcGlitches(void);
+
+/**
+ * \brief TFT SPI has nothing to send, its TX interrupt is disabled and no DMA chain runs
+ * @return 0 = busy, otherwise idle
+ */
+uint8_t HOST_TFT_isTxIdle(void);
+
+/**
+ * \brief Bytes the DMA moved into the TFT SPI TX FIFO since start
+ * @return byte count, included in #HOST_TFT_getTxBytes
+ */
+uint64_t HOST_TFT_getDmaBytes(void);
+
+/**
+ * \brief Violations found by the ST7735 command stream checker since start
+ *
+ * Unknown commands, missing or surplus parameters, data before the first
+ * command and RAMWR data not filling the CASET/RASET window exactly, which
+ * is what lost or duplicated bytes look like. A command is checked when the
+ * next one starts, the first violations are printed to stderr.
+ * @return error count, 0 = consistent stream
+ */
+uint64_t HOST_TFT_getStreamErrors(void);
+/**
+ * \brief Traffic of the TFT SPI by type, counted by the ST7735 emulation since start
+ */
+typedef struct {
+    uint64_t    txBytes;                    /**< \brief All bytes, see #HOST_TFT_getTxBytes */
+    uint64_t    cmdBytes;                   /**< \brief Command bytes (DC low) */
+    uint64_t    dataBytes;                  /**< \brief Parameter and pixel bytes (DC high) */
+    uint64_t    caset;                      /**< \brief Column address commands */
+    uint64_t    raset;                      /**< \brief Row address commands */
+    uint64_t    ramwr;                      /**< \brief Memory writes, one per drawn window */
+    uint64_t    pixels;                     /**< \brief Pixels written to the frame memory */
+} HOST_TFT_stats_t;
+/**
+ * \brief Read the traffic counters of the TFT SPI
+ * @param stats Counters since start, callers take differences
+ */
+void HOST_TFT_getStats(HOST_TFT_stats_t *stats);
+/**
+ * \brief Pixel of the emulated panel
+ *
+ * Coordinates are those of the frame memory, which is the screen of the
+ * board orientation TFT_rot_180 (MADCTL without MX/MY), other rotations
+ * show up rotated like on the real display. Colors are those seen on the
+ * BGR panel, display inversion and vertical scrolling are applied.
+ * @param x     Column, 0 ... #HOST_TFT_GRAM_W - 1
+ * @param y     Row, 0 ... #HOST_TFT_GRAM_H - 1
+ * @return RGB565 color, 0 outside the panel
+ */
+uint16_t HOST_TFT_getPixel(uint16_t x, uint16_t y);
+/**
+ * \brief Save the emulated panel as binary PPM (P6) image
+ * @param path  Image file
+ * @return 0 on success, -1 if the file can not be written
+ */
+int32_t HOST_TFT_writePpm(const char *path);
+
+#endif /*HW_HOST_H*/
+
+/* [hw_host.h] END OF FILE */
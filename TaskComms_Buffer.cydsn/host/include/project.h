@@ -0,0 +1,36 @@
+/**
+* \file project.h
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Host replacement of the PSoC Creator generated project.h
+*
+* Pulls in the ErikaOS shim and the stubs of the hardware components which
+* are used by source/asw and source/bsw, so the application compiles
+* unchanged on a POSIX host.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "ee_host.h"
+#include "hw_host.h"
+
+#endif /*PROJECT_H*/
+
+/* [project.h] END OF FILE */
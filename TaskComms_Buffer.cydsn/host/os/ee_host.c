@@ -0,0 +1,976 @@
+/**
+* \file ee_host.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief pthread based shim of the ErikaOS (OSEK) API used by the application
+*
+* Every task runs in its own thread, but only the owner of the virtual CPU
+* executes. Ownership is handed over under #os_lock by #os_select, all other
+* threads sleep on #os_cv until they are selected.
+*
+* In virtual time (#HOST_SIM_enable) the owner advances #os_simNowNs by the
+* charged costs and takes due events of #os_simQueue as ISRs on its own
+* thread. Handover stays the same, so the run order only depends on the
+* costs and the event times.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ee_host.h"
+#include "hw_host.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define OS_OWNER_IDLE       (-1)            /**< \brief No task ready, CPU idle */
+#define OS_OWNER_ISR        (-2)            /**< \brief An ISR owns the CPU */
+#define OS_MAX_PRIORITY     0xFF            /**< \brief Dispatch priority of non-preemptive tasks */
+
+/**
+ * \brief Static task configuration, mirrors ErikaOS_eecfg.c
+ */
+typedef struct {
+    void     (*body)(void);                 /**< \brief Task body */
+    uint8_t  readyPrio;                     /**< \brief Priority while ready */
+    uint8_t  dispatchPrio;                  /**< \brief Priority while running (MAX for non-preemptive) */
+    uint8_t  autostart;                     /**< \brief Activated by StartOS */
+} os_taskCfg_t;
+
+/**
+ * \brief Runtime state of a task
+ */
+typedef struct {
+    HOST_OS_taskState_t state;              /**< \brief OSEK state */
+    uint8_t             started;            /**< \brief Body entered since the last activation */
+    uint8_t             prio;               /**< \brief Current priority once started */
+    EventMaskType       set;                /**< \brief Pending events */
+    EventMaskType       wait;               /**< \brief Events waited for */
+    uint32_t            stamp;              /**< \brief Order of becoming ready, FIFO within a priority */
+    uint32_t            dispatches;         /**< \brief Times the task got the CPU */
+    jmp_buf             exit;               /**< \brief Return point of TerminateTask */
+    pthread_t           thread;             /**< \brief Thread executing the task */
+} os_task_t;
+
+/**
+ * \brief ISR queued for a point in virtual time
+ */
+typedef struct {
+    uint64_t    atNs;                       /**< \brief Virtual time of the request */
+    uint32_t    seq;                        /**< \brief Order of scheduling, tie breaker */
+    void        (*isr)(uint32_t arg);       /**< \brief ISR body */
+    uint32_t    arg;                        /**< \brief Argument of the ISR */
+} os_simEvent_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+DeclareTask(tsk_init);
+DeclareTask(tsk_background);
+DeclareTask(tsk_sender);
+DeclareTask(tsk_tft);
+DeclareTask(tsk_uart);
+
+static os_taskCfg_t os_taskCfg[EE_MAX_TASK] = {
+    [tsk_init]       = { Functsk_init,       1,  OS_MAX_PRIORITY, 1 },
+    [tsk_background] = { Functsk_background, 1,  1,               0 },
+    [tsk_sender]     = { Functsk_sender,     16, 16,              0 },
+    [tsk_tft]        = { Functsk_tft,        8,  8,               0 },
+    [tsk_uart]       = { Functsk_uart,       8,  8,               0 },
+};
+
+/** \brief Tasks accessing a resource, the ceiling is their highest ready priority */
+static const uint32_t os_resUsers[EE_MAX_RESOURCE] = {
+    [res_dyn]    = (1u << tsk_init) | (1u << tsk_sender) | (1u << tsk_tft) | (1u << tsk_uart),
+    [res_stream] = (1u << tsk_init) | (1u << tsk_sender),
+};
+
+static uint8_t          os_resCeiling[EE_MAX_RESOURCE];     /**< \brief Calculated by StartOS */
+
+static os_task_t        os_task[EE_MAX_TASK];
+static uint8_t          os_resSavedPrio[EE_MAX_RESOURCE];  /**< \brief Priority of the holder before GetResource */
+
+static pthread_mutex_t  os_lock     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   os_cv       = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t  os_isrLock  = PTHREAD_MUTEX_INITIALIZER;    /**< \brief ISRs do not nest */
+
+static TaskType         os_owner    = OS_OWNER_IDLE;    /**< \brief Current owner of the CPU */
+static TaskType         os_running  = INVALID_TASK;     /**< \brief Task in RUNNING state, possibly interrupted */
+static uint32_t         os_isrPending;                  /**< \brief ISRs waiting for the CPU */
+static volatile int     os_preempt;                     /**< \brief Fast path flag for #HOST_OS_preemptionPoint */
+static uint32_t         os_seq;
+static uint32_t         os_switches;
+static uint8_t          os_started;                     /**< \brief StartOS was called */
+
+static __thread TaskType os_self    = INVALID_TASK;     /**< \brief Task executed by the calling thread */
+
+static uint32_t         os_tickPeriodNs = 1000000u;     /**< \brief Systick period */
+static pthread_t        os_tickThread;
+
+extern void systick_handler(void) __attribute__((weak));
+
+static uint8_t          os_sim;                         /**< \brief Virtual time enabled */
+static HOST_SIM_cost_t  os_simCost;
+static volatile uint64_t os_simNowNs;                   /**< \brief Virtual clock */
+static uint64_t         os_simStopNs;                   /**< \brief CPU halts when the clock reaches this time */
+static volatile uint8_t os_simHalted;
+static uint8_t          os_simInIsr;                    /**< \brief ISRs do not nest */
+static uint8_t          os_simMasked;                   /**< \brief Events stay pending, see #HOST_SIM_maskIsr */
+static uint64_t         os_simIdleNs;                   /**< \brief Time slept in #HOST_SIM_idle */
+static os_simEvent_t   *os_simQueue;                    /**< \brief Binary heap ordered by time and seq */
+static uint32_t         os_simEvents;
+static uint32_t         os_simCapacity;
+static uint32_t         os_simSeq;
+static uint64_t         os_simTickNs;                   /**< \brief Time of the next systick event */
+
+static __thread uint8_t os_simDriver;                   /**< \brief Calling thread runs #HOST_SIM_run */
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Effective priority of a task competing for the CPU.
+ */
+static uint8_t os_prio(TaskType t)
+{
+    return os_task[t].started ? os_task[t].prio : os_taskCfg[t].readyPrio;
+}
+
+/**
+ * Hand the CPU to the next owner. Called with os_lock held by the thread that
+ * currently owns (or gives up) the CPU. A pending ISR always wins, otherwise
+ * the highest priority task; the running task keeps the CPU on equal priority.
+ */
+static void os_select(void)
+{
+    TaskType prev = os_owner;
+    TaskType best = INVALID_TASK;
+
+    if (os_isrPending > 0)
+    {
+        os_owner = OS_OWNER_ISR;
+    }
+    else
+    {
+        best = os_running;
+        for (TaskType t = 0; t < EE_MAX_TASK; t++)
+        {
+            if (os_task[t].state != HOST_TASK_READY)
+            {
+                continue;
+            }
+            if ((best == INVALID_TASK)
+                || (os_prio(t) > os_prio(best))
+                || ((best != os_running) && (os_prio(t) == os_prio(best)) && (os_task[t].stamp < os_task[best].stamp)))
+            {
+                best = t;
+            }
+        }
+
+        /* Running task is preempted and stays at the head of its priority. */
+        if ((os_running != INVALID_TASK) && (best != os_running))
+        {
+            os_task[os_running].state = HOST_TASK_READY;
+        }
+
+        if (best != INVALID_TASK)
+        {
+            os_task_t *task = &os_task[best];
+            if (!task->started)
+            {
+                task->started = 1;
+                task->prio    = os_taskCfg[best].dispatchPrio;
+            }
+            if (task->state != HOST_TASK_RUNNING)
+            {
+                task->dispatches++;
+            }
+            task->state = HOST_TASK_RUNNING;
+        }
+        os_running = best;
+        os_owner   = (best == INVALID_TASK) ? OS_OWNER_IDLE : best;
+    }
+
+    if (os_owner != prev)
+    {
+        os_switches++;
+        os_simNowNs += os_simCost.switchNs;
+    }
+    pthread_cond_broadcast(&os_cv);
+}
+
+/**
+ * Block the calling thread until it owns the CPU. Called with os_lock held.
+ */
+static void os_waitCpu(TaskType me)
+{
+    while (os_owner != me)
+    {
+        pthread_cond_wait(&os_cv, &os_lock);
+    }
+}
+
+/**
+ * Rescheduling point of a task after it made another task ready or lowered
+ * its priority. Called with os_lock held, ISRs never reschedule.
+ */
+static void os_schedule(void)
+{
+    if (os_self == INVALID_TASK)
+    {
+        return;
+    }
+    os_select();
+    os_waitCpu(os_self);
+}
+
+/**
+ * Move the calling task to SUSPENDED and give up the CPU.
+ */
+static void os_terminate(void)
+{
+    pthread_mutex_lock(&os_lock);
+    os_task[os_self].state   = HOST_TASK_SUSPENDED;
+    os_task[os_self].started = 0;
+    os_running = INVALID_TASK;
+    os_select();
+    pthread_mutex_unlock(&os_lock);
+}
+
+/**
+ * Thread executing one task, the body is re-entered on every activation.
+ */
+static void *os_taskThread(void *arg)
+{
+    os_self = (TaskType)(intptr_t)arg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&os_lock);
+        os_waitCpu(os_self);
+        pthread_mutex_unlock(&os_lock);
+
+        if (0 == setjmp(os_task[os_self].exit))
+        {
+            os_taskCfg[os_self].body();
+            /* Returning from a task body is handled like TerminateTask. */
+            os_terminate();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Thread raising the systick ISR with the configured period.
+ */
+static void *os_tickThreadFn(void *arg)
+{
+    struct timespec next;
+    (void)arg;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (;;)
+    {
+        next.tv_nsec += os_tickPeriodNs;
+        while (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        HOST_OS_raiseIsr(systick_handler);
+    }
+    return NULL;
+}
+
+/**
+ * Heap order of two events, earlier time first, equal times in FIFO order.
+ */
+static int os_simBefore(const os_simEvent_t *a, const os_simEvent_t *b)
+{
+    return (a->atNs < b->atNs) || ((a->atNs == b->atNs) && (a->seq < b->seq));
+}
+
+/**
+ * Remove the earliest event from the queue. Called with os_lock held.
+ */
+static os_simEvent_t os_simPop(void)
+{
+    os_simEvent_t first = os_simQueue[0];
+    os_simEvent_t last  = os_simQueue[--os_simEvents];
+    uint32_t      i     = 0;
+
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= os_simEvents)
+        {
+            break;
+        }
+        if ((child + 1 < os_simEvents) && os_simBefore(&os_simQueue[child + 1], &os_simQueue[child]))
+        {
+            child++;
+        }
+        if (!os_simBefore(&os_simQueue[child], &last))
+        {
+            break;
+        }
+        os_simQueue[i] = os_simQueue[child];
+        i = child;
+    }
+    if (os_simEvents > 0)
+    {
+        os_simQueue[i] = last;
+    }
+    return first;
+}
+
+/**
+ * Block the owner of the CPU until #HOST_SIM_run continues.
+ */
+static void os_simHalt(void)
+{
+    pthread_mutex_lock(&os_lock);
+    os_simHalted = 1;
+    pthread_cond_broadcast(&os_cv);
+    while (os_simHalted)
+    {
+        pthread_cond_wait(&os_cv, &os_lock);
+    }
+    pthread_mutex_unlock(&os_lock);
+}
+
+/**
+ * Execute an event as ISR. Called with os_lock held by the thread owning the
+ * CPU, returns with os_lock held after the next owner has been selected.
+ */
+static void os_simIsr(void)
+{
+    TaskType      me = os_self;
+    os_simEvent_t ev = os_simPop();
+
+    os_owner = OS_OWNER_ISR;
+    os_switches++;
+    pthread_mutex_unlock(&os_lock);
+
+    os_self     = INVALID_TASK;
+    os_simInIsr = 1;
+    HOST_SIM_charge(os_simCost.isrNs);
+    ev.isr(ev.arg);
+    os_simInIsr = 0;
+    os_self     = me;
+
+    pthread_mutex_lock(&os_lock);
+    os_select();
+}
+
+/**
+ * Run due events as ISRs in main() before StartOS, there is no task to
+ * interrupt and no dispatch afterwards.
+ */
+static void os_simPollMain(void)
+{
+    pthread_mutex_lock(&os_lock);
+    while ((os_simEvents > 0) && (os_simQueue[0].atNs <= os_simNowNs))
+    {
+        os_simEvent_t ev = os_simPop();
+        pthread_mutex_unlock(&os_lock);
+
+        os_simInIsr = 1;
+        HOST_SIM_charge(os_simCost.isrNs);
+        ev.isr(ev.arg);
+        os_simInIsr = 0;
+
+        pthread_mutex_lock(&os_lock);
+    }
+    pthread_mutex_unlock(&os_lock);
+}
+
+/**
+ * Main thread of the application before StartOS, takes interrupts.
+ */
+static int os_simIsMain(void)
+{
+    return !os_started && !os_simDriver && (os_self == INVALID_TASK);
+}
+
+/**
+ * Take due events as ISRs. Called by the owner of the CPU, only a task (or
+ * main() before StartOS) can be interrupted.
+ */
+static void os_simPoll(void)
+{
+    if (os_simInIsr || os_simMasked)
+    {
+        return;
+    }
+    if (os_simIsMain())
+    {
+        os_simPollMain();
+        return;
+    }
+    if (os_self == INVALID_TASK)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    while ((os_simEvents > 0) && (os_simQueue[0].atNs <= os_simNowNs))
+    {
+        os_simIsr();
+        os_waitCpu(os_self);
+    }
+    pthread_mutex_unlock(&os_lock);
+}
+
+/**
+ * Periodic systick event, re-queues itself.
+ */
+static void os_simTick(uint32_t arg)
+{
+    (void)arg;
+    os_simTickNs += os_tickPeriodNs;
+    HOST_SIM_schedule(os_simTickNs, os_simTick, 0);
+    systick_handler();
+}
+
+/*****************************************************************************/
+/* OSEK API                                                                  */
+/*****************************************************************************/
+
+StatusType ActivateTask(TaskType TaskID)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if ((TaskID < 0) || (TaskID >= EE_MAX_TASK))
+    {
+        return E_OS_ID;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    os_task_t *task = &os_task[TaskID];
+    if (task->state != HOST_TASK_SUSPENDED)
+    {
+        pthread_mutex_unlock(&os_lock);
+        return E_OS_LIMIT;
+    }
+    task->state   = HOST_TASK_READY;
+    task->started = 0;
+    task->set     = 0;
+    task->stamp   = ++os_seq;
+    os_schedule();
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType TerminateTask(void)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if (os_self == INVALID_TASK)
+    {
+        return E_OS_ACCESS;
+    }
+    os_terminate();
+    longjmp(os_task[os_self].exit, 1);
+}
+
+StatusType GetTaskID(TaskType *TaskID)
+{
+    *TaskID = os_self;
+    return E_OK;
+}
+
+StatusType SetEvent(TaskType TaskID, EventMaskType Mask)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if ((TaskID < 0) || (TaskID >= EE_MAX_TASK))
+    {
+        return E_OS_ID;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    os_task_t *task = &os_task[TaskID];
+    if (task->state == HOST_TASK_SUSPENDED)
+    {
+        pthread_mutex_unlock(&os_lock);
+        return E_OS_STATE;
+    }
+    task->set |= Mask;
+    if ((task->state == HOST_TASK_WAITING) && (task->set & task->wait))
+    {
+        task->state = HOST_TASK_READY;
+        task->stamp = ++os_seq;
+        os_schedule();
+    }
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType ClearEvent(EventMaskType Mask)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if (os_self == INVALID_TASK)
+    {
+        return E_OS_ACCESS;
+    }
+    pthread_mutex_lock(&os_lock);
+    os_task[os_self].set &= ~Mask;
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType GetEvent(TaskType TaskID, EventMaskRefType Event)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if ((TaskID < 0) || (TaskID >= EE_MAX_TASK))
+    {
+        return E_OS_ID;
+    }
+    pthread_mutex_lock(&os_lock);
+    *Event = os_task[TaskID].set;
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType WaitEvent(EventMaskType Mask)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if (os_self == INVALID_TASK)
+    {
+        return E_OS_ACCESS;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    os_task_t *task = &os_task[os_self];
+    if (0 == (task->set & Mask))
+    {
+        task->wait  = Mask;
+        task->state = HOST_TASK_WAITING;
+        os_running  = INVALID_TASK;
+        os_select();
+        os_waitCpu(os_self);
+    }
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType GetResource(ResourceType ResID)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if ((ResID >= EE_MAX_RESOURCE) || (os_self == INVALID_TASK))
+    {
+        return E_OS_ID;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    os_task_t *task = &os_task[os_self];
+    os_resSavedPrio[ResID] = task->prio;
+    if (os_resCeiling[ResID] > task->prio)
+    {
+        task->prio = os_resCeiling[ResID];
+    }
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType ReleaseResource(ResourceType ResID)
+{
+    HOST_SIM_charge(os_simCost.osNs);
+    if ((ResID >= EE_MAX_RESOURCE) || (os_self == INVALID_TASK))
+    {
+        return E_OS_ID;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    os_task[os_self].prio = os_resSavedPrio[ResID];
+    os_schedule();
+    pthread_mutex_unlock(&os_lock);
+    return E_OK;
+}
+
+StatusType CounterTick(CounterType CounterID)
+{
+    /* No alarm is used by the application, the counter is not emulated. */
+    (void)CounterID;
+    return E_OK;
+}
+
+void StartOS(AppModeType Mode)
+{
+    (void)Mode;
+
+    for (ResourceType r = 0; r < EE_MAX_RESOURCE; r++)
+    {
+        for (TaskType t = 0; t < EE_MAX_TASK; t++)
+        {
+            if ((os_resUsers[r] & (1u << t)) && (os_taskCfg[t].readyPrio > os_resCeiling[r]))
+            {
+                os_resCeiling[r] = os_taskCfg[t].readyPrio;
+            }
+        }
+    }
+    os_started = 1;
+
+    for (TaskType t = 0; t < EE_MAX_TASK; t++)
+    {
+        pthread_create(&os_task[t].thread, NULL, os_taskThread, (void *)(intptr_t)t);
+    }
+
+    pthread_mutex_lock(&os_lock);
+    for (TaskType t = 0; t < EE_MAX_TASK; t++)
+    {
+        if (os_taskCfg[t].autostart)
+        {
+            os_task[t].state = HOST_TASK_READY;
+            os_task[t].stamp = ++os_seq;
+        }
+    }
+    os_select();
+    pthread_mutex_unlock(&os_lock);
+
+    /* Like on the target, StartOS does not return. */
+    for (;;)
+    {
+        pause();
+    }
+}
+
+/*****************************************************************************/
+/* Cortex-M port API                                                         */
+/*****************************************************************************/
+
+void EE_system_init(void)
+{
+}
+
+void EE_systick_set_period(uint32_t period)
+{
+    os_tickPeriodNs = (uint32_t)(((uint64_t)period * 1000000000u) / BCLK__BUS_CLK__HZ);
+}
+
+void EE_systick_enable_int(void)
+{
+}
+
+void EE_systick_start(void)
+{
+    if (systick_handler == NULL)
+    {
+        return;
+    }
+    if (os_sim)
+    {
+        os_simTickNs = os_simNowNs + os_tickPeriodNs;
+        HOST_SIM_schedule(os_simTickNs, os_simTick, 0);
+    }
+    else
+    {
+        pthread_create(&os_tickThread, NULL, os_tickThreadFn, NULL);
+    }
+}
+
+/*****************************************************************************/
+/* Host API                                                                  */
+/*****************************************************************************/
+
+void HOST_OS_raiseIsr(void (*isr)(void))
+{
+    pthread_mutex_lock(&os_isrLock);
+
+    pthread_mutex_lock(&os_lock);
+    os_isrPending++;
+    os_preempt = 1;
+    if (os_owner == OS_OWNER_IDLE)
+    {
+        os_select();
+    }
+    os_waitCpu(OS_OWNER_ISR);
+    os_isrPending--;
+    os_preempt = (os_isrPending > 0);
+    pthread_mutex_unlock(&os_lock);
+
+    isr();
+
+    /* Resume the interrupted task or dispatch a task released by the ISR. */
+    pthread_mutex_lock(&os_lock);
+    os_select();
+    pthread_mutex_unlock(&os_lock);
+
+    pthread_mutex_unlock(&os_isrLock);
+}
+
+void HOST_OS_preemptionPoint(void)
+{
+    if (os_sim)
+    {
+        HOST_SIM_charge(os_simCost.callNs);
+        return;
+    }
+    if (!os_preempt || (os_self == INVALID_TASK))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&os_lock);
+    if ((os_isrPending > 0) && (os_owner == os_self))
+    {
+        os_select();
+        os_waitCpu(os_self);
+    }
+    pthread_mutex_unlock(&os_lock);
+}
+
+HOST_OS_taskState_t HOST_OS_getTaskState(TaskType TaskID)
+{
+    pthread_mutex_lock(&os_lock);
+    HOST_OS_taskState_t state = os_task[TaskID].state;
+    pthread_mutex_unlock(&os_lock);
+    return state;
+}
+
+uint32_t HOST_OS_getContextSwitches(void)
+{
+    return os_switches;
+}
+
+uint32_t HOST_OS_getDispatches(TaskType TaskID)
+{
+    return os_task[TaskID].dispatches;
+}
+
+uint8_t HOST_OS_getPriority(TaskType TaskID)
+{
+    return os_taskCfg[TaskID].readyPrio;
+}
+
+StatusType HOST_OS_setPriority(TaskType TaskID, uint8_t prio)
+{
+    if ((TaskID < 0) || (TaskID >= EE_MAX_TASK) || (0 == prio) || (prio >= OS_MAX_PRIORITY))
+    {
+        return E_OS_ID;
+    }
+    if (os_started)
+    {
+        return E_OS_STATE;
+    }
+
+    if (os_taskCfg[TaskID].dispatchPrio != OS_MAX_PRIORITY)
+    {
+        os_taskCfg[TaskID].dispatchPrio = prio;
+    }
+    os_taskCfg[TaskID].readyPrio = prio;
+    return E_OK;
+}
+
+/*****************************************************************************/
+/* Virtual time                                                              */
+/*****************************************************************************/
+
+void HOST_SIM_enable(const HOST_SIM_cost_t *cost)
+{
+    os_simCost   = *cost;
+    os_simNowNs  = 0;
+    os_simStopNs = 0;       /* halted until the first HOST_SIM_run */
+    os_sim       = 1;
+}
+
+uint8_t HOST_SIM_isActive(void)
+{
+    return os_sim;
+}
+
+const HOST_SIM_cost_t *HOST_SIM_getCost(void)
+{
+    return &os_simCost;
+}
+
+uint64_t HOST_SIM_now(void)
+{
+    return os_simNowNs;
+}
+
+uint64_t HOST_SIM_run(uint64_t durationNs)
+{
+    os_simDriver = 1;
+
+    pthread_mutex_lock(&os_lock);
+    os_simStopNs = os_simNowNs + durationNs;
+    os_simHalted = 0;
+    pthread_cond_broadcast(&os_cv);
+
+    for (;;)
+    {
+        while (!os_simHalted && (os_owner != OS_OWNER_IDLE))
+        {
+            pthread_cond_wait(&os_cv, &os_lock);
+        }
+        if (os_simHalted)
+        {
+            break;
+        }
+
+        /* No task ready: skip the idle time up to the next event. */
+        if ((0 == os_simEvents) || (os_simQueue[0].atNs >= os_simStopNs))
+        {
+            if (os_simNowNs < os_simStopNs)
+            {
+                os_simNowNs = os_simStopNs;
+            }
+            os_simHalted = 1;
+            break;
+        }
+        if (os_simQueue[0].atNs > os_simNowNs)
+        {
+            os_simNowNs = os_simQueue[0].atNs;
+        }
+        os_simIsr();
+    }
+    pthread_mutex_unlock(&os_lock);
+
+    return os_simNowNs;
+}
+
+void HOST_SIM_charge(uint64_t ns)
+{
+    if (!os_sim)
+    {
+        return;
+    }
+
+    /* Only a task or ISR on the virtual CPU halts, not main() before StartOS. */
+    uint8_t owner = os_started && !os_simDriver && ((os_self != INVALID_TASK) || os_simInIsr);
+    uint8_t takes = !os_simInIsr && !os_simMasked && ((os_self != INVALID_TASK) || os_simIsMain());
+
+    /* Advance in steps, so events preempt long operations in time. */
+    for (;;)
+    {
+        uint64_t target = os_simNowNs + ns;
+        uint64_t step   = target;
+
+        if ((os_simEvents > 0) && takes && (os_simQueue[0].atNs < step))
+        {
+            step = (os_simQueue[0].atNs > os_simNowNs) ? os_simQueue[0].atNs : os_simNowNs;
+        }
+        if ((os_simStopNs < step) && owner)
+        {
+            step = (os_simStopNs > os_simNowNs) ? os_simStopNs : os_simNowNs;
+        }
+        ns -= step - os_simNowNs;
+        os_simNowNs = step;
+
+        if ((os_simNowNs >= os_simStopNs) && owner)
+        {
+            os_simHalt();
+        }
+        os_simPoll();
+
+        if (0 == ns)
+        {
+            break;
+        }
+    }
+}
+
+void HOST_SIM_schedule(uint64_t atNs, void (*isr)(uint32_t arg), uint32_t arg)
+{
+    pthread_mutex_lock(&os_lock);
+    if (os_simEvents == os_simCapacity)
+    {
+        os_simCapacity = (0 == os_simCapacity) ? 256 : 2 * os_simCapacity;
+        os_simQueue    = realloc(os_simQueue, os_simCapacity * sizeof(os_simEvent_t));
+        if (NULL == os_simQueue)
+        {
+            abort();
+        }
+    }
+
+    os_simEvent_t ev = { atNs, os_simSeq++, isr, arg };
+    uint32_t      i  = os_simEvents++;
+
+    while ((i > 0) && os_simBefore(&ev, &os_simQueue[(i - 1) / 2]))
+    {
+        os_simQueue[i] = os_simQueue[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    os_simQueue[i] = ev;
+    pthread_mutex_unlock(&os_lock);
+}
+
+void HOST_SIM_idle(void)
+{
+    if (!os_sim)
+    {
+        sched_yield();
+        return;
+    }
+
+    uint64_t ns = os_simCost.callNs;
+
+    pthread_mutex_lock(&os_lock);
+    if ((os_simEvents > 0) && (os_simQueue[0].atNs > os_simNowNs))
+    {
+        ns = os_simQueue[0].atNs - os_simNowNs;
+    }
+    os_simIdleNs += ns;
+    pthread_mutex_unlock(&os_lock);
+    HOST_SIM_charge(ns);
+}
+
+uint64_t HOST_SIM_getIdleNs(void)
+{
+    return os_simIdleNs;
+}
+
+uint8_t HOST_SIM_maskIsr(uint8_t masked)
+{
+    uint8_t prev = os_simMasked;
+    os_simMasked = masked;
+    if (prev && !masked)
+    {
+        os_simPoll();
+    }
+    return prev;
+}
+
+/*****************************************************************************/
+/* Instrumentation hooks (-finstrument-functions)                            */
+/*****************************************************************************/
+
+void __cyg_profile_func_enter(void *fn, void *site) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void *fn, void *site) __attribute__((no_instrument_function));
+
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    (void)fn;
+    (void)site;
+    HOST_OS_preemptionPoint();
+}
+
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    (void)fn;
+    (void)site;
+}
+
+/* [ee_host.c] END OF FILE */
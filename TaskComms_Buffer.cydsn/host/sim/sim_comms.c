@@ -0,0 +1,561 @@
+/**
+* \file sim_comms.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Deterministic replay of UART input on a virtual clock
+*
+* Runs the unchanged application on the ErikaOS shim in virtual time: one
+* simulated CPU, OSEK priorities and preemption as configured, execution
+* costs from a configurable cost model. The UART input comes from a captured
+* trace or a generated burst, every run with the same input and model gives
+* the same result.
+*
+* Forwarded lines of tsk_uart are matched against the injected messages by
+* content in FIFO order. The queue depths and the losses per buffer are taken
+* from the comms API, which is wrapped at link time (-Wl,--wrap).
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "project.h"
+#include "comms.h"
+#include "cpuload.h"
+#include "tft.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define SIM_MESSAGES            100         /**< \brief Default number of generated messages */
+#define SIM_LENGTH              8           /**< \brief Default data bytes per generated message */
+#define SIM_GAP_US              5000        /**< \brief Default idle time between generated messages, sustainable in all TFT builds */
+#define SIM_MAX_LENGTH          126         /**< \brief Longest message the comms layer accepts */
+#define SIM_BAUD                HOST_UART_BAUD  /**< \brief Default UART baud rate (RX pacing and TX cost) */
+#define SIM_DRAIN_MS            200         /**< \brief Stop once nothing was forwarded for this time after the last EOM */
+#define SIM_STEP_NS             1000000u    /**< \brief Granularity of the run loop */
+#define SIM_START_STEPS         5000        /**< \brief Steps allowed for tsk_init */
+
+/**
+ * \brief One injected message
+ */
+typedef struct {
+    uint8_t     data[SIM_MAX_LENGTH];       /**< \brief Message bytes without EOM */
+    uint16_t    len;                        /**< \brief Number of bytes */
+    uint64_t    eomNs;                      /**< \brief EOM received */
+    uint64_t    doneNs;                     /**< \brief Line forwarded by tsk_uart, 0 = not yet */
+    uint8_t     missed;                     /**< \brief Overtaken by a later message, will never arrive */
+} sim_msg_t;
+
+/**
+ * \brief Queue and loss statistics, collected by the wrapped comms API
+ */
+typedef struct {
+    uint16_t    streamMax;                  /**< \brief Highest fill level of uartRB in bytes */
+    uint16_t    dynMax;                     /**< \brief Highest fill level of sharedRB in slots */
+    uint32_t    rxDropped;                  /**< \brief Bytes rejected by streamRB_write */
+    uint32_t    streamFlushes;              /**< \brief Resynchronisations of uartRB */
+    uint32_t    dynSends;                   /**< \brief Entries queued to sharedRB */
+    uint32_t    dynFailed;                  /**< \brief Entries rejected by dynRB_send */
+    uint32_t    dynFlushes;                 /**< \brief Recoveries flushing sharedRB */
+} sim_stats_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+extern int app_main();
+
+static sim_msg_t           *sim_msg;
+static uint32_t             sim_msgs;               /**< \brief Injected messages */
+static uint32_t             sim_msgCapacity;
+static uint32_t             sim_head;               /**< \brief Oldest message not forwarded or missed */
+static uint32_t             sim_received;           /**< \brief Forwarded lines */
+static uint32_t             sim_unexpected;         /**< \brief Forwarded lines without matching message */
+static uint64_t             sim_lastLineNs;         /**< \brief Time of the last forwarded line */
+static uint64_t             sim_lastRxNs;           /**< \brief Time the last byte reached uartRB */
+
+static uint8_t              sim_line[SIM_MAX_LENGTH];   /**< \brief Values of the line being forwarded */
+static uint16_t             sim_lineLen;
+static uint8_t              sim_inLine;
+
+static sim_stats_t          sim_stats;
+
+/*****************************************************************************/
+/* Wrapped comms API                                                         */
+/*****************************************************************************/
+
+RC_t __real_streamRB_write(StreamingRB_t *rb, uint8_t *byte);
+RC_t __real_streamRB_flush(StreamingRB_t *rb);
+RC_t __real_dynRB_send(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t consumer_id, EventMaskType ev, TaskType tsk);
+RC_t __real_dynRB_flush(DynPayloadRB_t *rb);
+
+RC_t __wrap_streamRB_write(StreamingRB_t *rb, uint8_t *byte)
+{
+    RC_t result = __real_streamRB_write(rb, byte);
+
+    sim_lastRxNs = HOST_SIM_now();
+    if (result != RC_SUCCESS)
+    {
+        sim_stats.rxDropped++;
+    }
+    if (rb->fillLevel > sim_stats.streamMax)
+    {
+        sim_stats.streamMax = rb->fillLevel;
+    }
+    return result;
+}
+
+RC_t __wrap_streamRB_flush(StreamingRB_t *rb)
+{
+    sim_stats.streamFlushes++;
+    return __real_streamRB_flush(rb);
+}
+
+RC_t __wrap_dynRB_send(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t consumer_id, EventMaskType ev, TaskType tsk)
+{
+    RC_t result = __real_dynRB_send(rb, data, len, consumer_id, ev, tsk);
+
+    sim_stats.dynSends++;
+    if (result != RC_SUCCESS)
+    {
+        sim_stats.dynFailed++;
+    }
+    if (rb->fillLevel > sim_stats.dynMax)
+    {
+        sim_stats.dynMax = rb->fillLevel;
+    }
+    return result;
+}
+
+RC_t __wrap_dynRB_flush(DynPayloadRB_t *rb)
+{
+    sim_stats.dynFlushes++;
+    return __real_dynRB_flush(rb);
+}
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Record an injected message.
+ */
+static void sim_rxHook(const uint8_t *msg, uint16_t len, uint64_t eomNs)
+{
+    if (sim_msgs == sim_msgCapacity)
+    {
+        sim_msgCapacity = (0 == sim_msgCapacity) ? 256 : 2 * sim_msgCapacity;
+        sim_msg = realloc(sim_msg, sim_msgCapacity * sizeof(sim_msg_t));
+        if (NULL == sim_msg)
+        {
+            abort();
+        }
+    }
+
+    sim_msg_t *m = &sim_msg[sim_msgs++];
+    m->len    = (len > SIM_MAX_LENGTH) ? SIM_MAX_LENGTH : len;
+    m->eomNs  = eomNs;
+    m->doneNs = 0;
+    m->missed = 0;
+    memcpy(m->data, msg, m->len);
+}
+
+/**
+ * Match a forwarded line with the oldest equal message, all messages before
+ * it can not arrive anymore.
+ */
+static void sim_match(uint64_t now)
+{
+    sim_received++;
+    sim_lastLineNs = now;
+
+    for (uint32_t i = sim_head; i < sim_msgs; i++)
+    {
+        sim_msg_t *m = &sim_msg[i];
+        if ((m->len == sim_lineLen) && (0 == memcmp(m->data, sim_line, sim_lineLen)))
+        {
+            m->doneNs = now;
+            for (uint32_t k = sim_head; k < i; k++)
+            {
+                sim_msg[k].missed = 1;
+            }
+            sim_head = i + 1;
+            return;
+        }
+    }
+    sim_unexpected++;
+}
+
+/**
+ * Observes the UART output of tsk_uart: "\r\nReceived: " v0 ", " v1 ... ".\n\r"
+ */
+static void sim_txHook(const char *string)
+{
+    if (0 == strcmp(string, "\r\nReceived: "))
+    {
+        sim_inLine  = 1;
+        sim_lineLen = 0;
+    }
+    else if (sim_inLine && (0 == strcmp(string, ".\n\r")))
+    {
+        sim_inLine = 0;
+        sim_match(HOST_SIM_now());
+    }
+    else if (sim_inLine && (string[0] >= '0') && (string[0] <= '9') && (sim_lineLen < SIM_MAX_LENGTH))
+    {
+        sim_line[sim_lineLen++] = (uint8_t)atoi(string);
+    }
+}
+
+/**
+ * Runs the application, StartOS does not return.
+ */
+static void *sim_appThread(void *arg)
+{
+    (void)arg;
+    app_main();
+    return NULL;
+}
+
+/**
+ * Tasks are set up once tsk_init has terminated and the consumers wait.
+ */
+static int sim_started(void)
+{
+    return (HOST_OS_getTaskState(tsk_init)   == HOST_TASK_SUSPENDED)
+        && (HOST_OS_getTaskState(tsk_sender) == HOST_TASK_WAITING)
+        && (HOST_OS_getTaskState(tsk_tft)    == HOST_TASK_WAITING)
+        && (HOST_OS_getTaskState(tsk_uart)   == HOST_TASK_WAITING);
+}
+
+static int sim_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Parse "name=value" of the cost model.
+ */
+static int sim_setCost(HOST_SIM_cost_t *cost, const char *arg)
+{
+    static const struct {
+        const char *name;
+        size_t      offset;
+    } fields[] = {
+        { "call",   offsetof(HOST_SIM_cost_t, callNs)     },
+        { "os",     offsetof(HOST_SIM_cost_t, osNs)       },
+        { "switch", offsetof(HOST_SIM_cost_t, switchNs)   },
+        { "isr",    offsetof(HOST_SIM_cost_t, isrNs)      },
+        { "spi",    offsetof(HOST_SIM_cost_t, spiByteNs)  },
+        { "uart",   offsetof(HOST_SIM_cost_t, uartCharNs) },
+    };
+    const char *eq = strchr(arg, '=');
+
+    for (size_t i = 0; (NULL != eq) && (i < sizeof(fields) / sizeof(fields[0])); i++)
+    {
+        if ((strlen(fields[i].name) == (size_t)(eq - arg)) && (0 == strncmp(arg, fields[i].name, (size_t)(eq - arg))))
+        {
+            *(uint32_t *)((uint8_t *)cost + fields[i].offset) = (uint32_t)strtoul(eq + 1, NULL, 0);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Parse "task=prio".
+ */
+static int sim_setPriority(const char *arg)
+{
+    static const char *names[EE_MAX_TASK] = {
+        [tsk_init]       = "init",
+        [tsk_background] = "background",
+        [tsk_sender]     = "sender",
+        [tsk_tft]        = "tft",
+        [tsk_uart]       = "uart",
+    };
+    const char *eq = strchr(arg, '=');
+
+    for (TaskType t = 0; (NULL != eq) && (t < EE_MAX_TASK); t++)
+    {
+        if ((strlen(names[t]) == (size_t)(eq - arg)) && (0 == strncmp(arg, names[t], (size_t)(eq - arg))))
+        {
+            return (E_OK == HOST_OS_setPriority(t, (uint8_t)strtoul(eq + 1, NULL, 0))) ? 0 : -1;
+        }
+    }
+    return -1;
+}
+
+static void sim_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-t trace | -n messages -l length -g gap] [-b baud] [-d drain]\n"
+            "          [-c name=ns]... [-p task=prio]... [-m] [-v]\n"
+            "  -t  replay a trace (script format, \"@<us>\" timestamps)\n"
+            "  -n  number of generated messages (default %u)\n"
+            "  -l  data bytes per generated message, 1..%u (default %u)\n"
+            "  -g  idle time between generated messages in us (default %u),\n"
+            "      0 sends a back to back burst, a stress case which overruns the buffers\n"
+            "  -b  UART baud rate for RX pacing and TX cost (default %u)\n"
+            "  -d  stop after this time in ms without forwarded lines (default %u)\n"
+            "  -c  cost in ns: call, os, switch, isr, spi (per byte), uart (per char)\n"
+            "  -p  priority: init, background, sender, tft, uart\n"
+            "  -m  list every message\n"
+            "  -v  echo the UART output of the application\n",
+            name, SIM_MESSAGES, SIM_MAX_LENGTH, SIM_LENGTH, SIM_GAP_US, SIM_BAUD, SIM_DRAIN_MS);
+}
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t    messages = SIM_MESSAGES;
+    uint32_t    length   = SIM_LENGTH;
+    uint32_t    gapUs    = SIM_GAP_US;
+    uint32_t    baud     = SIM_BAUD;
+    uint32_t    drainMs  = SIM_DRAIN_MS;
+    const char *trace    = NULL;
+    uint8_t     list     = 0;
+    int         opt;
+
+    /* UART transmit cost follows the baud rate unless given explicitly. */
+    HOST_SIM_cost_t cost = HOST_SIM_COST_DEFAULT;
+    cost.uartCharNs = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "t:n:l:g:b:d:c:p:mvh")))
+    {
+        switch (opt)
+        {
+            case 't': trace    = optarg;                              break;
+            case 'n': messages = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': length   = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'g': gapUs    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': baud     = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': drainMs  = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': list     = 1;                                   break;
+            case 'v': HOST_UART_setEcho(1);                           break;
+            case 'c':
+                if (0 != sim_setCost(&cost, optarg))
+                {
+                    sim_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'p':
+                if (0 != sim_setPriority(optarg))
+                {
+                    sim_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                sim_usage(argv[0]);
+                return 1;
+        }
+    }
+    if ((0 == length) || (length > SIM_MAX_LENGTH) || (0 == baud))
+    {
+        sim_usage(argv[0]);
+        return 1;
+    }
+    if (0 == cost.uartCharNs)
+    {
+        cost.uartCharNs = (uint32_t)((10ull * 1000000000u) / baud);
+    }
+
+    /* Start the application halted and run it until tsk_init has finished. */
+    HOST_SIM_enable(&cost);
+
+    pthread_t app;
+    pthread_create(&app, NULL, sim_appThread, NULL);
+    while (HOST_OS_getTaskState(tsk_init) == HOST_TASK_SUSPENDED)
+    {
+        usleep(100);
+    }
+
+    uint32_t step = 0;
+    while (!sim_started() && (step++ < SIM_START_STEPS))
+    {
+        HOST_SIM_run(SIM_STEP_NS);
+    }
+    if (!sim_started())
+    {
+        fprintf(stderr, "application did not start\n");
+        return 1;
+    }
+
+    HOST_UART_setTxHook(sim_txHook);
+    HOST_UART_setRxHook(sim_rxHook);
+    HOST_UART_setBaud(baud);
+
+    uint64_t tftBytes0 = HOST_TFT_getTxBytes();
+    uint32_t switches0 = HOST_OS_getContextSwitches();
+    uint32_t dispatch0[EE_MAX_TASK];
+    for (TaskType t = 0; t < EE_MAX_TASK; t++)
+    {
+        dispatch0[t] = HOST_OS_getDispatches(t);
+    }
+    CPULOAD_resetPeak();
+
+    /* Queue the whole input, the CPU is halted meanwhile. */
+    uint64_t start = HOST_SIM_now();
+
+    if (NULL != trace)
+    {
+        if (HOST_UART_injectScript(trace) < 0)
+        {
+            fprintf(stderr, "can not open %s\n", trace);
+            return 1;
+        }
+    }
+    else
+    {
+        uint8_t msg[SIM_MAX_LENGTH + 1];
+
+        for (uint32_t i = 0; i < messages; i++)
+        {
+            /* Values 1..250, the first two bytes make the message unique. */
+            msg[0] = (uint8_t)((i / 250) % 250 + 1);
+            for (uint32_t k = 1; k < length; k++)
+            {
+                msg[k] = (uint8_t)(((k == 1) ? i : (i + k)) % 250 + 1);
+            }
+            msg[length] = '\0';
+
+            sim_rxHook(msg, (uint16_t)length, HOST_UART_inject(msg, (uint16_t)(length + 1)));
+
+            HOST_UART_pause(gapUs);
+        }
+    }
+
+    /* Run until everything is forwarded or the consumers made no progress. */
+    uint64_t lastEom = (sim_msgs > 0) ? sim_msg[sim_msgs - 1].eomNs : start;
+    uint64_t now     = start;
+
+    while ((now < lastEom) || (sim_head < sim_msgs))
+    {
+        uint64_t idleFrom = (sim_lastLineNs > lastEom) ? sim_lastLineNs : lastEom;
+        if (sim_lastRxNs > idleFrom)
+        {
+            idleFrom = sim_lastRxNs;
+        }
+        if (now >= idleFrom + (uint64_t)drainMs * 1000000u)
+        {
+            break;
+        }
+        now = HOST_SIM_run(SIM_STEP_NS);
+    }
+
+    /* Report */
+    uint64_t *latency = calloc(sim_msgs + 1, sizeof(uint64_t));
+    uint32_t  matched = 0;
+    uint64_t  end     = start;
+
+    if (list)
+    {
+        printf("  #      eom [us]   latency [us]\n");
+    }
+    for (uint32_t i = 0; i < sim_msgs; i++)
+    {
+        sim_msg_t *m = &sim_msg[i];
+        if (m->doneNs != 0)
+        {
+            latency[matched++] = m->doneNs - m->eomNs;
+            if (m->doneNs > end)
+            {
+                end = m->doneNs;
+            }
+        }
+        if (list)
+        {
+            if (m->doneNs != 0)
+            {
+                printf("  %-6u %11.1f   %10.1f\n", i, (m->eomNs - start) / 1e3, (m->doneNs - m->eomNs) / 1e3);
+            }
+            else
+            {
+                printf("  %-6u %11.1f   %s\n", i, (m->eomNs - start) / 1e3, m->missed ? "missed" : "pending");
+            }
+        }
+    }
+
+    double   durationMs = (double)(end - start) / 1e6;
+    uint64_t tftBytes   = HOST_TFT_getTxBytes() - tftBytes0;
+    uint32_t switches   = HOST_OS_getContextSwitches() - switches0;
+
+    if (NULL != trace)
+    {
+        printf("sim_comms: %u messages from %s at %u baud\n", sim_msgs, trace, baud);
+    }
+    else
+    {
+        printf("sim_comms: %u messages x %u bytes at %u baud, gap %u us\n", sim_msgs, length, baud, gapUs);
+    }
+    printf("  cost [ns]      call %u  os %u  switch %u  isr %u  spi %u/byte  uart %u/char\n",
+           cost.callNs, cost.osNs, cost.switchNs, cost.isrNs, cost.spiByteNs, cost.uartCharNs);
+    printf("  priorities     sender %u  tft %u  uart %u  background %u\n",
+           HOST_OS_getPriority(tsk_sender), HOST_OS_getPriority(tsk_tft),
+           HOST_OS_getPriority(tsk_uart), HOST_OS_getPriority(tsk_background));
+    printf("  received       %u / %u (%u missed, %u unexpected lines)\n",
+           matched, sim_msgs, sim_msgs - matched, sim_unexpected);
+    printf("  duration       %.3f ms virtual (last EOM at %.3f ms)\n", durationMs, (double)(lastEom - start) / 1e6);
+
+    if (matched > 0)
+    {
+        uint64_t sum = 0;
+        qsort(latency, matched, sizeof(uint64_t), sim_cmp);
+        for (uint32_t i = 0; i < matched; i++)
+        {
+            sum += latency[i];
+        }
+        printf("  latency [us]   min %.1f  avg %.1f  p50 %.1f  p99 %.1f  max %.1f\n",
+               latency[0] / 1e3,
+               (double)sum / matched / 1e3,
+               latency[matched / 2] / 1e3,
+               latency[(matched * 99u) / 100u] / 1e3,
+               latency[matched - 1] / 1e3);
+    }
+
+    printf("  UART RX        %u bytes lost by FIFO overrun\n", HOST_UART_getOverruns());
+    printf("  uartRB         max %u / %u bytes, %u bytes dropped, %u resyncs\n",
+           sim_stats.streamMax, RB_SIZE, sim_stats.rxDropped, sim_stats.streamFlushes);
+    printf("  sharedRB       max %u / %u slots, %u sends, %u rejected, %u flushes\n",
+           sim_stats.dynMax, DYN_SLOTS, sim_stats.dynSends, sim_stats.dynFailed, sim_stats.dynFlushes);
+    printf("  ctx switches   %u (%.2f per message)\n", switches, sim_msgs ? (double)switches / sim_msgs : 0.0);
+    printf("  dispatches     sender %u  tft %u  uart %u\n",
+           HOST_OS_getDispatches(tsk_sender) - dispatch0[tsk_sender],
+           HOST_OS_getDispatches(tsk_tft)    - dispatch0[tsk_tft],
+           HOST_OS_getDispatches(tsk_uart)   - dispatch0[tsk_uart]);
+    printf("  TFT SPI bytes  %llu (%.0f per message)\n",
+           (unsigned long long)tftBytes, sim_msgs ? (double)tftBytes / sim_msgs : 0.0);
+    printf("  TFT stream     %llu ST7735 errors, %u waits for room in the ringbuffer\n",
+           (unsigned long long)HOST_TFT_getStreamErrors(), TFT_getTxWaitCount());
+    printf("  CPU load peak  %u%%\n", CPULOAD_getPeak());
+
+    fflush(stdout);
+    _exit(((matched == sim_msgs) && (0 == HOST_TFT_getStreamErrors())) ? 0 : 2);
+}
+
+/* [sim_comms.c] END OF FILE */
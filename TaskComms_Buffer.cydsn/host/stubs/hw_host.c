@@ -0,0 +1,1184 @@
+/**
+* \file hw_host.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Host stubs of the PSoC components (UART_LOG, TFT pins/SPI/PWM, CyLib)
+*
+* In virtual time the blocking accesses (CyDelay, UART transmit, SPI write
+* to a full TX FIFO) charge their duration to the virtual CPU and received
+* bytes are queued as isr_uartRX events instead of being raised immediately.
+* The TX FIFO of TFT_SPI drains with the bit rate, its status bits raise the
+* interrupt registered with isr_tftTx_StartEx, or the ISR2 isr_tftTx of the
+* application if none was registered. The DMA channel of TFT_TxDma
+* executes its TD chain into the TX FIFO without charging the CPU and
+* raises the nrq as isr_tftDma, the ISR2 of the application.
+*
+* Every byte on the TFT SPI passes the ST7735 command stream checker, which
+* decodes it like the controller: known command, number of parameters and
+* pixel data of a RAMWR filling the window of CASET/RASET exactly. The
+* decoder also emulates the panel: RAMWR pixels are written through the
+* address counter and MADCTL into the frame memory, which can be read back
+* and saved as PPM image, and every command type is counted. The vertical
+* scrolling of SCRLAR/VSCSAD is applied when the panel is read back.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ee_host.h"
+#include "hw_host.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define HW_EOM_MARKER           '\0'        /**< \brief Appended to every scripted message */
+#define HW_SCRIPT_LINE_L        1024        /**< \brief Maximum length of one script line */
+#define HW_UART_RX_FIFO         4           /**< \brief Hardware RX FIFO of the UART block */
+#define HW_REG_NS               HOST_CYCLES_NS(4)   /**< \brief Access of a peripheral register */
+#define HW_DMA_TDS              128         /**< \brief TDs of the DMA controller */
+#define HW_DMA_NS               HOST_CYCLES_NS(6)   /**< \brief Request to byte written by the DMA */
+#define HW_DMA_API_NS           HOST_CYCLES_NS(30)  /**< \brief CyDmac call, a few register writes */
+#define HW_SPI_ISR              ((NULL != hw_spiIsr) ? hw_spiIsr : isr_tftTx)  /**< \brief Handler of the TX interrupt */
+#define HW_ST7735_SHOWN         5           /**< \brief Violations of the command stream printed to stderr */
+#define HW_ST7735_RAMWR         0x2C        /**< \brief Memory write, followed by pixel data */
+#define HW_ST7735_CASET         0x2A        /**< \brief Column address set */
+#define HW_ST7735_RASET         0x2B        /**< \brief Row address set */
+#define HW_ST7735_SWRESET       0x01        /**< \brief Software reset */
+#define HW_ST7735_INVOFF        0x20        /**< \brief Display inversion off */
+#define HW_ST7735_INVON         0x21        /**< \brief Display inversion on */
+#define HW_ST7735_MADCTL        0x36        /**< \brief Memory data access control */
+#define HW_ST7735_NORON         0x13        /**< \brief Normal display mode, ends the vertical scrolling */
+#define HW_ST7735_SCRLAR        0x33        /**< \brief Scroll area definition */
+#define HW_ST7735_VSCSAD        0x37        /**< \brief Vertical scroll start address, starts the vertical scrolling */
+#define HW_ST7735_LINES         162         /**< \brief Lines of the frame memory, SCRLAR has to cover all of them */
+#define HW_MADCTL_MY            0x80        /**< \brief Row address order */
+#define HW_MADCTL_MX            0x40        /**< \brief Column address order */
+#define HW_MADCTL_MV            0x20        /**< \brief Row/column exchange */
+#define HW_MADCTL_BGR           0x08        /**< \brief BGR order of the pixel data */
+#define HW_PANEL_BGR            HW_MADCTL_BGR   /**< \brief The panel is wired BGR, the board sets BGR in MADCTL (TFT_rot_180) */
+
+/**
+ * \brief Byte queued for reception in virtual time
+ */
+typedef struct {
+    uint64_t    atNs;                       /**< \brief Stop bit received */
+    uint8_t     byte;                       /**< \brief Received value */
+} hw_rxByte_t;
+
+/**
+ * \brief Transfer descriptor
+ */
+typedef struct {
+    uint16_t    count;                      /**< \brief Bytes */
+    uint16_t    src;                        /**< \brief Lower 16 bit of the source address */
+    uint8_t     next;                       /**< \brief Next TD, >= HW_DMA_TDS ends the chain */
+    uint8_t     cfg;                        /**< \brief TD_* flags */
+    uint8_t     used;                       /**< \brief Allocated */
+} hw_dmaTd_t;
+
+/**
+ * \brief Parameters of an ST7735 command
+ */
+typedef struct {
+    uint8_t     cmd;
+    uint8_t     minArgs;
+    uint8_t     maxArgs;
+} hw_st7735Cmd_t;
+
+/**
+ * \brief Decoder of the ST7735 command stream checker
+ */
+typedef struct {
+    const hw_st7735Cmd_t *cmd;              /**< \brief Command being received, NULL = none or unknown */
+    uint32_t    args;                       /**< \brief Parameter bytes of the command */
+    uint8_t     win[2][4];                  /**< \brief Last parameters of CASET and RASET */
+    uint32_t    area;                       /**< \brief Pixels of the window of the running RAMWR */
+    uint8_t     started;                    /**< \brief A command was received */
+    uint64_t    bytes;                      /**< \brief Position in the stream */
+    uint64_t    errors;
+    uint8_t     madctl;                     /**< \brief Parameter of the last MADCTL */
+    uint8_t     inverted;                   /**< \brief INVON is active */
+    uint8_t     scroll[8];                  /**< \brief Last parameters of SCRLAR and VSCSAD */
+    uint8_t     scrolling;                  /**< \brief VSCSAD was received, NORON not yet */
+    uint16_t    col, row;                   /**< \brief Address counter of the running RAMWR */
+    uint8_t     pixHi;                      /**< \brief First byte of the pixel being received */
+    HOST_TFT_stats_t stats;
+    uint16_t    gram[HOST_TFT_GRAM_H][HOST_TFT_GRAM_W];    /**< \brief Frame memory, RGB565 in panel order */
+} hw_st7735_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+/** \brief Commands of the ST7735S, the controller takes a shorter gamma table */
+static const hw_st7735Cmd_t hw_st7735Cmds[] = {
+    { 0x00, 0, 0 },     /* NOP */
+    { 0x01, 0, 0 },     /* SWRESET */
+    { 0x10, 0, 0 },     /* SLPIN */
+    { 0x11, 0, 0 },     /* SLPOUT */
+    { 0x12, 0, 0 },     /* PTLON */
+    { 0x13, 0, 0 },     /* NORON */
+    { 0x20, 0, 0 },     /* INVOFF */
+    { 0x21, 0, 0 },     /* INVON */
+    { 0x26, 1, 1 },     /* GAMSET */
+    { 0x28, 0, 0 },     /* DISPOFF */
+    { 0x29, 0, 0 },     /* DISPON */
+    { 0x2A, 4, 4 },     /* CASET */
+    { 0x2B, 4, 4 },     /* RASET */
+    { 0x2C, 0, 0 },     /* RAMWR, pixel data checked against the window */
+    { 0x30, 4, 4 },     /* PTLAR */
+    { 0x33, 6, 6 },     /* SCRLAR */
+    { 0x34, 0, 0 },     /* TEOFF */
+    { 0x35, 1, 1 },     /* TEON */
+    { 0x36, 1, 1 },     /* MADCTL */
+    { 0x37, 2, 2 },     /* VSCSAD */
+    { 0x38, 0, 0 },     /* IDMOFF */
+    { 0x39, 0, 0 },     /* IDMON */
+    { 0x3A, 1, 1 },     /* COLMOD */
+    { 0xB1, 3, 3 },     /* FRMCTR1 */
+    { 0xB2, 3, 3 },     /* FRMCTR2 */
+    { 0xB3, 6, 6 },     /* FRMCTR3 */
+    { 0xB4, 1, 1 },     /* INVCTR */
+    { 0xC0, 3, 3 },     /* PWCTR1 */
+    { 0xC1, 1, 1 },     /* PWCTR2 */
+    { 0xC2, 2, 2 },     /* PWCTR3 */
+    { 0xC3, 2, 2 },     /* PWCTR4 */
+    { 0xC4, 2, 2 },     /* PWCTR5 */
+    { 0xC5, 1, 1 },     /* VMCTR1 */
+    { 0xC7, 1, 1 },     /* VMOFCTR */
+    { 0xE0, 1, 16 },    /* GMCTRP1 */
+    { 0xE1, 1, 16 },    /* GMCTRN1 */
+    { 0xFC, 2, 2 },     /* PWCTR6 */
+};
+
+
+extern void isr_uartRX(void);
+extern void isr_tftDma(void) __attribute__((weak));    /**< \brief Only defined with CFG_TFT_DMA */
+extern void isr_tftTx(void) __attribute__((weak));     /**< \brief Only defined with CFG_TFT_TX_BLOCKING */
+
+static volatile uint8_t     hw_uartRxByte;          /**< \brief Byte presented to isr_uartRX */
+static uint8_t              hw_uartEcho;
+static HOST_UART_txHook_t   hw_uartTxHook;
+static HOST_UART_rxHook_t   hw_uartRxHook;
+static uint64_t             hw_uartByteNs;          /**< \brief Duration of one byte on the wire, 0 = unpaced */
+static uint64_t             hw_uartNextNs;          /**< \brief Earliest time of the next injected byte */
+static hw_rxByte_t         *hw_uartRxQueue;         /**< \brief Bytes queued in virtual time, index = event argument */
+static uint32_t             hw_uartRxQueued;
+static uint32_t             hw_uartRxCapacity;
+static uint64_t             hw_uartReadNs[HW_UART_RX_FIFO];  /**< \brief Read times of the last bytes taken from the FIFO */
+static uint32_t             hw_uartReads;
+static uint32_t             hw_uartOverruns;
+
+static uint8_t              hw_tftDc;               /**< \brief Level of the DC pin */
+static uint64_t             hw_tftTxBytes;
+static uint64_t             hw_tftCmdBytes;
+static uint64_t             hw_tftDcGlitches;
+static uint64_t             hw_spiBusyNs;           /**< \brief Last written byte is shifted out (virtual time) */
+static uint64_t             hw_spiDoneNs;           /**< \brief hw_spiBusyNs when SPI_DONE was last read */
+static uint8_t              hw_spiIntSrc;           /**< \brief TX interrupt mask */
+static uint32_t             hw_spiIntGen;           /**< \brief Invalidates queued TX interrupts */
+static void               (*hw_spiIsr)(void);
+static uint8_t              hw_tftBacklight;
+static hw_dmaTd_t           hw_dmaTd[HW_DMA_TDS];
+static uint16_t             hw_dmaSrcHi;            /**< \brief Upper 16 bit of the source addresses */
+static uint8_t              hw_dmaFirstTd;
+static uint8_t              hw_dmaEnabled;          /**< \brief Channel enabled, chain not executed yet */
+static uint8_t              hw_dmaBusy;             /**< \brief Chain executed, end of the chain pending */
+static uint64_t             hw_dmaBytes;
+static hw_st7735_t          hw_st7735;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * Sleep until the given monotonic time.
+ */
+static void hw_sleepUntil(uint64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/**
+ * Received byte event of the virtual time mode. The byte is lost if the
+ * FIFO was still full of unread bytes when its stop bit arrived.
+ */
+static void hw_uartRxEvent(uint32_t index)
+{
+    const hw_rxByte_t *rx      = &hw_uartRxQueue[index];
+    uint32_t           unread  = 0;
+
+    for (uint32_t k = 0; (k < HW_UART_RX_FIFO) && (k < hw_uartReads); k++)
+    {
+        if (hw_uartReadNs[k] > rx->atNs)
+        {
+            unread++;
+        }
+    }
+    if (unread >= HW_UART_RX_FIFO)
+    {
+        hw_uartOverruns++;
+        return;
+    }
+
+    hw_uartReadNs[hw_uartReads++ % HW_UART_RX_FIFO] = HOST_SIM_now();
+    hw_uartRxByte = rx->byte;
+    isr_uartRX();
+}
+
+/**
+ * Line is idle until the given time, e.g. for "delay" and "@" in scripts.
+ */
+static void hw_uartIdleUntil(uint64_t ns)
+{
+    if (!HOST_SIM_isActive())
+    {
+        hw_sleepUntil(ns);
+        ns = HOST_getTimeNs();
+    }
+    if (hw_uartNextNs < ns)
+    {
+        hw_uartNextNs = ns;
+    }
+}
+
+/**
+ * Bytes in the TX FIFO and the shifter.
+ */
+static uint32_t hw_spiPending(void)
+{
+    uint64_t now    = HOST_SIM_now();
+    uint64_t byteNs = HOST_SIM_getCost()->spiByteNs;
+
+    if (!HOST_SIM_isActive() || (hw_spiBusyNs <= now))
+    {
+        return 0;
+    }
+    return (uint32_t)((hw_spiBusyNs - now + byteNs - 1) / byteNs);
+}
+
+/**
+ * TX status register without the clear on read.
+ */
+static uint8_t hw_spiStatus(void)
+{
+    uint32_t pending = hw_spiPending();
+    uint8_t  sts     = 0;
+
+    if (pending <= 1)
+    {
+        sts |= TFT_SPI_STS_TX_FIFO_EMPTY;
+    }
+    if (pending <= TFT_SPI_FIFO_SIZE)
+    {
+        sts |= TFT_SPI_STS_TX_FIFO_NOT_FULL;
+    }
+    if (0 == pending)
+    {
+        sts |= TFT_SPI_STS_SPI_IDLE;
+        if (hw_spiDoneNs != hw_spiBusyNs)
+        {
+            sts |= TFT_SPI_STS_SPI_DONE;
+        }
+    }
+    return sts;
+}
+
+/**
+ * Report a violation of the ST7735 command stream.
+ */
+static void hw_st7735Error(const char *fmt, unsigned a, unsigned b)
+{
+    if (hw_st7735.errors++ < HW_ST7735_SHOWN)
+    {
+        fprintf(stderr, "ST7735 stream, byte %llu: ", (unsigned long long)hw_st7735.bytes);
+        fprintf(stderr, fmt, a, b);
+        fputc('\n', stderr);
+    }
+}
+
+/**
+ * Power on or reset state of the controller: full window, default MADCTL.
+ * The frame memory keeps its content.
+ */
+static void hw_st7735Reset(void)
+{
+    static const uint8_t full[2][4] = { { 0, 0, 0, HOST_TFT_GRAM_W - 1 }, { 0, 0, 0, HOST_TFT_GRAM_H - 1 } };
+    static const uint8_t area[8]    = { 0, 0, HW_ST7735_LINES >> 8, HW_ST7735_LINES & 0xFF, 0, 0, 0, 0 };
+
+    memcpy(hw_st7735.win, full, sizeof(full));
+    memcpy(hw_st7735.scroll, area, sizeof(area));
+    hw_st7735.madctl    = 0;
+    hw_st7735.inverted  = 0;
+    hw_st7735.scrolling = 0;
+}
+
+/**
+ * Parameter of SCRLAR (top fixed, scroll and bottom fixed area) or VSCSAD
+ * (scroll start address) as 16 bit value.
+ */
+static uint16_t hw_st7735Scroll(uint8_t i)
+{
+    return (uint16_t)((hw_st7735.scroll[2 * i] << 8) | hw_st7735.scroll[2 * i + 1]);
+}
+
+/**
+ * Store a received pixel at the address counter and advance the counter
+ * through the window, MADCTL maps the address onto the frame memory and
+ * selects the color order.
+ */
+static void hw_st7735Pixel(uint16_t px)
+{
+    const uint8_t *x = hw_st7735.win[0];
+    const uint8_t *y = hw_st7735.win[1];
+    uint16_t c = hw_st7735.col;
+    uint16_t r = hw_st7735.row;
+
+    if (0 != (hw_st7735.madctl & HW_MADCTL_MV))
+    {
+        uint16_t t = c;
+        c = r;
+        r = t;
+    }
+    if (0 != (hw_st7735.madctl & HW_MADCTL_MX))
+    {
+        c = HOST_TFT_GRAM_W - 1 - c;
+    }
+    if (0 != (hw_st7735.madctl & HW_MADCTL_MY))
+    {
+        r = HOST_TFT_GRAM_H - 1 - r;
+    }
+    if ((hw_st7735.madctl & HW_MADCTL_BGR) != HW_PANEL_BGR)
+    {
+        px = (uint16_t)(((px & 0x1Fu) << 11) | (px & 0x07E0u) | (px >> 11));
+    }
+    /* addresses beyond the panel wrap around in the controller, not modelled */
+    if ((c < HOST_TFT_GRAM_W) && (r < HOST_TFT_GRAM_H))
+    {
+        hw_st7735.gram[r][c] = px;
+    }
+    hw_st7735.stats.pixels++;
+
+    if (hw_st7735.col++ >= ((x[2] << 8) | x[3]))
+    {
+        hw_st7735.col = (uint16_t)((x[0] << 8) | x[1]);
+        if (hw_st7735.row++ >= ((y[2] << 8) | y[3]))
+        {
+            hw_st7735.row = (uint16_t)((y[0] << 8) | y[1]);
+        }
+    }
+}
+
+/**
+ * Check the completed command before the next one starts.
+ */
+static void hw_st7735End(void)
+{
+    const hw_st7735Cmd_t *c = hw_st7735.cmd;
+
+    if (NULL == c)
+    {
+        return;
+    }
+    if (HW_ST7735_RAMWR == c->cmd)
+    {
+        if (hw_st7735.args != 2u * hw_st7735.area)
+        {
+            hw_st7735Error("RAMWR of %u bytes into a window of %u pixels", hw_st7735.args, hw_st7735.area);
+        }
+    }
+    else if (hw_st7735.args < c->minArgs)
+    {
+        hw_st7735Error("command 0x%02X with %u parameters", c->cmd, hw_st7735.args);
+    }
+}
+
+/**
+ * Decode one byte of the TFT SPI like the controller.
+ */
+static void hw_st7735Byte(uint8_t dc, uint8_t byte)
+{
+    const hw_st7735Cmd_t *c = hw_st7735.cmd;
+
+    hw_st7735.bytes++;
+    if (0 == dc)
+    {
+        hw_st7735End();
+        hw_st7735.cmd     = NULL;
+        hw_st7735.args    = 0;
+        hw_st7735.started = 1;
+        for (size_t k = 0; k < sizeof(hw_st7735Cmds) / sizeof(hw_st7735Cmds[0]); k++)
+        {
+            if (hw_st7735Cmds[k].cmd == byte)
+            {
+                hw_st7735.cmd = &hw_st7735Cmds[k];
+            }
+        }
+        if (NULL == hw_st7735.cmd)
+        {
+            hw_st7735Error("unknown command 0x%02X", byte, 0);
+        }
+        else if (HW_ST7735_RAMWR == byte)
+        {
+            const uint8_t *x = hw_st7735.win[0];
+            const uint8_t *y = hw_st7735.win[1];
+            int32_t w = ((x[2] << 8) | x[3]) - ((x[0] << 8) | x[1]) + 1;
+            int32_t h = ((y[2] << 8) | y[3]) - ((y[0] << 8) | y[1]) + 1;
+
+            hw_st7735.area = ((w > 0) && (h > 0)) ? (uint32_t)(w * h) : 0;
+            hw_st7735.col  = (uint16_t)((x[0] << 8) | x[1]);
+            hw_st7735.row  = (uint16_t)((y[0] << 8) | y[1]);
+            hw_st7735.stats.ramwr++;
+        }
+        else if (HW_ST7735_CASET == byte)
+        {
+            hw_st7735.stats.caset++;
+        }
+        else if (HW_ST7735_RASET == byte)
+        {
+            hw_st7735.stats.raset++;
+        }
+        else if (HW_ST7735_SWRESET == byte)
+        {
+            hw_st7735Reset();
+        }
+        else if ((HW_ST7735_INVON == byte) || (HW_ST7735_INVOFF == byte))
+        {
+            hw_st7735.inverted = (HW_ST7735_INVON == byte);
+        }
+        else if (HW_ST7735_NORON == byte)
+        {
+            hw_st7735.scrolling = 0;
+        }
+        return;
+    }
+
+    if (NULL == c)
+    {
+        /* parameters of an unknown command were reported with it */
+        if (!hw_st7735.started && (0 == hw_st7735.args++))
+        {
+            hw_st7735Error("data 0x%02X before the first command", byte, 0);
+        }
+        return;
+    }
+    if ((HW_ST7735_CASET == c->cmd) || (HW_ST7735_RASET == c->cmd))
+    {
+        if (hw_st7735.args < 4)
+        {
+            hw_st7735.win[c->cmd - HW_ST7735_CASET][hw_st7735.args] = byte;
+        }
+    }
+    else if (HW_ST7735_RAMWR == c->cmd)
+    {
+        if (0 == (hw_st7735.args & 1u))
+        {
+            hw_st7735.pixHi = byte;
+        }
+        else
+        {
+            hw_st7735Pixel((uint16_t)((hw_st7735.pixHi << 8) | byte));
+        }
+    }
+    else if ((HW_ST7735_MADCTL == c->cmd) && (0 == hw_st7735.args))
+    {
+        hw_st7735.madctl = byte;
+    }
+    else if ((HW_ST7735_SCRLAR == c->cmd) && (hw_st7735.args < 6))
+    {
+        hw_st7735.scroll[hw_st7735.args] = byte;
+        if ((5 == hw_st7735.args)
+            && (HW_ST7735_LINES != hw_st7735Scroll(0) + hw_st7735Scroll(1) + hw_st7735Scroll(2)))
+        {
+            hw_st7735Error("SCRLAR areas of %u lines instead of %u",
+                           hw_st7735Scroll(0) + hw_st7735Scroll(1) + hw_st7735Scroll(2), HW_ST7735_LINES);
+        }
+    }
+    else if ((HW_ST7735_VSCSAD == c->cmd) && (hw_st7735.args < 2))
+    {
+        hw_st7735.scroll[6 + hw_st7735.args] = byte;
+        if (1 == hw_st7735.args)
+        {
+            uint16_t ssa = hw_st7735Scroll(3);
+
+            hw_st7735.scrolling = 1;
+            if ((ssa < hw_st7735Scroll(0)) || (ssa >= hw_st7735Scroll(0) + hw_st7735Scroll(1)))
+            {
+                hw_st7735Error("VSCSAD %u outside the scroll area from line %u", ssa, hw_st7735Scroll(0));
+            }
+        }
+    }
+    hw_st7735.args++;
+    if ((HW_ST7735_RAMWR != c->cmd) && (hw_st7735.args == (uint32_t)c->maxArgs + 1))
+    {
+        hw_st7735Error("command 0x%02X with more than %u parameters", c->cmd, c->maxArgs);
+    }
+}
+
+/**
+ * Byte enters the TX FIFO at the given time, no earlier than now.
+ */
+static void hw_spiPush(uint8_t byte, uint64_t atNs)
+{
+    hw_st7735Byte(hw_tftDc, byte);
+    if (HOST_SIM_isActive())
+    {
+        hw_spiBusyNs = ((hw_spiBusyNs > atNs) ? hw_spiBusyNs : atNs) + HOST_SIM_getCost()->spiByteNs;
+    }
+    hw_tftTxBytes++;
+    if (0 == hw_tftDc)
+    {
+        hw_tftCmdBytes++;
+    }
+}
+
+static void hw_spiArm(void);
+
+/**
+ * TX interrupt event, stale once the mask was written again. Bytes written
+ * after the mask may have delayed the status bit.
+ */
+static void hw_spiTxEvent(uint32_t gen)
+{
+    if (gen != hw_spiIntGen)
+    {
+        return;
+    }
+    if (0 != (hw_spiStatus() & hw_spiIntSrc))
+    {
+        HW_SPI_ISR();
+    }
+    else
+    {
+        hw_spiArm();
+    }
+}
+
+/**
+ * Queue the TX interrupt for the time the first unmasked status bit is set.
+ * Written bytes do not re-arm, the driver writes the mask after its bytes.
+ */
+static void hw_spiArm(void)
+{
+    hw_spiIntGen++;
+    if (!HOST_SIM_isActive() || (0 == hw_spiIntSrc) || (NULL == HW_SPI_ISR))
+    {
+        return;
+    }
+
+    uint64_t byteNs = HOST_SIM_getCost()->spiByteNs;
+    uint64_t at     = UINT64_MAX;
+
+    if ((hw_spiIntSrc & TFT_SPI_STS_TX_FIFO_EMPTY) && (hw_spiBusyNs - byteNs < at))
+    {
+        at = (hw_spiBusyNs > byteNs) ? hw_spiBusyNs - byteNs : 0;
+    }
+    if ((hw_spiIntSrc & TFT_SPI_STS_TX_FIFO_NOT_FULL) && (hw_spiBusyNs - TFT_SPI_FIFO_SIZE * byteNs < at))
+    {
+        at = (hw_spiBusyNs > TFT_SPI_FIFO_SIZE * byteNs) ? hw_spiBusyNs - TFT_SPI_FIFO_SIZE * byteNs : 0;
+    }
+    if ((hw_spiIntSrc & TFT_SPI_STS_SPI_IDLE)
+        || ((hw_spiIntSrc & TFT_SPI_STS_SPI_DONE) && (hw_spiDoneNs != hw_spiBusyNs)))
+    {
+        at = (hw_spiBusyNs < at) ? hw_spiBusyNs : at;
+    }
+    if (UINT64_MAX != at)
+    {
+        HOST_SIM_schedule((at > HOST_SIM_now()) ? at : HOST_SIM_now(), hw_spiTxEvent, hw_spiIntGen);
+    }
+}
+
+/**
+ * End of the DMA chain, raises the nrq if a TD had TERMOUT set.
+ */
+static void hw_dmaDoneEvent(uint32_t nrq)
+{
+    hw_dmaBusy = 0;
+    if ((0 != nrq) && (NULL != isr_tftDma))
+    {
+        isr_tftDma();
+    }
+}
+
+/**
+ * Source address of a TD on the host, resolved within the 4 GiB of the image.
+ */
+static const uint8_t *hw_dmaSource(uint16_t lo)
+{
+    uintptr_t image = (uintptr_t)&hw_dmaTd & ~(uintptr_t)0xFFFFFFFFu;
+    return (const uint8_t *)(image | ((uintptr_t)hw_dmaSrcHi << 16) | lo);
+}
+
+/**
+ * Execute the chain of the enabled channel once the TX request is unmasked.
+ * Every byte is written when the FIFO has room, the CPU is not charged.
+ */
+static void hw_dmaRun(void)
+{
+    if (!hw_dmaEnabled || (0 == (hw_spiIntSrc & TFT_SPI_STS_TX_FIFO_NOT_FULL)))
+    {
+        return;
+    }
+    hw_dmaEnabled = 0;
+    hw_dmaBusy    = 1;
+
+    uint64_t byteNs = HOST_SIM_getCost()->spiByteNs;
+    uint64_t at     = HOST_SIM_now();
+    uint32_t nrq    = 0;
+
+    for (uint32_t td = hw_dmaFirstTd; td < HW_DMA_TDS; td = hw_dmaTd[td].next)
+    {
+        const hw_dmaTd_t *t   = &hw_dmaTd[td];
+        const uint8_t    *src = hw_dmaSource(t->src);
+
+        for (uint16_t i = 0; i < t->count; i++)
+        {
+            if (HOST_SIM_isActive())
+            {
+                /* The request is pending while the FIFO has room. */
+                if (hw_spiBusyNs > at + TFT_SPI_FIFO_SIZE * byteNs)
+                {
+                    at = hw_spiBusyNs - TFT_SPI_FIFO_SIZE * byteNs;
+                }
+                at += HW_DMA_NS;
+            }
+            hw_spiPush(*src, at);
+            hw_dmaBytes++;
+            if (0 != (t->cfg & TD_INC_SRC_ADR))
+            {
+                src++;
+            }
+        }
+        nrq |= t->cfg & TFT_TxDma__TD_TERMOUT_EN;
+    }
+
+    if (HOST_SIM_isActive())
+    {
+        HOST_SIM_schedule(at, hw_dmaDoneEvent, nrq);
+    }
+    else
+    {
+        hw_dmaDoneEvent(nrq);
+    }
+}
+
+/*****************************************************************************/
+/* CyLib                                                                     */
+/*****************************************************************************/
+
+void CyDelay(uint32_t milliseconds)
+{
+    if (HOST_SIM_isActive())
+    {
+        HOST_SIM_charge((uint64_t)milliseconds * 1000000u);
+        return;
+    }
+    hw_sleepUntil(HOST_getTimeNs() + (uint64_t)milliseconds * 1000000u);
+}
+
+void CyDelayUs(uint16_t microseconds)
+{
+    if (HOST_SIM_isActive())
+    {
+        HOST_SIM_charge((uint64_t)microseconds * 1000u);
+        return;
+    }
+    hw_sleepUntil(HOST_getTimeNs() + (uint64_t)microseconds * 1000u);
+}
+
+uint8_t CyEnterCriticalSection(void)
+{
+    return HOST_SIM_maskIsr(1);
+}
+
+void CyExitCriticalSection(uint8_t savedIntrStatus)
+{
+    (void)HOST_SIM_maskIsr(savedIntrStatus);
+}
+
+/*****************************************************************************/
+/* UART_LOG / isr_uartRX                                                     */
+/*****************************************************************************/
+
+void UART_LOG_Start(void)
+{
+}
+
+void UART_LOG_PutString(const char *string)
+{
+    HOST_SIM_charge((uint64_t)strlen(string) * HOST_SIM_getCost()->uartCharNs);
+    if (hw_uartEcho)
+    {
+        fputs(string, stdout);
+    }
+    if (hw_uartTxHook != NULL)
+    {
+        hw_uartTxHook(string);
+    }
+}
+
+void UART_LOG_PutChar(uint8_t txDataByte)
+{
+    char str[2] = { (char)txDataByte, '\0' };
+    UART_LOG_PutString(str);
+}
+
+uint8_t UART_LOG_GetByte(void)
+{
+    return hw_uartRxByte;
+}
+
+void isr_uartRX_ClearPending(void)
+{
+}
+
+/*****************************************************************************/
+/* TFT SPI, pins and backlight                                               */
+/*****************************************************************************/
+
+void TFT_SPI_Start(void)
+{
+}
+
+void TFT_SPI_WriteTxData(uint8_t txData)
+{
+    if (HOST_SIM_isActive())
+    {
+        uint64_t byteNs = HOST_SIM_getCost()->spiByteNs;
+
+        /* Blocks until the FIFO has room, the shifter holds one more byte. */
+        HOST_SIM_charge(HW_REG_NS);
+        if (hw_spiBusyNs > HOST_SIM_now() + TFT_SPI_FIFO_SIZE * byteNs)
+        {
+            HOST_SIM_charge(hw_spiBusyNs - TFT_SPI_FIFO_SIZE * byteNs - HOST_SIM_now());
+        }
+    }
+    hw_spiPush(txData, HOST_SIM_now());
+}
+
+uint8_t TFT_SPI_ReadTxStatus(void)
+{
+    HOST_SIM_charge(HW_REG_NS);
+
+    uint8_t sts = hw_spiStatus();
+    if (0 != (sts & TFT_SPI_STS_SPI_DONE))
+    {
+        hw_spiDoneNs = hw_spiBusyNs;
+    }
+    return sts;
+}
+
+void TFT_SPI_SetTxInterruptMode(uint8_t intSrc)
+{
+    hw_spiIntSrc = intSrc;
+    hw_spiArm();
+    hw_dmaRun();
+}
+
+void isr_tftTx_StartEx(void (*address)(void))
+{
+    hw_spiIsr = address;
+}
+
+void TFT_DC_Write(uint8_t value)
+{
+    if ((value != hw_tftDc) && (0 != hw_spiPending()))
+    {
+        hw_tftDcGlitches++;
+    }
+    hw_tftDc = value;
+}
+
+void TFT_RES_Write(uint8_t value)
+{
+    if (0 == value)
+    {
+        hw_st7735Reset();
+    }
+}
+
+void TFT_BackLight_Start(void)
+{
+}
+
+void TFT_BackLight_WriteCompare(uint8_t compare)
+{
+    hw_tftBacklight = compare;
+}
+
+uint8_t TFT_BackLight_ReadCompare(void)
+{
+    return hw_tftBacklight;
+}
+
+/*****************************************************************************/
+/* CyDmac, TFT_TxDma / isr_tftDma                                            */
+/*****************************************************************************/
+
+uint8_t TFT_TxDma_DmaInitialize(uint8_t burstCount, uint8_t requestPerBurst, uint16_t upperSrcAddress,
+                                uint16_t upperDestAddress)
+{
+    (void)burstCount;
+    (void)requestPerBurst;
+    (void)upperDestAddress;
+    hw_dmaSrcHi = upperSrcAddress;
+    return 0;
+}
+
+uint8_t CyDmaTdAllocate(void)
+{
+    for (uint8_t td = 0; td < HW_DMA_TDS; td++)
+    {
+        if (!hw_dmaTd[td].used)
+        {
+            hw_dmaTd[td] = (hw_dmaTd_t){ .used = 1, .next = CY_DMA_DISABLE_TD };
+            return td;
+        }
+    }
+    return DMA_INVALID_TD;
+}
+
+void CyDmaTdFree(uint8_t tdHandle)
+{
+    if (tdHandle < HW_DMA_TDS)
+    {
+        hw_dmaTd[tdHandle].used = 0;
+    }
+}
+
+uint8_t CyDmaTdSetConfiguration(uint8_t tdHandle, uint16_t transferCount, uint8_t nextTd, uint8_t configuration)
+{
+    HOST_SIM_charge(HW_DMA_API_NS);
+    if ((tdHandle >= HW_DMA_TDS) || (transferCount > 0x0FFFu))
+    {
+        return CYRET_BAD_PARAM;
+    }
+    hw_dmaTd[tdHandle].count = transferCount;
+    hw_dmaTd[tdHandle].next  = nextTd;
+    hw_dmaTd[tdHandle].cfg   = configuration;
+    return CYRET_SUCCESS;
+}
+
+uint8_t CyDmaTdSetAddress(uint8_t tdHandle, uint16_t source, uint16_t destination)
+{
+    (void)destination;
+    HOST_SIM_charge(HW_DMA_API_NS);
+    if (tdHandle >= HW_DMA_TDS)
+    {
+        return CYRET_BAD_PARAM;
+    }
+    hw_dmaTd[tdHandle].src = source;
+    return CYRET_SUCCESS;
+}
+
+uint8_t CyDmaChSetExtendedAddress(uint8_t chHandle, uint16_t source, uint16_t destination)
+{
+    (void)chHandle;
+    (void)destination;
+    HOST_SIM_charge(HW_DMA_API_NS);
+    hw_dmaSrcHi = source;
+    return CYRET_SUCCESS;
+}
+
+uint8_t CyDmaChSetInitialTd(uint8_t chHandle, uint8_t startTd)
+{
+    (void)chHandle;
+    HOST_SIM_charge(HW_DMA_API_NS);
+    hw_dmaFirstTd = startTd;
+    return CYRET_SUCCESS;
+}
+
+uint8_t CyDmaChEnable(uint8_t chHandle, uint8_t preserveTds)
+{
+    (void)chHandle;
+    (void)preserveTds;
+    HOST_SIM_charge(HW_DMA_API_NS);
+    hw_dmaEnabled = 1;
+    hw_dmaRun();
+    return CYRET_SUCCESS;
+}
+
+uint8_t CyDmaChDisable(uint8_t chHandle)
+{
+    (void)chHandle;
+    HOST_SIM_charge(HW_DMA_API_NS);
+    hw_dmaEnabled = 0;
+    return CYRET_SUCCESS;
+}
+
+/*****************************************************************************/
+/* Host API                                                                  */
+/*****************************************************************************/
+
+uint64_t HOST_getTimeNs(void)
+{
+    if (HOST_SIM_isActive())
+    {
+        return HOST_SIM_now();
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t HOST_getCycles(void)
+{
+    return (uint32_t)HOST_getTimeNs();
+}
+
+void HOST_UART_setEcho(uint8_t on)
+{
+    hw_uartEcho = on;
+}
+
+void HOST_UART_setTxHook(HOST_UART_txHook_t hook)
+{
+    hw_uartTxHook = hook;
+}
+
+void HOST_UART_setRxHook(HOST_UART_rxHook_t hook)
+{
+    hw_uartRxHook = hook;
+}
+
+void HOST_UART_setBaud(uint32_t baud)
+{
+    /* 8N1: start bit, 8 data bits, stop bit */
+    hw_uartByteNs = (0 == baud) ? 0 : (10u * 1000000000ull) / baud;
+    hw_uartNextNs = HOST_getTimeNs();
+}
+
+uint64_t HOST_UART_inject(const uint8_t *data, uint16_t len)
+{
+    if (HOST_SIM_isActive())
+    {
+        /* The byte is complete after its stop bit. */
+        hw_uartIdleUntil(HOST_SIM_now());
+        for (uint16_t i = 0; i < len; i++)
+        {
+            if (hw_uartRxQueued == hw_uartRxCapacity)
+            {
+                hw_uartRxCapacity = (0 == hw_uartRxCapacity) ? 1024 : 2 * hw_uartRxCapacity;
+                hw_uartRxQueue    = realloc(hw_uartRxQueue, hw_uartRxCapacity * sizeof(hw_rxByte_t));
+                if (NULL == hw_uartRxQueue)
+                {
+                    abort();
+                }
+            }
+            hw_uartNextNs += hw_uartByteNs;
+            hw_uartRxQueue[hw_uartRxQueued] = (hw_rxByte_t){ hw_uartNextNs, data[i] };
+            HOST_SIM_schedule(hw_uartNextNs, hw_uartRxEvent, hw_uartRxQueued++);
+        }
+        return hw_uartNextNs;
+    }
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (hw_uartByteNs > 0)
+        {
+            uint64_t now = HOST_getTimeNs();
+            if (hw_uartNextNs > now)
+            {
+                hw_sleepUntil(hw_uartNextNs);
+            }
+            else
+            {
+                /* Line was idle, the next byte starts now. */
+                hw_uartNextNs = now;
+            }
+            hw_uartNextNs += hw_uartByteNs;
+        }
+
+        hw_uartRxByte = data[i];
+        HOST_OS_raiseIsr(isr_uartRX);
+    }
+    return HOST_getTimeNs();
+}
+
+void HOST_UART_pause(uint32_t microseconds)
+{
+    uint64_t now = HOST_getTimeNs();
+    hw_uartIdleUntil(((hw_uartNextNs > now) ? hw_uartNextNs : now) + (uint64_t)microseconds * 1000u);
+}
+
+int32_t HOST_UART_injectScript(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (NULL == f)
+    {
+        return -1;
+    }
+
+    char     line[HW_SCRIPT_LINE_L];
+    uint8_t  msg[HW_SCRIPT_LINE_L / 2 + 1];
+    int32_t  messages = 0;
+    uint64_t start    = HOST_getTimeNs();
+
+    while (NULL != fgets(line, sizeof(line), f))
+    {
+        char *p = line;
+        uint16_t len = 0;
+
+        while (isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if (('\0' == *p) || ('#' == *p))
+        {
+            continue;
+        }
+        if (0 == strncmp(p, "delay", 5))
+        {
+            HOST_UART_pause((uint32_t)strtoul(p + 5, NULL, 10) * 1000u);
+            continue;
+        }
+        if ('@' == *p)
+        {
+            /* Captured trace: the message starts at the given time (us) */
+            hw_uartIdleUntil(start + strtoull(p + 1, &p, 10) * 1000u);
+        }
+
+        while (('\0' != *p) && (len < sizeof(msg) - 1))
+        {
+            char *end;
+            unsigned long value = strtoul(p, &end, 10);
+            if (end == p)
+            {
+                p++;                    /* separator */
+                continue;
+            }
+            msg[len++] = (uint8_t)value;
+            p = end;
+        }
+        msg[len++] = HW_EOM_MARKER;
+
+        uint64_t eomNs = HOST_UART_inject(msg, len);
+        if (hw_uartRxHook != NULL)
+        {
+            hw_uartRxHook(msg, (uint16_t)(len - 1), eomNs);
+        }
+        messages++;
+    }
+
+    fclose(f);
+    return messages;
+}
+
+uint32_t HOST_UART_getOverruns(void)
+{
+    return hw_uartOverruns;
+}
+
+uint64_t HOST_TFT_getTxBytes(void)
+{
+    return hw_tftTxBytes;
+}
+
+uint64_t HOST_TFT_getCmdBytes(void)
+{
+    return hw_tftCmdBytes;
+}
+
+uint64_t HOST_TFT_getDcGlitches(void)
+{
+    return hw_tftDcGlitches;
+}
+
+uint8_t HOST_TFT_isTxIdle(void)
+{
+    return ((0 == hw_spiIntSrc) || (NULL == HW_SPI_ISR)) && (0 == hw_spiPending())
+        && !hw_dmaEnabled && !hw_dmaBusy;
+}
+
+uint64_t HOST_TFT_getDmaBytes(void)
+{
+    return hw_dmaBytes;
+}
+
+uint64_t HOST_TFT_getStreamErrors(void)
+{
+    return hw_st7735.errors;
+}
+
+void HOST_TFT_getStats(HOST_TFT_stats_t *stats)
+{
+    *stats           = hw_st7735.stats;
+    stats->txBytes   = hw_tftTxBytes;
+    stats->cmdBytes  = hw_tftCmdBytes;
+    stats->dataBytes = hw_tftTxBytes - hw_tftCmdBytes;
+}
+
+uint16_t HOST_TFT_getPixel(uint16_t x, uint16_t y)
+{
+    uint16_t px;
+
+    if ((x >= HOST_TFT_GRAM_W) || (y >= HOST_TFT_GRAM_H))
+    {
+        return 0;
+    }
+    if (hw_st7735.scrolling)
+    {
+        /* lines of the scroll area are shown from the scroll start address on, wrapping around */
+        uint16_t tfa = hw_st7735Scroll(0);
+        uint16_t vsa = hw_st7735Scroll(1);
+        uint16_t ssa = hw_st7735Scroll(3);
+
+        if ((y >= tfa) && (y < tfa + vsa) && (ssa >= tfa))
+        {
+            y = (uint16_t)(tfa + (y - tfa + ssa - tfa) % vsa);
+        }
+        if (y >= HOST_TFT_GRAM_H)
+        {
+            return 0;           /* frame memory lines the panel has no pixels for */
+        }
+    }
+    px = hw_st7735.gram[y][x];
+    return hw_st7735.inverted ? (uint16_t)~px : px;
+}
+
+int32_t HOST_TFT_writePpm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (NULL == f)
+    {
+        return -1;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", HOST_TFT_GRAM_W, HOST_TFT_GRAM_H);
+    for (uint16_t y = 0; y < HOST_TFT_GRAM_H; y++)
+    {
+        for (uint16_t x = 0; x < HOST_TFT_GRAM_W; x++)
+        {
+            uint16_t px = HOST_TFT_getPixel(x, y);
+            uint8_t  r  = (uint8_t)((px >> 11) & 0x1Fu);
+            uint8_t  g  = (uint8_t)((px >> 5) & 0x3Fu);
+            uint8_t  b  = (uint8_t)(px & 0x1Fu);
+
+            fputc((r << 3) | (r >> 2), f);
+            fputc((g << 2) | (g >> 4), f);
+            fputc((b << 3) | (b >> 2), f);
+        }
+    }
+    return (0 == fclose(f)) ? 0 : -1;
+}
+
+/* [hw_host.c] END OF FILE */
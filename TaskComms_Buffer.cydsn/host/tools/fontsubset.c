@@ -0,0 +1,455 @@
+/**
+* \file fontsubset.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief Writes a subset of a GFXfont as font header
+*
+* Keeps the glyphs of a character list and drops the bitmaps of all others.
+* The glyph table of a GFXfont has to cover first..last without gaps, so
+* characters in between which are not in the list stay in the table with
+* an empty bitmap and their advance (7 bytes each). The list must contain
+* ' ', the blank of text fields.
+*
+* With -r the bitmaps are written run length coded (#TFT_FONT_RLE), which
+* TFT_drawChar decodes straight into runs instead of testing bit by bit.
+* Each coded glyph is decoded again and compared with the original before
+* it is written. The sizes of both forms are reported on stderr, small
+* fonts do not always get smaller by the coding.
+*
+*   fontsubset [-r] [-n name] font characters > name.h
+*   fontsubset -l                       lists the fonts
+*
+* The header is written to stdout in the format of the Adafruit fonts.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "project.h"
+#include "tft.h"
+#include "FreeMono12pt7b.h"
+#include "FreeMono18pt7b.h"
+#include "FreeMono24pt7b.h"
+#include "FreeMono9pt7b.h"
+#include "FreeMonoBold12pt7b.h"
+#include "FreeMonoBold18pt7b.h"
+#include "FreeMonoBold24pt7b.h"
+#include "FreeMonoBold9pt7b.h"
+#include "FreeMonoBoldOblique12pt7b.h"
+#include "FreeMonoBoldOblique18pt7b.h"
+#include "FreeMonoBoldOblique24pt7b.h"
+#include "FreeMonoBoldOblique9pt7b.h"
+#include "FreeMonoOblique12pt7b.h"
+#include "FreeMonoOblique18pt7b.h"
+#include "FreeMonoOblique24pt7b.h"
+#include "FreeMonoOblique9pt7b.h"
+#include "FreeSans12pt7b.h"
+#include "FreeSans18pt7b.h"
+#include "FreeSans24pt7b.h"
+#include "FreeSans9pt7b.h"
+#include "FreeSansBold12pt7b.h"
+#include "FreeSansBold18pt7b.h"
+#include "FreeSansBold24pt7b.h"
+#include "FreeSansBold9pt7b.h"
+#include "FreeSansBoldOblique12pt7b.h"
+#include "FreeSansBoldOblique18pt7b.h"
+#include "FreeSansBoldOblique24pt7b.h"
+#include "FreeSansBoldOblique9pt7b.h"
+#include "FreeSansOblique12pt7b.h"
+#include "FreeSansOblique18pt7b.h"
+#include "FreeSansOblique24pt7b.h"
+#include "FreeSansOblique9pt7b.h"
+#include "FreeSerif12pt7b.h"
+#include "FreeSerif18pt7b.h"
+#include "FreeSerif24pt7b.h"
+#include "FreeSerif9pt7b.h"
+#include "FreeSerifBold12pt7b.h"
+#include "FreeSerifBold18pt7b.h"
+#include "FreeSerifBold24pt7b.h"
+#include "FreeSerifBold9pt7b.h"
+#include "FreeSerifBoldItalic12pt7b.h"
+#include "FreeSerifBoldItalic18pt7b.h"
+#include "FreeSerifBoldItalic24pt7b.h"
+#include "FreeSerifBoldItalic9pt7b.h"
+#include "FreeSerifItalic12pt7b.h"
+#include "FreeSerifItalic18pt7b.h"
+#include "FreeSerifItalic24pt7b.h"
+#include "FreeSerifItalic9pt7b.h"
+#include "Org_01.h"
+#include "Picopixel.h"
+#include "Tiny3x3a2pt7b.h"
+#include "TomThumb.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#define FONTSUBSET_BITMAP_MAX   65536       /**< \brief Bitmap bytes of a font, bitmapOffset is 16 bit */
+#define FONTSUBSET_PER_LINE     12          /**< \brief Bitmap bytes per line of the header */
+#define FONTSUBSET_FONT(f)      { #f, &f }
+
+/**
+ * \brief One font of the tool
+ */
+typedef struct {
+    const char    *name;
+    const GFXfont *font;
+} fontsubset_font_t;
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+static const fontsubset_font_t fontsubset_fonts[] = {
+    FONTSUBSET_FONT(FreeMono12pt7b),
+    FONTSUBSET_FONT(FreeMono18pt7b),
+    FONTSUBSET_FONT(FreeMono24pt7b),
+    FONTSUBSET_FONT(FreeMono9pt7b),
+    FONTSUBSET_FONT(FreeMonoBold12pt7b),
+    FONTSUBSET_FONT(FreeMonoBold18pt7b),
+    FONTSUBSET_FONT(FreeMonoBold24pt7b),
+    FONTSUBSET_FONT(FreeMonoBold9pt7b),
+    FONTSUBSET_FONT(FreeMonoBoldOblique12pt7b),
+    FONTSUBSET_FONT(FreeMonoBoldOblique18pt7b),
+    FONTSUBSET_FONT(FreeMonoBoldOblique24pt7b),
+    FONTSUBSET_FONT(FreeMonoBoldOblique9pt7b),
+    FONTSUBSET_FONT(FreeMonoOblique12pt7b),
+    FONTSUBSET_FONT(FreeMonoOblique18pt7b),
+    FONTSUBSET_FONT(FreeMonoOblique24pt7b),
+    FONTSUBSET_FONT(FreeMonoOblique9pt7b),
+    FONTSUBSET_FONT(FreeSans12pt7b),
+    FONTSUBSET_FONT(FreeSans18pt7b),
+    FONTSUBSET_FONT(FreeSans24pt7b),
+    FONTSUBSET_FONT(FreeSans9pt7b),
+    FONTSUBSET_FONT(FreeSansBold12pt7b),
+    FONTSUBSET_FONT(FreeSansBold18pt7b),
+    FONTSUBSET_FONT(FreeSansBold24pt7b),
+    FONTSUBSET_FONT(FreeSansBold9pt7b),
+    FONTSUBSET_FONT(FreeSansBoldOblique12pt7b),
+    FONTSUBSET_FONT(FreeSansBoldOblique18pt7b),
+    FONTSUBSET_FONT(FreeSansBoldOblique24pt7b),
+    FONTSUBSET_FONT(FreeSansBoldOblique9pt7b),
+    FONTSUBSET_FONT(FreeSansOblique12pt7b),
+    FONTSUBSET_FONT(FreeSansOblique18pt7b),
+    FONTSUBSET_FONT(FreeSansOblique24pt7b),
+    FONTSUBSET_FONT(FreeSansOblique9pt7b),
+    FONTSUBSET_FONT(FreeSerif12pt7b),
+    FONTSUBSET_FONT(FreeSerif18pt7b),
+    FONTSUBSET_FONT(FreeSerif24pt7b),
+    FONTSUBSET_FONT(FreeSerif9pt7b),
+    FONTSUBSET_FONT(FreeSerifBold12pt7b),
+    FONTSUBSET_FONT(FreeSerifBold18pt7b),
+    FONTSUBSET_FONT(FreeSerifBold24pt7b),
+    FONTSUBSET_FONT(FreeSerifBold9pt7b),
+    FONTSUBSET_FONT(FreeSerifBoldItalic12pt7b),
+    FONTSUBSET_FONT(FreeSerifBoldItalic18pt7b),
+    FONTSUBSET_FONT(FreeSerifBoldItalic24pt7b),
+    FONTSUBSET_FONT(FreeSerifBoldItalic9pt7b),
+    FONTSUBSET_FONT(FreeSerifItalic12pt7b),
+    FONTSUBSET_FONT(FreeSerifItalic18pt7b),
+    FONTSUBSET_FONT(FreeSerifItalic24pt7b),
+    FONTSUBSET_FONT(FreeSerifItalic9pt7b),
+    FONTSUBSET_FONT(Org_01),
+    FONTSUBSET_FONT(Picopixel),
+    FONTSUBSET_FONT(Tiny3x3a2pt7b),
+    FONTSUBSET_FONT(TomThumb),
+};
+
+static uint8_t  fontsubset_bitmap[FONTSUBSET_BITMAP_MAX];  /**< \brief Bitmaps of the subset */
+static uint32_t fontsubset_size;                           /**< \brief Used bytes of fontsubset_bitmap */
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+/**
+ * \brief Pixel of a plain glyph bitmap
+ */
+static int fontsubset_bit(const uint8_t *bitmap, uint32_t bit)
+{
+    return (bitmap[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/**
+ * \brief Append one byte to the subset bitmaps
+ * \return 0, -1 if the bitmaps exceed the 16 bit offsets
+ */
+static int fontsubset_put(uint8_t byte)
+{
+    if (fontsubset_size >= FONTSUBSET_BITMAP_MAX)
+    {
+        return -1;
+    }
+    fontsubset_bitmap[fontsubset_size++] = byte;
+    return 0;
+}
+
+/**
+ * \brief Append a glyph run length coded, see #TFT_FONT_RLE
+ *
+ * Runs longer than 15 pixels continue in the next pair with an empty
+ * run of the other kind. Clear pixels at the end are replaced by the
+ * end marker, which is left out if the last pair ends on the last pixel.
+ *
+ * \return 0, -1 if the bitmaps exceed the 16 bit offsets
+ */
+static int fontsubset_putRle(const uint8_t *bitmap, uint32_t n)
+{
+    uint32_t pos = 0;
+    int      rc  = 0;
+
+    while (pos < n)
+    {
+        uint32_t clear = 0, set = 0;
+
+        while ((pos + clear < n) && !fontsubset_bit(bitmap, pos + clear))
+        {
+            clear++;
+        }
+        if (pos + clear == n)
+        {
+            return fontsubset_put(0);
+        }
+        while ((pos + clear + set < n) && fontsubset_bit(bitmap, pos + clear + set))
+        {
+            set++;
+        }
+        pos += clear + set;
+
+        for (; clear > 15; clear -= 15)
+        {
+            rc |= fontsubset_put(0xF0);
+        }
+        for (; set > 15; set -= 15)
+        {
+            rc |= fontsubset_put((uint8_t)((clear << 4) | 15));
+            clear = 0;
+        }
+        rc |= fontsubset_put((uint8_t)((clear << 4) | set));
+    }
+    return rc;
+}
+
+/**
+ * \brief Decode a run length coded glyph like TFT_drawChar and compare it
+ * \return 0 if it equals the plain bitmap
+ */
+static int fontsubset_checkRle(const uint8_t *rle, const uint8_t *bitmap, uint32_t n)
+{
+    uint32_t pos = 0;
+    uint8_t  pair;
+
+    while ((pos < n) && (0 != (pair = *rle++)))
+    {
+        for (uint32_t i = 0; i < (uint32_t)(pair >> 4); i++, pos++)
+        {
+            if ((pos >= n) || fontsubset_bit(bitmap, pos))
+            {
+                return -1;
+            }
+        }
+        for (uint32_t i = 0; i < (uint32_t)(pair & 0x0F); i++, pos++)
+        {
+            if ((pos >= n) || !fontsubset_bit(bitmap, pos))
+            {
+                return -1;
+            }
+        }
+    }
+    for (; pos < n; pos++)
+    {
+        if (fontsubset_bit(bitmap, pos))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief Find a font by name
+ */
+static const GFXfont *fontsubset_find(const char *name)
+{
+    for (size_t k = 0; k < sizeof(fontsubset_fonts) / sizeof(fontsubset_fonts[0]); k++)
+    {
+        if (0 == strcmp(fontsubset_fonts[k].name, name))
+        {
+            return fontsubset_fonts[k].font;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Bytes of the plain bitmap of a glyph
+ */
+static uint32_t fontsubset_glyphBytes(const GFXglyph *g)
+{
+    return ((uint32_t)g->width * g->height + 7) / 8;
+}
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    const char    *name = NULL;
+    const GFXfont *font;
+    int            rle = 0;
+    int            opt;
+    uint8_t        keep[256] = { 0 };
+    uint8_t        first = 0xFF, last = 0;
+    GFXglyph       glyphs[256];
+    uint32_t       plain = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "rn:lh")))
+    {
+        switch (opt)
+        {
+            case 'r': rle = 1; break;
+            case 'n': name = optarg; break;
+            case 'l':
+                for (size_t k = 0; k < sizeof(fontsubset_fonts) / sizeof(fontsubset_fonts[0]); k++)
+                {
+                    printf("%s\n", fontsubset_fonts[k].name);
+                }
+                return 0;
+            default:
+                fprintf(stderr, "usage: %s [-r] [-n name] font characters\n       %s -l\n", argv[0], argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 2)
+    {
+        fprintf(stderr, "usage: %s [-r] [-n name] font characters\n       %s -l\n", argv[0], argv[0]);
+        return 1;
+    }
+    if (NULL == (font = fontsubset_find(argv[optind])))
+    {
+        fprintf(stderr, "fontsubset: unknown font %s, see -l\n", argv[optind]);
+        return 1;
+    }
+    if (NULL == name)
+    {
+        name = argv[optind];
+    }
+
+    for (const unsigned char *c = (const unsigned char *)argv[optind + 1]; *c; c++)
+    {
+        if ((*c < font->first) || (*c > font->last))
+        {
+            fprintf(stderr, "fontsubset: '%c' (0x%02X) is not in %s\n", *c, *c, argv[optind]);
+            return 1;
+        }
+        keep[*c] = 1;
+        if (*c < first) first = *c;
+        if (*c > last)  last  = *c;
+    }
+    if (first > last)
+    {
+        fprintf(stderr, "fontsubset: no characters\n");
+        return 1;
+    }
+    if (!keep[' '])
+    {
+        fprintf(stderr, "fontsubset: the characters must include ' ', TFT_field_set pads with it\n");
+        return 1;
+    }
+
+    for (unsigned c = first; c <= last; c++)
+    {
+        const GFXglyph *g = &font->glyph[c - font->first];
+        const uint8_t  *bitmap = &font->bitmap[g->bitmapOffset];
+
+        glyphs[c] = *g;
+        glyphs[c].bitmapOffset = (uint16_t)fontsubset_size;
+        if (!keep[c])
+        {
+            glyphs[c].width = glyphs[c].height = 0;
+            glyphs[c].xOffset = glyphs[c].yOffset = 0;
+            continue;
+        }
+        plain += fontsubset_glyphBytes(g);
+        if (rle)
+        {
+            if ((0 != fontsubset_putRle(bitmap, (uint32_t)g->width * g->height)) ||
+                (0 != fontsubset_checkRle(&fontsubset_bitmap[glyphs[c].bitmapOffset], bitmap, (uint32_t)g->width * g->height)))
+            {
+                fprintf(stderr, "fontsubset: coding of '%c' failed\n", c);
+                return 1;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < fontsubset_glyphBytes(g); i++)
+            {
+                if (0 != fontsubset_put(bitmap[i]))
+                {
+                    fprintf(stderr, "fontsubset: bitmaps too large\n");
+                    return 1;
+                }
+            }
+        }
+    }
+
+    /* Header in the layout of the Adafruit fonts */
+    printf("// %s subset \"%s\"%s\n", argv[optind], argv[optind + 1], rle ? ", run length coded (TFT_FONT_RLE)" : "");
+    printf("// Generated by host/tools/fontsubset, do not edit\n\n");
+    printf("const uint8_t %sBitmaps[] PROGMEM = {", name);
+    for (uint32_t i = 0; i < fontsubset_size; i++)
+    {
+        printf("%s0x%02X%s", (0 == i % FONTSUBSET_PER_LINE) ? "\n  " : " ",
+               fontsubset_bitmap[i], (i + 1 < fontsubset_size) ? "," : "");
+    }
+    if (0 == fontsubset_size)
+    {
+        printf("\n  0x00");     /* no empty arrays in C */
+    }
+    printf(" };\n\n");
+
+    printf("const GFXglyph %sGlyphs[] PROGMEM = {\n", name);
+    for (unsigned c = first; c <= last; c++)
+    {
+        const GFXglyph *g = &glyphs[c];
+        printf("  { %5u, %3u, %3u, %3u, %4d, %4d }%s // 0x%02X '%c'%s\n",
+               g->bitmapOffset, g->width, g->height, g->xAdvance, g->xOffset, g->yOffset,
+               (c < last) ? ",  " : " };", c, c, keep[c] ? "" : " (not in subset)");
+    }
+
+    printf("\nconst GFXfont %s PROGMEM = {\n", name);
+    printf("  (uint8_t  *)%sBitmaps,\n", name);
+    printf("  (GFXglyph *)%sGlyphs,\n", name);
+    printf("  0x%02X, 0x%02X, %u%s };\n\n", first, last, font->yAdvance, rle ? ", TFT_FONT_RLE" : "");
+    printf("// Approx. %u bytes\n", (unsigned)(fontsubset_size + (last - first + 1) * 7 + 7));
+
+    {
+        uint32_t full = 0;
+        for (unsigned c = font->first; c <= font->last; c++)
+        {
+            full += fontsubset_glyphBytes(&font->glyph[c - font->first]);
+        }
+        fprintf(stderr, "fontsubset: %s %u of %u glyphs, bitmaps %u bytes (subset plain %u, %s %u), approx. %u -> %u bytes\n",
+                argv[optind], (unsigned)(last - first + 1), (unsigned)(font->last - font->first + 1),
+                (unsigned)full, (unsigned)plain, rle ? "coded" : "written", (unsigned)fontsubset_size,
+                (unsigned)(full + (font->last - font->first + 1) * 7 + 7),
+                (unsigned)(fontsubset_size + (last - first + 1) * 7 + 7));
+    }
+    return 0;
+}
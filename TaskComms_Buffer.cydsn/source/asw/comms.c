@@ -30,6 +30,7 @@
 RC_t streamRB_init(StreamingRB_t *rb) 
 {
     rb->readIdx = rb->writeIdx = rb->fillLevel = 0;
+    rb->msgWritten = rb->msgRead = 0;
     return RC_SUCCESS;
 }
 
@@ -46,6 +47,9 @@ RC_t streamRB_write(StreamingRB_t *rb, uint8_t *byte)
         rb->buffer[rb->writeIdx++] = *byte;
         rb->writeIdx %= RB_SIZE;
         rb->fillLevel++;
+        if (*byte == EOM_MARKER) {
+            rb->msgWritten++;      // One more complete message
+        }
         return RC_SUCCESS;
     }
     return RC_ERROR_BUFFER_FULL;
@@ -56,12 +60,16 @@ RC_t streamRB_write(StreamingRB_t *rb, uint8_t *byte)
  * 
  * A message is defined as a contiguous sequence of bytes ending with the
  * EOM_MARKER. The function copies bytes into the provided buffer until
- * the marker is found or an error occurs.
+ * the marker is found or an error occurs. Nothing is consumed as long as
+ * no complete message is buffered, so a frame which is still being
+ * received is not torn apart.
  * 
  * @param rb      Pointer to streaming ring buffer instance (IN/OUT).
  * @param msg     Destination buffer for the assembled message (OUT).
  * @param msg_len Pointer to variable that receives the message length (OUT).
  * @return RC_SUCCESS on complete message, RC_ERROR_WRITE_FAILS if too long,
+ *         RC_ERROR_BUFFER_EMTPY if no complete message is buffered,
+ *         RC_ERROR_BUFFER_FULL if the buffer is full without any EOM,
  *         RC_ERROR_READ_FAILS if EOM not found.
  */
 RC_t streamRB_read_message(StreamingRB_t *rb, uint8_t *msg, uint16_t *msg_len) 
@@ -71,15 +79,25 @@ RC_t streamRB_read_message(StreamingRB_t *rb, uint8_t *msg, uint16_t *msg_len)
     /* Protect buffer access on task level with a resource. */
     GetResource(res_stream);  // Protect task access
     
+    /* Writer and reader count on their own, the difference is pending messages. */
+    if (rb->msgWritten == rb->msgRead) {
+        RC_t rc = (rb->fillLevel >= RB_SIZE) ? RC_ERROR_BUFFER_FULL : RC_ERROR_BUFFER_EMTPY;
+        ReleaseResource(res_stream);
+        return rc;
+    }
+    
     /* Extract one complete message terminated with EOM_MARKER. */
     while (rb->fillLevel > 0) 
     {
         uint8_t byte;
-        streamRB_read_byte(rb, &byte);
+        if (streamRB_read_byte(rb, &byte) != RC_SUCCESS) {
+            break;                      // Emptied meanwhile - treated as no EOM
+        }
         
         msg[(*msg_len)++] = byte;
         
         if (byte == EOM_MARKER) {  // End of message found
+            rb->msgRead++;
             ReleaseResource(res_stream);
             return RC_SUCCESS;
         }
@@ -126,6 +144,7 @@ RC_t streamRB_flush(StreamingRB_t *rb)
     GetResource(res_stream);
     rb->readIdx = rb->writeIdx;   // Reader catches writer = empty
     rb->fillLevel = 0;            // Force empty
+    rb->msgRead = rb->msgWritten; // No pending messages
     ReleaseResource(res_stream);
     return RC_SUCCESS;
 }
@@ -139,6 +158,9 @@ RC_t streamRB_flush(StreamingRB_t *rb)
 RC_t dynRB_init(DynPayloadRB_t *rb) 
 {
     rb->readIdx_tft = rb->readIdx_uart = rb->writeIdx = rb->fillLevel = 0;
+    for (uint16_t i = 0; i < DYN_SLOTS; i++) {
+        rb->slots[i].msg_id = NONE_ID;   // All slots free
+    }
     return RC_SUCCESS;
 }
 
@@ -146,7 +168,8 @@ RC_t dynRB_init(DynPayloadRB_t *rb)
  * Enqueue a payload into the dynamic payload ring buffer.
  * 
  * Stores the given data together with metadata identifying the consumer,
- * event and target task, then triggers the corresponding event.
+ * event and target task, then triggers the corresponding event. The slot at
+ * the write index must have been released by its previous consumer.
  * 
  * @param rb      Pointer to dynamic payload ring buffer instance (IN/OUT).
  * @param data    Pointer to data buffer to be enqueued (IN).
@@ -158,34 +181,85 @@ RC_t dynRB_init(DynPayloadRB_t *rb)
  */
 RC_t dynRB_send(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t msg_id, EventMaskType ev, char tsk) 
 {
-    if (len > DYN_MAX_SIZE || rb->fillLevel >= DYN_SLOTS) 
+    if (len > DYN_MAX_SIZE) 
     {
         return RC_ERROR;
     }
     
     GetResource(res_dyn);
     dyn_payload_t *slot = &rb->slots[rb->writeIdx];
+    
+    /* Oldest slot not yet consumed - ring is full for this producer. */
+    if (slot->msg_id != NONE_ID) {
+        ReleaseResource(res_dyn);
+        return RC_ERROR;
+    }
+    
     memcpy(slot->payload, data, len);
     slot->payload_len = len;
     slot->msg_id = msg_id;
     slot->event = ev;
     slot->task = tsk;
     
-    rb->writeIdx = rb->writeIdx % DYN_SLOTS;
+    rb->writeIdx = (rb->writeIdx + 1) % DYN_SLOTS;
     rb->fillLevel++;
     ReleaseResource(res_dyn);
     
+#if (CFG_COMMS_TIME_TRIGGERED == OFF)
     /* Notify the destination task that a new payload is available. */
-    SetEvent(slot->task, slot->event);
+    SetEvent(tsk, ev);
+#endif
     
     return RC_SUCCESS;
 }
 
+/**
+ * Enqueue a payload which supersedes the pending payloads of its consumer.
+ * 
+ * Scans backwards from the write index for the newest slot still addressed
+ * to the consumer and overwrites its payload. The consumer has not fetched
+ * that slot yet, so it is still notified. Without such a slot the payload
+ * is enqueued by dynRB_send().
+ * 
+ * @param rb      Pointer to dynamic payload ring buffer instance (IN/OUT).
+ * @param data    Pointer to data buffer to be enqueued (IN).
+ * @param len     Length of the payload in bytes (IN).
+ * @param msg_id  Identifier of target consumer (e.g. TFT_ID, UART_ID) (IN).
+ * @param ev      Event mask to be set for the target task (IN).
+ * @param tsk     Task identifier that should receive the event (IN).
+ * @return RC_SUCCESS if replaced or enqueued, RC_ERROR if buffer is full or size exceeds limit.
+ */
+RC_t dynRB_replace(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t msg_id, EventMaskType ev, char tsk) 
+{
+    if (len > DYN_MAX_SIZE) 
+    {
+        return RC_ERROR;
+    }
+    
+    GetResource(res_dyn);
+    for (uint16_t n = 1; (n <= DYN_SLOTS) && (rb->fillLevel > 0); n++) 
+    {
+        dyn_payload_t *slot = &rb->slots[(rb->writeIdx + DYN_SLOTS - n) % DYN_SLOTS];
+        
+        if (slot->msg_id == msg_id) {
+            memcpy(slot->payload, data, len);   // Newest pending payload of the consumer
+            slot->payload_len = len;
+            ReleaseResource(res_dyn);
+            return RC_SUCCESS;
+        }
+    }
+    ReleaseResource(res_dyn);
+    
+    return dynRB_send(rb, data, len, msg_id, ev, tsk);
+}
+
 /**
  * Receive a payload from the dynamic payload ring buffer.
  * 
- * Selects the appropriate read index based on consumer ID, copies the
- * payload into the destination buffer and updates read indices and fill level.
+ * Scans from the consumer's read index for the oldest slot addressed to
+ * it, copies the payload into the destination buffer, releases the slot
+ * and moves the read index behind it. Slots of the other consumer are
+ * skipped and stay untouched.
  * 
  * @param rb          Pointer to dynamic payload ring buffer instance (IN/OUT).
  * @param consumer_id Identifier of the consumer (TFT_ID or UART_ID) (IN).
@@ -198,18 +272,88 @@ RC_t dynRB_receive(DynPayloadRB_t *rb, dyn_id_t consumer_id, uint8_t *data, uint
     GetResource(res_dyn);
     uint16_t *readIdx = (consumer_id == TFT_ID) ? &rb->readIdx_tft : &rb->readIdx_uart;
     
-    if (rb->fillLevel == 0) {
-        ReleaseResource(res_dyn);
-        return RC_ERROR_BUFFER_EMTPY;   // RC_ERROR_EMPTY
+    for (uint16_t n = 0; (n < DYN_SLOTS) && (rb->fillLevel > 0); n++) 
+    {
+        uint16_t idx = (*readIdx + n) % DYN_SLOTS;
+        dyn_payload_t *slot = &rb->slots[idx];
+        
+        if (slot->msg_id == consumer_id) {
+            *len = slot->payload_len;
+            memcpy(data, slot->payload, *len);
+            
+            slot->msg_id = NONE_ID;                 // Release slot
+            *readIdx = (idx + 1) % DYN_SLOTS;
+            rb->fillLevel--;
+            ReleaseResource(res_dyn);
+            return RC_SUCCESS;
+        }
+    }
+    ReleaseResource(res_dyn);
+    return RC_ERROR_BUFFER_EMTPY;   // RC_ERROR_EMPTY
+}
+
+/**
+ * Append one message as record to an aggregated payload.
+ * 
+ * The record consists of one length byte followed by the message bytes.
+ * 
+ * @param batch     Aggregation buffer (IN/OUT).
+ * @param batch_len Current fill of the aggregation buffer, updated on success (IN/OUT).
+ * @param max_len   Capacity of the aggregation buffer (IN).
+ * @param msg       Message bytes without EOM_MARKER (IN).
+ * @param len       Number of message bytes (IN).
+ * @return RC_SUCCESS if appended, RC_ERROR_BUFFER_FULL if the record does not fit.
+ */
+RC_t dynRB_record_append(uint8_t *batch, uint16_t *batch_len, uint16_t max_len, const uint8_t *msg, uint16_t len) 
+{
+    if ((len > 0xFF) || ((*batch_len + 1 + len) > max_len)) {
+        return RC_ERROR_BUFFER_FULL;
     }
     
-    dyn_payload_t *slot = &rb->slots[*readIdx];
-    *len = slot->payload_len;
-    memcpy(data, slot->payload, *len);
+    batch[(*batch_len)++] = (uint8_t)len;
+    memcpy(&batch[*batch_len], msg, len);
+    *batch_len += len;
+    return RC_SUCCESS;
+}
+
+/**
+ * Start walking the records of an aggregated payload.
+ * 
+ * @param it   Iterator to be initialized (OUT).
+ * @param data Payload to be walked (IN).
+ * @param len  Payload length in bytes (IN).
+ */
+void dynRB_iter_init(dynRB_iter_t *it, const uint8_t *data, uint16_t len) 
+{
+    it->data = data;
+    it->len = len;
+    it->pos = 0;
+}
+
+/**
+ * Fetch the next record of an aggregated payload.
+ * 
+ * @param it      Iterator (IN/OUT).
+ * @param rec     Pointer to the record bytes inside the payload (OUT).
+ * @param rec_len Number of record bytes (OUT).
+ * @return RC_SUCCESS if a record was returned, RC_ERROR_BUFFER_EMTPY at the end,
+ *         RC_ERROR_BAD_DATA if a record exceeds the payload.
+ */
+RC_t dynRB_iter_next(dynRB_iter_t *it, const uint8_t **rec, uint16_t *rec_len) 
+{
+    if (it->pos >= it->len) {
+        return RC_ERROR_BUFFER_EMTPY;
+    }
     
-    *readIdx = *readIdx % DYN_SLOTS;
-    rb->fillLevel--;
-    ReleaseResource(res_dyn);
+    uint16_t len = it->data[it->pos];
+    if ((it->pos + 1 + len) > it->len) {
+        it->pos = it->len;          // Stop walking a corrupt payload
+        return RC_ERROR_BAD_DATA;
+    }
+    
+    *rec = &it->data[it->pos + 1];
+    *rec_len = len;
+    it->pos += 1 + len;
     return RC_SUCCESS;
 }
 
@@ -217,7 +361,7 @@ RC_t dynRB_receive(DynPayloadRB_t *rb, dyn_id_t consumer_id, uint8_t *data, uint
  * Flush the dynamic payload ring buffer.
  * 
  * Sets both TFT and UART read indices equal to the write index, drops
- * all pending messages and resets the fill level.
+ * all pending messages, releases all slots and resets the fill level.
  * 
  * @param rb Pointer to dynamic payload ring buffer instance (IN/OUT).
  * @return RC_SUCCESS after the buffer is cleared.
@@ -228,6 +372,9 @@ RC_t dynRB_flush(DynPayloadRB_t *rb)
     rb->readIdx_tft = rb->writeIdx;   // TFT catches writer
     rb->readIdx_uart = rb->writeIdx;  // UART catches writer
     rb->fillLevel = 0;
+    for (uint16_t i = 0; i < DYN_SLOTS; i++) {
+        rb->slots[i].msg_id = NONE_ID;
+    }
     ReleaseResource(res_dyn);
     return RC_SUCCESS;
 }
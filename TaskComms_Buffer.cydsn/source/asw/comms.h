@@ -20,13 +20,87 @@
 #ifndef COMMS_H
 #define COMMS_H
 
+/* ========================================
+ *  Configuration
+ * ========================================
+ */
+
+/**
+ * Task scheduling.
+ * 
+ * OFF: the UART RX ISR wakes tsk_sender for every message and dynRB_send()
+ *      notifies the consumer task for every payload.
+ * ON:  tsk_sender and the consumers are released cyclically from the
+ *      systick and each run processes everything queued since the last run.
+ *      tsk_sender queues one aggregated payload per consumer and period, the
+ *      TFT payload replaces a pending one (dynRB_replace()). Requires
+ *      USE_SYSTICK in the ErikaOS component.
+ * 
+ * Sizing for ON: uartRB has to hold the bytes of one sender period (115200
+ * baud = 11.5 bytes/ms, 10 ms = 115 of RB_SIZE 256 bytes), and a period's
+ * records have to fit into CFG_COMMS_AGGR_MAX_SIZE bytes, larger bursts take
+ * one more slot each. Within one TFT period the sender adds one UART payload
+ * per sender period and one TFT payload, so DYN_SLOTS must be larger than
+ * CFG_COMMS_TFT_PERIOD_MS / CFG_COMMS_SENDER_PERIOD_MS + 1 (8 > 6).
+ */
+#ifndef CFG_COMMS_TIME_TRIGGERED
+#define CFG_COMMS_TIME_TRIGGERED    OFF
+#endif
+/**
+ * Systick period in time-triggered mode in ms. The release periods are
+ * multiples of it, every tick is an interrupt, so it is the longest period
+ * which divides all of them. cnt_systick counts ticks of this period.
+ */
+#define CFG_COMMS_TICK_MS           10
+/** Release period of tsk_sender in time-triggered mode in ms. */
+#define CFG_COMMS_SENDER_PERIOD_MS  10
+/** Release period of tsk_tft in time-triggered mode in ms (50 ms = 20 Hz). */
+#define CFG_COMMS_TFT_PERIOD_MS     50
+/** Release period of tsk_uart in time-triggered mode in ms. */
+#define CFG_COMMS_UART_PERIOD_MS    10
+
+/**
+ * Value display of tsk_tft: lines of number widgets, one per value (needs
+ * CFG_UI_WIDGETS and CFG_TFT_FIELDS), 4 characters apart.
+ */
+#define CFG_COMMS_TFT_LINES             4
+/** Values per line on the TFT. */
+#define CFG_COMMS_TFT_VALUES_PER_LINE   5
+
+/**
+ * Log of tsk_tft: ON adds a TFT console below the sparkline which shows the
+ * latest record of every run as one text line. Full, it scrolls with the
+ * display hardware instead of being redrawn.
+ */
+#ifndef CFG_COMMS_TFT_CONSOLE
+#define CFG_COMMS_TFT_CONSOLE           OFF
+#endif
+
+/**
+ * Record counter of tsk_uart: ON shows the number of forwarded records in
+ * the title line. tsk_uart only queues the number, tsk_tft draws it.
+ */
+#ifndef CFG_COMMS_TFT_UART_COUNT
+#define CFG_COMMS_TFT_UART_COUNT        OFF
+#endif
+
+/**
+ * Maximum size of one aggregated dynRB entry in bytes (<= DYN_MAX_SIZE).
+ * 
+ * tsk_sender packs all complete frames found in one wakeup as records into
+ * a single entry per consumer until this limit is reached.
+ */
+#define CFG_COMMS_AGGR_MAX_SIZE     DYN_MAX_SIZE
+
 /* ========================================
  *  Streaming Buffer
  * ========================================
  */
 
 /** Size of streaming ring buffer in bytes. */
+#ifndef RB_SIZE
 #define RB_SIZE     256
+#endif
 /** Message terminator byte used as end-of-message marker. */
 #define EOM_MARKER  '\0'
 /** Maximum length of a single extracted message in bytes. */
@@ -42,6 +116,8 @@ typedef struct {
     uint8_t buffer[RB_SIZE];               /**< Storage array for buffered bytes. */
     volatile uint16_t readIdx, writeIdx;   /**< Read and write indices into buffer. */
     volatile uint16_t fillLevel;           /**< Number of bytes currently stored. */
+    volatile uint16_t msgWritten;          /**< EOM markers written (writer side only). */
+    volatile uint16_t msgRead;             /**< Complete messages read (reader side only). */
 } StreamingRB_t;
 
 /** Global streaming ring buffer for UART reception (defined in comms.c). */
@@ -55,7 +131,9 @@ extern StreamingRB_t uartRB;
 /** Maximum payload size per dynamic buffer slot in bytes. */
 #define DYN_MAX_SIZE    128
 /** Total number of slots in the dynamic payload ring buffer. */
+#ifndef DYN_SLOTS
 #define DYN_SLOTS       8
+#endif
 
 /**
  * Identifier type for payload consumers.
@@ -86,7 +164,9 @@ typedef struct {
  * Dynamic payload ring buffer structure.
  * 
  * Shared between multiple consumer tasks, maintaining individual read
- * indices for TFT and UART while using a common write index.
+ * indices for TFT and UART while using a common write index. A slot is
+ * occupied while its msg_id is set and released by its consumer, so the
+ * producer can queue several messages ahead of a slow consumer.
  */
 typedef struct {
     dyn_payload_t slots[DYN_SLOTS]; /**< Array of message slots. */
@@ -99,6 +179,18 @@ typedef struct {
 /** Global shared dynamic payload ring buffer (defined in comms.c). */
 extern DynPayloadRB_t sharedRB;
 
+/**
+ * Iterator over the records of one aggregated dynRB payload.
+ * 
+ * A payload holds a sequence of records, each stored as one length byte
+ * followed by the message bytes without EOM_MARKER.
+ */
+typedef struct {
+    const uint8_t *data;   /**< Payload being walked. */
+    uint16_t len;          /**< Length of the payload in bytes. */
+    uint16_t pos;          /**< Offset of the next record. */
+} dynRB_iter_t;
+
 /* ========================================
  * Function declarations - StreamingRB_t
  * ========================================
@@ -127,7 +219,8 @@ RC_t streamRB_write(StreamingRB_t *rb, uint8_t *byte);
  * @param rb      Pointer to streaming ring buffer instance (IN/OUT).
  * @param msg     Destination buffer for the message bytes (OUT).
  * @param msg_len Pointer to length variable for received message (OUT).
- * @return RC_SUCCESS on complete message, error code otherwise.
+ * @return RC_SUCCESS on complete message, RC_ERROR_BUFFER_EMTPY if no complete
+ *         message is buffered (partial bytes stay untouched), error code otherwise.
  */
 RC_t streamRB_read_message(StreamingRB_t *rb, uint8_t *msg, uint16_t *msg_len);
 
@@ -171,11 +264,35 @@ RC_t dynRB_init(DynPayloadRB_t *rb);
  * @param ev      Event mask to raise for consumer task (IN).
  * @param tsk     Task identifier to notify (IN).
  * @return RC_SUCCESS on success, RC_ERROR on size/space error.
+ * 
+ * In time-triggered mode the event is not set, the consumer picks the
+ * payload up with its next cyclic run.
  */
 RC_t dynRB_send(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t msg_id, EventMaskType ev, char tsk);
 
 /**
- * Receive a payload from the dynamic ring buffer for a given consumer.
+ * Enqueue a payload which supersedes the pending payloads of its consumer.
+ * 
+ * If the consumer has not yet fetched its newest payload, that slot is
+ * overwritten in place, otherwise the payload is enqueued like dynRB_send().
+ * For consumers which only show the latest data, so they hold at most one
+ * slot however seldom they run.
+ * 
+ * @param rb      Pointer to dynamic payload ring buffer instance (IN/OUT).
+ * @param data    Pointer to source data buffer (IN).
+ * @param len     Length of source payload in bytes (IN).
+ * @param msg_id  Target consumer identifier (IN).
+ * @param ev      Event mask to raise for consumer task (IN).
+ * @param tsk     Task identifier to notify (IN).
+ * @return RC_SUCCESS on success, RC_ERROR on size/space error.
+ */
+RC_t dynRB_replace(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t msg_id, EventMaskType ev, char tsk);
+
+/**
+ * Receive the oldest payload from the dynamic ring buffer for a given consumer.
+ * 
+ * Can be called repeatedly until RC_ERROR_BUFFER_EMTPY to drain all
+ * queued payloads of the consumer.
  * 
  * @param rb          Pointer to dynamic payload ring buffer instance (IN/OUT).
  * @param consumer_id Consumer identifier selecting the read index (IN).
@@ -185,6 +302,38 @@ RC_t dynRB_send(DynPayloadRB_t *rb, uint8_t *data, uint16_t len, dyn_id_t msg_id
  */
 RC_t dynRB_receive(DynPayloadRB_t *rb, dyn_id_t consumer_id, uint8_t *data, uint16_t *len);
 
+/**
+ * Append one message as record to an aggregated payload.
+ * 
+ * @param batch     Aggregation buffer (IN/OUT).
+ * @param batch_len Current length of the aggregation buffer, updated (IN/OUT).
+ * @param max_len   Capacity of the aggregation buffer (IN).
+ * @param msg       Message bytes without EOM_MARKER (IN).
+ * @param len       Number of message bytes (IN).
+ * @return RC_SUCCESS if appended, RC_ERROR_BUFFER_FULL if the record does not fit.
+ */
+RC_t dynRB_record_append(uint8_t *batch, uint16_t *batch_len, uint16_t max_len, const uint8_t *msg, uint16_t len);
+
+/**
+ * Start walking the records of an aggregated payload.
+ * 
+ * @param it   Iterator to be initialized (OUT).
+ * @param data Payload as returned by dynRB_receive() (IN).
+ * @param len  Payload length as returned by dynRB_receive() (IN).
+ */
+void dynRB_iter_init(dynRB_iter_t *it, const uint8_t *data, uint16_t len);
+
+/**
+ * Fetch the next record of an aggregated payload.
+ * 
+ * @param it      Iterator (IN/OUT).
+ * @param rec     Pointer to the record bytes inside the payload (OUT).
+ * @param rec_len Number of record bytes (OUT).
+ * @return RC_SUCCESS if a record was returned, RC_ERROR_BUFFER_EMTPY at the end,
+ *         RC_ERROR_BAD_DATA if a record exceeds the payload.
+ */
+RC_t dynRB_iter_next(dynRB_iter_t *it, const uint8_t **rec, uint16_t *rec_len);
+
 /**
  * Flush all entries from the dynamic payload ring buffer.
  * 
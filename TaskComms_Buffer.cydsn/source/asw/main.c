@@ -12,29 +12,64 @@
  * WHICH IS THE PROPERTY OF your company.
  *
  * NOTE:
- * 1. No systick timer usage in this project.
+ * 1. Systick timer is only used in time-triggered mode (CFG_COMMS_TIME_TRIGGERED).
  * 2. Transmit only Decimal values.
  * 3. Use uart baud rate - 115200.
  *
  * ========================================
 */
 #include <stdlib.h>
+#include <stdio.h>
 #include "project.h"
 #include "global.h"
 #include "comms.h"
 #include "tft.h"
+#include "ui.h"
+#include "cpuload.h"
 
 StreamingRB_t uartRB;          /**< Global streaming UART receive ring buffer instance. */
 DynPayloadRB_t sharedRB;       /**< Global dynamic payload ring buffer shared between multiple tasks. */
 
+#if (CFG_COMMS_TIME_TRIGGERED == ON)
+#ifndef __USE_SYSTICK__
+#error "CFG_COMMS_TIME_TRIGGERED requires USE_SYSTICK in the ErikaOS component"
+#endif
+
+/**
+ * Cyclic release of one task in time-triggered mode.
+ * 
+ * The OS configuration only provides alrm_50ms (bound to tsk_sender), so the
+ * task periods are derived from the systick in software instead.
+ */
+typedef struct {
+    TaskType task;            /**< Task to be released. */
+    EventMaskType event;      /**< Event releasing the task. */
+    uint16_t period_ms;       /**< Release period in ms. */
+    uint16_t elapsed_ms;      /**< Time since the last release in ms. */
+} comms_release_t;
+
+#if ((CFG_COMMS_SENDER_PERIOD_MS % CFG_COMMS_TICK_MS) != 0) || ((CFG_COMMS_TFT_PERIOD_MS % CFG_COMMS_TICK_MS) != 0) || ((CFG_COMMS_UART_PERIOD_MS % CFG_COMMS_TICK_MS) != 0)
+#error "The release periods must be multiples of CFG_COMMS_TICK_MS"
+#endif
+
+/** Release table, evaluated once per tick by the systick ISR. */
+static comms_release_t comms_release[] = {
+    { tsk_sender, ev_sender, CFG_COMMS_SENDER_PERIOD_MS, 0 },
+    { tsk_tft,  ev_tft,  CFG_COMMS_TFT_PERIOD_MS,  0 },
+    { tsk_uart, ev_uart, CFG_COMMS_UART_PERIOD_MS, 0 },
+};
+#endif
+
 int main()
 {
     /* Enable global interrupts for the whole system. */
     CyGlobalIntEnable; 
     
-    /* Configure SysTick to generate a 1 ms tick and enable its interrupt. */
-    //EE_systick_set_period(MILLISECONDS_TO_TICKS(1, BCLK__BUS_CLK__HZ));
-    //EE_systick_enable_int();
+#if (CFG_COMMS_TIME_TRIGGERED == ON)
+    /* Configure SysTick to generate the release tick and enable its interrupt. */
+    EE_systick_set_period(MILLISECONDS_TO_TICKS(CFG_COMMS_TICK_MS, BCLK__BUS_CLK__HZ));
+    EE_systick_enable_int();
+#endif
     
     /* Start the OSEK/EE operating system in the default application mode. */
     for(;;) 
@@ -64,8 +99,10 @@ TASK(tsk_init)
     /* Configure system ISRs with OS parameters; must follow driver init. */
     EE_system_init();
      
+#if (CFG_COMMS_TIME_TRIGGERED == ON)
     /* Start SysTick after vector table has been updated by the OS. */
-    //EE_systick_start();  
+    EE_systick_start();  
+#endif
     
     /* Initialize UART streaming RX ring buffer. */
     streamRB_init(&uartRB);
@@ -78,8 +115,9 @@ TASK(tsk_init)
     /* Flush all communication buffers to ensure a clean startup state. */
     RB_flush_all();
     
-    /* Start cyclic alarms if configured (not shown here). */
-
+    /* Record the idle baseline for the CPU load measurement while no other task is active. */
+    CPULOAD_init();
+    
     /* Activate all extended tasks and the background task. */
     ActivateTask(tsk_sender);
     ActivateTask(tsk_tft);
@@ -90,49 +128,80 @@ TASK(tsk_init)
     TerminateTask();
 }
 
+/**
+ * Forward one aggregated payload to the UART and TFT consumers.
+ * 
+ * A consumer whose enqueue fails misses this payload, the other one still
+ * gets it. The ring frees itself as the consumers drain their slots. In
+ * time-triggered mode the TFT payload replaces a pending one, tsk_tft only
+ * shows the latest record.
+ * 
+ * @param batch     Aggregated records (IN).
+ * @param batch_len Length of the aggregated records in bytes (IN).
+ */
+static void sender_dispatch(uint8_t *batch, uint16_t batch_len)
+{
+    (void)dynRB_send(&sharedRB, batch, batch_len, UART_ID, ev_uart, tsk_uart);      /**< Enqueue for UART forwarding. */
+#if (CFG_COMMS_TIME_TRIGGERED == ON)
+    (void)dynRB_replace(&sharedRB, batch, batch_len, TFT_ID, ev_tft, tsk_tft);      /**< Update the TFT display. */
+#else
+    (void)dynRB_send(&sharedRB, batch, batch_len, TFT_ID,  ev_tft,  tsk_tft);       /**< Enqueue for TFT display. */
+#endif
+}
+
 /**
  * Sender task.
  * 
- * Waits for complete messages in the streaming buffer, dispatches them to
- * the dynamic payload buffer for TFT and UART consumers, and performs
- * buffer housekeeping and error recovery.
+ * Waits for complete messages in the streaming buffer and dispatches them to
+ * the dynamic payload buffer for TFT and UART consumers. All messages found
+ * in one wakeup are aggregated as records into as few dynRB entries as
+ * possible, so a burst costs one enqueue and one consumer wakeup instead of
+ * one per message. In time-triggered mode it runs once per sender period
+ * instead of once per message. Also performs buffer housekeeping and error
+ * recovery.
  */
 TASK(tsk_sender)
 {
     EventMaskType ev = 0;
     
-    uint8_t uart_msg[128];   /**< Local buffer for one decoded UART message. */
-    uint16_t msg_len;        /**< Length of the received UART message in bytes. */
+    uint8_t uart_msg[128];                  /**< Local buffer for one decoded UART message. */
+    uint16_t msg_len;                       /**< Length of the received UART message in bytes. */
+    uint8_t batch[CFG_COMMS_AGGR_MAX_SIZE]; /**< Records aggregated in this wakeup. */
+    uint16_t batch_len;                     /**< Fill level of batch in bytes. */
+    RC_t result;
 
     while (1)
     {
-        /* Block until the sender event is set by the UART RX ISR. */
+        /* Block until the sender event is set by the UART RX ISR or the systick. */
         WaitEvent(ev_sender);
         GetEvent(tsk_sender, &ev);
         ClearEvent(ev);       
 
         if(ev & ev_sender)
         {
-            /* Extract one complete message terminating at EOM_MARKER. */
-            RC_t result = streamRB_read_message(&uartRB, uart_msg, &msg_len);
-
-            if (result == RC_SUCCESS && msg_len > 0) 
+            batch_len = 0;
+            
+            /* Extract all complete messages terminating at EOM_MARKER. */
+            while ((result = streamRB_read_message(&uartRB, uart_msg, &msg_len)) == RC_SUCCESS) 
             {
-                /* Forward the same message to UART and TFT consumers. */
-                RC_t resultUart = dynRB_send(&sharedRB, uart_msg, msg_len, UART_ID, ev_uart, tsk_uart);   /**< Enqueue for UART forwarding. */
-                RC_t resultTFT  = dynRB_send(&sharedRB, uart_msg, msg_len, TFT_ID,  ev_tft,  tsk_tft);    /**< Enqueue for TFT display. */
-                
-                /* If any enqueue fails, reset the dynamic buffer to recover. */
-                if ((resultTFT != RC_SUCCESS) || (resultUart != RC_SUCCESS)) 
+                /* Store without EOM; forward the batch first if the record does not fit. */
+                if (dynRB_record_append(batch, &batch_len, sizeof(batch), uart_msg, msg_len - 1) != RC_SUCCESS) 
                 {
-                    dynRB_flush(&sharedRB);
-                } else {
-                    __asm("nop"); 
+                    sender_dispatch(batch, batch_len);
+                    batch_len = 0;
+                    (void)dynRB_record_append(batch, &batch_len, sizeof(batch), uart_msg, msg_len - 1);
                 }
-                /* Clear streaming buffer after successful processing of message. */
-                streamRB_flush(&uartRB);             
-            } else {
-                __asm("nop");
+            }
+            
+            if (batch_len > 0) 
+            {
+                sender_dispatch(batch, batch_len);
+            }
+            
+            /* Message too long or buffer full without EOM - resynchronise. */
+            if (result != RC_ERROR_BUFFER_EMTPY) 
+            {
+                streamRB_flush(&uartRB);
             }
         }
     }
@@ -144,8 +213,13 @@ TASK(tsk_sender)
 /**
  * TFT consumer task.
  * 
- * Waits for messages targeted at the TFT, reads them from the dynamic payload
- * buffer and prints the numeric values on the display.
+ * Waits for messages targeted at the TFT, drains them from the dynamic payload
+ * buffer and shows the latest record on the display. The values are number
+ * widgets, the first value is also shown as bar graph and sparkline. Setting
+ * a widget only marks it dirty, ui_render() then repaints the changed widgets
+ * in one pass and the screen is never cleared. In time-triggered mode this
+ * limits the redraws to one per period. It also renders the TFT draw queue
+ * of the other tasks, which shares ev_tft.
  */
 TASK(tsk_tft) 
 {
@@ -153,6 +227,32 @@ TASK(tsk_tft)
     
     uint8_t tft_data[128];   /**< Local buffer storing message data for TFT. */
     uint16_t len;            /**< Payload length fetched for TFT. */
+    uint16_t msgs;           /**< Number of payloads fetched in this run. */
+    dynRB_iter_t it;         /**< Iterator over the records of a payload. */
+    const uint8_t *rec = NULL;   /**< Latest record of the last payload. */
+    uint16_t rec_len = 0;        /**< Length of the latest record. */
+    ui_widget_t values[CFG_COMMS_TFT_LINES * CFG_COMMS_TFT_VALUES_PER_LINE];   /**< Number widgets of the values. */
+    ui_widget_t bar;         /**< Bar graph of the first value. */
+    ui_widget_t spark;       /**< Sparkline of the first value. */
+#if (CFG_COMMS_TFT_CONSOLE == ON)
+    char line[CFG_TFT_FIELD_LEN + 1];  /**< Console line of the latest record. */
+    int pos;                 /**< Characters of the line. */
+#endif
+
+    /* Static layout: title, one number per value, bar and sparkline below. */
+    ui_init();
+    (void)ui_label_set(ui_label_create(0, 0, 10), "Task Comms");
+    for (uint16_t i = 0; i < CFG_COMMS_TFT_LINES * CFG_COMMS_TFT_VALUES_PER_LINE; i++)
+    {
+        values[i] = ui_number_create((i % CFG_COMMS_TFT_VALUES_PER_LINE) * 24,
+                                     20 + (i / CFG_COMMS_TFT_VALUES_PER_LINE) * 10, 3);
+    }
+    bar   = ui_bar_create(0, 24 + CFG_COMMS_TFT_LINES * 10, 120, 6, 255);
+    spark = ui_sparkline_create(0, 36 + CFG_COMMS_TFT_LINES * 10, 120, 40, 255);
+    (void)ui_render();
+#if (CFG_COMMS_TFT_CONSOLE == ON)
+    (void)TFT_console_start(80 + CFG_COMMS_TFT_LINES * 10, 0);
+#endif
 
     while (1)
     {
@@ -163,17 +263,56 @@ TASK(tsk_tft)
 
         if(ev & ev_tft)
         {            
-            /* Retrieve next TFT-specific payload from shared ring buffer. */
-            if (dynRB_receive(&sharedRB, TFT_ID, tft_data, &len) == RC_SUCCESS) 
+            /* Draw commands of other tasks first, they never wait for the SPI. */
+            (void)TFT_queue_render();
+
+            /* Retrieve all queued TFT payloads, only the latest one is shown. */
+            msgs = 0;
+            while (dynRB_receive(&sharedRB, TFT_ID, tft_data, &len) == RC_SUCCESS) 
+            {
+                msgs++;
+            }
+            
+            /* Walk the last payload up to its latest record. */
+            if (msgs > 0) 
             {
-                /* Print all values except the terminating EOM marker. */
-                for (uint16_t i = 0; i < (len - 1); i++) // -1 to avoid \0
+                dynRB_iter_init(&it, tft_data, len);
+                while (dynRB_iter_next(&it, &rec, &rec_len) == RC_SUCCESS) 
                 {
-                    TFT_setCursor(0 + i * 16, 20);  /**< Place cursor for each integer output. */
-                    TFT_printInt(tft_data[i]);
+                    /* Only the latest record is displayed. */
                 }
-                /* Flush dynamic buffer so that subsequent messages start cleanly. */
-                dynRB_flush(&sharedRB);    
+            }
+            
+            if (rec != NULL) 
+            {
+                /* Show the values of the record, unused numbers are blanked. */
+                for (uint16_t i = 0; i < CFG_COMMS_TFT_LINES * CFG_COMMS_TFT_VALUES_PER_LINE; i++)
+                {
+                    if (i < rec_len) 
+                    {
+                        (void)ui_number_set(values[i], rec[i]);
+                    } 
+                    else 
+                    {
+                        (void)ui_number_clear(values[i]);
+                    }
+                }
+                if (rec_len > 0) 
+                {
+                    (void)ui_bar_set(bar, rec[0]);
+                    (void)ui_sparkline_push(spark, rec[0]);
+                }
+                (void)ui_render();
+#if (CFG_COMMS_TFT_CONSOLE == ON)
+                /* Values like the UART echo, cut at the screen edge. */
+                pos = snprintf(line, sizeof(line), "%u:", (unsigned)msgs);
+                for (uint16_t i = 0; (i < rec_len) && (pos < (int)sizeof(line) - 1); i++)
+                {
+                    pos += snprintf(&line[pos], sizeof(line) - pos, " %u", (unsigned)rec[i]);
+                }
+                (void)TFT_console_print(line);
+#endif
+                rec = NULL;
             } else {
                 __asm("nop");
             }
@@ -188,7 +327,10 @@ TASK(tsk_tft)
  * UART forwarder task.
  * 
  * Waits for UART-specific messages in the dynamic payload buffer, then
- * retransmits the numeric values over UART in a formatted way.
+ * retransmits the numeric values of every queued message over UART in a
+ * formatted way. With CFG_COMMS_TFT_UART_COUNT the number of forwarded
+ * records is shown in the title line through the TFT draw queue, which
+ * tsk_tft renders.
  */
 TASK(tsk_uart) 
 {
@@ -196,6 +338,12 @@ TASK(tsk_uart)
     
     uint8_t uart_fwd[128];   /**< Local buffer for data to forward via UART. */
     uint16_t len;            /**< Length of data to forward over UART. */
+    dynRB_iter_t it;         /**< Iterator over the records of a payload. */
+    const uint8_t *rec;      /**< Current record. */
+    uint16_t rec_len;        /**< Length of the current record. */
+#if (CFG_COMMS_TFT_UART_COUNT == ON)
+    uint32_t forwarded = 0;  /**< Records forwarded since start. */
+#endif
 
     while (1)
     {
@@ -206,23 +354,31 @@ TASK(tsk_uart)
 
         if(ev & ev_uart)
         {
-            /* Retrieve next UART-specific payload from shared ring buffer. */
-            if (dynRB_receive(&sharedRB, UART_ID, uart_fwd, &len) == RC_SUCCESS) 
+            /* Retrieve all queued UART-specific payloads from shared ring buffer. */
+            while (dynRB_receive(&sharedRB, UART_ID, uart_fwd, &len) == RC_SUCCESS) 
             {
-                /* Forward all data bytes except EOM marker as formatted integers. */
-                UART_LOG_PutString("\r\nReceived: ");
-                for (uint16_t i = 0; i < (len - 1); i++) // -1 to avoid \0
+                /* Forward every record as a line of formatted integers. */
+                dynRB_iter_init(&it, uart_fwd, len);
+                while (dynRB_iter_next(&it, &rec, &rec_len) == RC_SUCCESS) 
                 {
-                    UART_LOG_PutInt(uart_fwd[i]);
-                    
-                    if(i < (len - 2)) {
-                        UART_LOG_PutString(", ");
+                    UART_LOG_PutString("\r\nReceived: ");
+                    for (uint16_t i = 0; i < rec_len; i++)
+                    {
+                        UART_LOG_PutInt(rec[i]);
+                        
+                        if(i < (rec_len - 1)) {
+                            UART_LOG_PutString(", ");
+                        }
                     }
+                    UART_LOG_PutString(".\n\r");
+#if (CFG_COMMS_TFT_UART_COUNT == ON)
+                    forwarded++;
+#endif
                 }
-                UART_LOG_PutString(".\n\r");
-            } else {
-                __asm("nop");
             }
+#if (CFG_COMMS_TFT_UART_COUNT == ON)
+            (void)TFT_queue_number(98, 0, (int32_t)forwarded, 5, YELLOW, BLACK, 1);
+#endif
         }
     }
     
@@ -233,15 +389,16 @@ TASK(tsk_uart)
 /**
  * Background task.
  * 
- * Lowest-priority task intended for optional background processing or
- * idle-time activities.
+ * Lowest-priority task, runs whenever no other task is ready. Every loop
+ * iteration is counted as idle time for the CPU load measurement, which is
+ * available via CPULOAD_getLoad()/CPULOAD_getPeak() and logged cyclically.
  */
 TASK(tsk_background)
 {
     while(1)
     {
-        /* Placeholder for low-priority or idle processing. */
-        __asm("nop");
+        /* Count idle iteration, evaluates the load once per window. */
+        CPULOAD_idle();
     }
     
     TerminateTask();
@@ -251,22 +408,37 @@ TASK(tsk_background)
  * ISR Definitions
  ********************************************************************************/
 
+#if (CFG_COMMS_TIME_TRIGGERED == ON)
 /**
  * SysTick interrupt service routine.
  * 
- * Increments the system counter each millisecond to drive alarms and
- * OS time-related services.
+ * Increments the system counter each CFG_COMMS_TICK_MS to drive alarms
+ * and OS time-related services, and releases the tasks whose period has
+ * elapsed.
  */
-/*ISR(systick_handler)
+ISR(systick_handler)
 {
     CounterTick(cnt_systick);
-}*/
+    
+    for (uint8_t i = 0; i < sizeof(comms_release) / sizeof(comms_release[0]); i++) 
+    {
+        comms_release[i].elapsed_ms += CFG_COMMS_TICK_MS;
+        if (comms_release[i].elapsed_ms >= comms_release[i].period_ms) 
+        {
+            comms_release[i].elapsed_ms = 0;
+            SetEvent(comms_release[i].task, comms_release[i].event);
+        }
+    }
+}
+#endif
 
 /**
  * UART RX interrupt service routine (category 2).
  * 
  * Reads incoming bytes from UART, writes them into the streaming ring buffer
- * and signals the sender task once an end-of-message marker is received.
+ * and signals the sender task once an end-of-message marker is received. In
+ * time-triggered mode the systick releases the sender, only an overflow
+ * wakes it early.
  */
 ISR2(isr_uartRX) {
     /* Clear pending interrupt flag for the UART RX source. */
@@ -280,20 +452,43 @@ ISR2(isr_uartRX) {
     //UART_LOG_PutString("\r\nC1\n\r");
     if (result == RC_SUCCESS) 
     {
+#if (CFG_COMMS_TIME_TRIGGERED == OFF)
         if (rxByte == '\0') 
         {
-            /* Clear display for a fresh rendering of the new message. */
-            TFT_clearScreen();
-            TFT_print("Task Comms\n");
             /* Notify sender task that a complete message is available. */
             SetEvent(tsk_sender, ev_sender);
-        } else if (result == RC_ERROR_BUFFER_FULL) {
-            /* If write failed due to overflow, flush the streaming buffer. */
-            streamRB_flush(&uartRB);
         } else {
             __asm("nop");
         }
+#endif
+    } else if (result == RC_ERROR_BUFFER_FULL) {
+        /* On overflow let the sender drain or resynchronise the streaming buffer. */
+        SetEvent(tsk_sender, ev_sender);
+    } else {
+        __asm("nop");
     }
 }
 
+#if (CFG_TFT_TX_BLOCKING == ON)
+/**
+ * TFT SPI TX interrupt service routine (category 2).
+ * 
+ * Refills the TX FIFO and wakes the TFT task once its output has drained.
+ */
+ISR2(isr_tftTx) {
+    TFT_txIsr();
+}
+#endif
+
+#if (CFG_TFT_DMA == ON)
+/**
+ * TFT DMA transfer done interrupt service routine (category 2).
+ * 
+ * Releases the SPI and wakes the TFT task if it sleeps on the transfer.
+ */
+ISR2(isr_tftDma) {
+    TFT_dmaIsr();
+}
+#endif
+
 /* [main.c] END OF FILE */
\ No newline at end of file
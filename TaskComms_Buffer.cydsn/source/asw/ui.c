@@ -0,0 +1,546 @@
+/* ========================================
+ *
+ * \file ui.c
+ * \author V.S. Agilan
+ * \date 21.01.26
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "ui.h"
+
+/* ========================================
+ *  Widget Data
+ * ========================================
+*/
+
+/**
+ * One entry of the widget array.
+ *
+ * The bounding box is used by ui_invalidateArea() and for full repaints.
+ * A widget is only touched by ui_render() while it is dirty.
+ */
+typedef struct {
+    ui_kind_t kind;                 /**< Widget type, UI_UNUSED = free entry. */
+    boolean_t dirty;                /**< Content changed since the last ui_render(). */
+    boolean_t full;                 /**< The whole bounding box has to be repainted. */
+    int16_t x, y, w, h;             /**< Bounding box in pixels. */
+    TFT_color_t fg, bg;             /**< Colors of bar graph and sparkline. */
+    uint16_t max;                   /**< Full scale of bar graph and sparkline. */
+    uint16_t value;                 /**< Current value of a bar graph. */
+    int16_t shown;                  /**< Filled width of a bar graph on the screen. */
+    uint8_t len;                    /**< Width of a text widget in characters. */
+    TFT_field_t field;              /**< Text field of a label or number. */
+    uint8_t spark;                  /**< History of a sparkline. */
+    char text[CFG_UI_TEXT_LEN + 1]; /**< Text of a label or number. */
+} ui_data_t;
+
+/**
+ * History of a sparkline.
+ *
+ * The drawn y offsets of the points are kept so that a point which moved
+ * can be erased with exactly the pixels of its old segments.
+ */
+typedef struct {
+    boolean_t used;                          /**< Assigned to a sparkline widget. */
+    uint8_t count;                           /**< Valid values, oldest first. */
+    uint8_t shownCount;                      /**< Points on the screen. */
+    uint16_t value[CFG_UI_SPARK_POINTS];     /**< Values, oldest first. */
+    uint8_t shown[CFG_UI_SPARK_POINTS];      /**< Drawn y offsets of the points. */
+} ui_spark_t;
+
+static ui_data_t widgets[CFG_UI_WIDGETS];     /**< Static widget array. */
+static ui_spark_t sparks[CFG_UI_SPARKLINES];  /**< Sparkline histories. */
+
+/* ========================================
+ *  Local Functions
+ * ========================================
+*/
+
+/**
+ * Take a free entry of the widget array and set up its bounding box.
+ *
+ * The widget starts dirty with a full repaint pending.
+ *
+ * @param kind Widget type (IN).
+ * @param x    Left edge in pixels (IN).
+ * @param y    Top edge in pixels (IN).
+ * @param w    Width in pixels (IN).
+ * @param h    Height in pixels (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if the array is full.
+ */
+static ui_widget_t ui_alloc(ui_kind_t kind, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    ui_widget_t i;
+    ui_data_t *d;
+
+    for (i = 0; (i < CFG_UI_WIDGETS) && (widgets[i].kind != UI_UNUSED); i++);
+    if ((i >= CFG_UI_WIDGETS) || (w <= 0) || (h <= 0)) {
+        return UI_WIDGET_NONE;
+    }
+
+    d = &widgets[i];
+    memset(d, 0, sizeof(*d));
+    d->kind = kind;
+    d->x = x;
+    d->y = y;
+    d->w = w;
+    d->h = h;
+    d->fg = TFT_getFGcolor();
+    d->bg = TFT_getBGcolor();
+    d->field = TFT_FIELD_INVALID;
+    d->dirty = d->full = TRUE;
+    return i;
+}
+
+/**
+ * Create a widget shown in a TFT text field.
+ *
+ * @param kind UI_LABEL or UI_NUMBER (IN).
+ * @param x    Left edge in pixels (IN).
+ * @param y    Top edge in pixels (IN).
+ * @param len  Width in characters (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or text field is left.
+ */
+static ui_widget_t ui_text_create(ui_kind_t kind, int16_t x, int16_t y, uint8_t len)
+{
+    uint8_t size = TFT_getTextSize();
+    ui_widget_t i;
+
+    if (len > CFG_UI_TEXT_LEN) {
+        len = CFG_UI_TEXT_LEN;
+    }
+    i = ui_alloc(kind, x, y, len * 6 * size, 8 * size);
+    if (i == UI_WIDGET_NONE) {
+        return UI_WIDGET_NONE;
+    }
+
+    widgets[i].field = TFT_field_create(x, y, len, NULL);
+    if (widgets[i].field == TFT_FIELD_INVALID) {
+        widgets[i].kind = UI_UNUSED;
+        return UI_WIDGET_NONE;
+    }
+    widgets[i].len = len;
+    return i;
+}
+
+/**
+ * Check a handle against the expected widget type.
+ *
+ * @param w    Handle of the widget (IN).
+ * @param kind Expected widget type (IN).
+ * @return Widget data, NULL if the handle is invalid or of another type.
+ */
+static ui_data_t *ui_get(ui_widget_t w, ui_kind_t kind)
+{
+    if ((w >= CFG_UI_WIDGETS) || (widgets[w].kind != kind)) {
+        return NULL;
+    }
+    return &widgets[w];
+}
+
+/**
+ * Store a new text and mark the widget dirty if it differs.
+ *
+ * @param d    Label or number (IN/OUT).
+ * @param text New text, at most d->len characters (IN).
+ */
+static void ui_text_update(ui_data_t *d, const char *text)
+{
+    if (strcmp(d->text, text) != 0) {
+        strcpy(d->text, text);
+        d->dirty = TRUE;
+    }
+}
+
+/**
+ * Paint a bar graph, only the part between the old and new filled width
+ * unless a full repaint is pending.
+ *
+ * @param d Bar graph (IN/OUT).
+ */
+static void ui_render_bar(ui_data_t *d)
+{
+    int16_t fill = (int16_t)(((uint32_t)d->value * d->w) / d->max);
+
+    if (d->full) {
+        if (fill > 0) {
+            TFT_fillRect(d->x, d->y, fill, d->h, d->fg);
+        }
+        if (fill < d->w) {
+            TFT_fillRect(d->x + fill, d->y, d->w - fill, d->h, d->bg);
+        }
+    } else if (fill > d->shown) {
+        TFT_fillRect(d->x + d->shown, d->y, fill - d->shown, d->h, d->fg);
+    } else if (fill < d->shown) {
+        TFT_fillRect(d->x + fill, d->y, d->shown - fill, d->h, d->bg);
+    }
+    d->shown = fill;
+}
+
+/**
+ * Column of a sparkline point.
+ *
+ * @param d Sparkline (IN).
+ * @param i Index of the point (IN).
+ * @return x coordinate in pixels.
+ */
+static int16_t ui_spark_x(const ui_data_t *d, uint8_t i)
+{
+    return d->x + (int16_t)(((int32_t)i * (d->w - 1)) / (CFG_UI_SPARK_POINTS - 1));
+}
+
+/**
+ * Paint a sparkline.
+ *
+ * A segment connects two neighbouring points. Segments with a moved end
+ * point are erased with their old coordinates and drawn again, and so are
+ * the segments next to an erased one since they share its end column.
+ * Narrower sparklines than CFG_UI_SPARK_POINTS pixels share columns between
+ * more segments and are always repainted completely.
+ *
+ * @param d Sparkline (IN/OUT).
+ */
+static void ui_render_sparkline(ui_data_t *d)
+{
+    ui_spark_t *s = &sparks[d->spark];
+    uint8_t ys[CFG_UI_SPARK_POINTS];
+    boolean_t moved[CFG_UI_SPARK_POINTS + 1];
+    uint8_t i;
+
+    if (d->full || (d->w < CFG_UI_SPARK_POINTS)) {
+        TFT_fillRect(d->x, d->y, d->w, d->h, d->bg);
+        s->shownCount = 0;
+    }
+
+    for (i = 0; i < s->count; i++) {
+        ys[i] = (uint8_t)((d->h - 1) - ((uint32_t)s->value[i] * (d->h - 1)) / d->max);
+    }
+    for (i = 0; i < CFG_UI_SPARK_POINTS; i++) {
+        moved[i] = (i >= s->count) || (i >= s->shownCount) || (ys[i] != s->shown[i]);
+    }
+    moved[CFG_UI_SPARK_POINTS] = FALSE;
+
+    /* Erase the old segments with a moved end point. */
+    if ((s->shownCount == 1) && moved[0]) {
+        TFT_drawPixel(ui_spark_x(d, 0), d->y + s->shown[0], d->bg);
+    }
+    for (i = 0; i + 1 < s->shownCount; i++) {
+        if (moved[i] || moved[i + 1]) {
+            TFT_writeLine(ui_spark_x(d, i), d->y + s->shown[i],
+                          ui_spark_x(d, i + 1), d->y + s->shown[i + 1], d->bg);
+        }
+    }
+
+    /* Draw the new and the erased segments and their neighbours. */
+    if ((s->count == 1) && moved[0]) {
+        TFT_drawPixel(ui_spark_x(d, 0), d->y + ys[0], d->fg);
+    }
+    for (i = 0; i + 1 < s->count; i++) {
+        if (moved[i] || moved[i + 1] || moved[i + 2] || ((i > 0) && moved[i - 1])) {
+            TFT_writeLine(ui_spark_x(d, i), d->y + ys[i],
+                          ui_spark_x(d, i + 1), d->y + ys[i + 1], d->fg);
+        }
+    }
+
+    memcpy(s->shown, ys, s->count);
+    s->shownCount = s->count;
+}
+
+/* ========================================
+ *  Widget API
+ * ========================================
+*/
+
+/**
+ * Initialize the widget layer and drop all widgets.
+ */
+void ui_init(void)
+{
+    memset(widgets, 0, sizeof(widgets));
+    memset(sparks, 0, sizeof(sparks));
+}
+
+/**
+ * Create a text label in the classic font.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param len Width in characters (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or text field is left.
+ */
+ui_widget_t ui_label_create(int16_t x, int16_t y, uint8_t len)
+{
+    return ui_text_create(UI_LABEL, x, y, len);
+}
+
+/**
+ * Create a right aligned decimal number in the classic font.
+ *
+ * @param x      Left edge in pixels (IN).
+ * @param y      Top edge in pixels (IN).
+ * @param digits Width in characters including the sign (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or text field is left.
+ */
+ui_widget_t ui_number_create(int16_t x, int16_t y, uint8_t digits)
+{
+    return ui_text_create(UI_NUMBER, x, y, digits);
+}
+
+/**
+ * Create a horizontal bar graph which fills from the left.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param w   Width in pixels (IN).
+ * @param h   Height in pixels (IN).
+ * @param max Value of a full bar (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget is left.
+ */
+ui_widget_t ui_bar_create(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t max)
+{
+    ui_widget_t i = ui_alloc(UI_BAR, x, y, w, h);
+
+    if (i != UI_WIDGET_NONE) {
+        widgets[i].max = (max > 0) ? max : 1;
+    }
+    return i;
+}
+
+/**
+ * Create a sparkline.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param w   Width in pixels (IN).
+ * @param h   Height in pixels, at most 256 (IN).
+ * @param max Value at the top edge (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or sparkline history is left.
+ */
+ui_widget_t ui_sparkline_create(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t max)
+{
+    uint8_t s;
+    ui_widget_t i;
+
+    for (s = 0; (s < CFG_UI_SPARKLINES) && sparks[s].used; s++);
+    if ((s >= CFG_UI_SPARKLINES) || (h > 256)) {
+        return UI_WIDGET_NONE;
+    }
+
+    i = ui_alloc(UI_SPARKLINE, x, y, w, h);
+    if (i != UI_WIDGET_NONE) {
+        memset(&sparks[s], 0, sizeof(sparks[s]));
+        sparks[s].used = TRUE;
+        widgets[i].spark = s;
+        widgets[i].max = (max > 0) ? max : 1;
+    }
+    return i;
+}
+
+/**
+ * Set the text of a label.
+ *
+ * @param w    Handle of a label (IN).
+ * @param text Zero terminated text (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no label, RC_ERROR_NULL if text is NULL.
+ */
+RC_t ui_label_set(ui_widget_t w, const char *text)
+{
+    ui_data_t *d = ui_get(w, UI_LABEL);
+    char buf[CFG_UI_TEXT_LEN + 1];
+
+    if (d == NULL) {
+        return RC_ERROR_BAD_PARAM;
+    }
+    if (text == NULL) {
+        return RC_ERROR_NULL;
+    }
+
+    strncpy(buf, text, d->len);
+    buf[d->len] = '\0';
+    ui_text_update(d, buf);
+    return RC_SUCCESS;
+}
+
+/**
+ * Set the value of a number.
+ *
+ * @param w     Handle of a number (IN).
+ * @param value Value to show (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no number.
+ */
+RC_t ui_number_set(ui_widget_t w, int32_t value)
+{
+    ui_data_t *d = ui_get(w, UI_NUMBER);
+    char digits[12];
+    char buf[CFG_UI_TEXT_LEN + 1];
+    uint8_t n;
+
+    if (d == NULL) {
+        return RC_ERROR_BAD_PARAM;
+    }
+
+    n = (uint8_t)sprintf(digits, "%ld", (long)value);
+    if (n > d->len) {
+        memset(buf, '#', d->len);
+    } else {
+        memset(buf, ' ', d->len - n);
+        memcpy(&buf[d->len - n], digits, n);
+    }
+    buf[d->len] = '\0';
+    ui_text_update(d, buf);
+    return RC_SUCCESS;
+}
+
+/**
+ * Blank a number.
+ *
+ * @param w Handle of a number (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no number.
+ */
+RC_t ui_number_clear(ui_widget_t w)
+{
+    ui_data_t *d = ui_get(w, UI_NUMBER);
+
+    if (d == NULL) {
+        return RC_ERROR_BAD_PARAM;
+    }
+
+    ui_text_update(d, "");
+    return RC_SUCCESS;
+}
+
+/**
+ * Set the value of a bar graph.
+ *
+ * @param w     Handle of a bar graph (IN).
+ * @param value New value (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no bar graph.
+ */
+RC_t ui_bar_set(ui_widget_t w, uint16_t value)
+{
+    ui_data_t *d = ui_get(w, UI_BAR);
+
+    if (d == NULL) {
+        return RC_ERROR_BAD_PARAM;
+    }
+
+    d->value = (value > d->max) ? d->max : value;
+    if ((int16_t)(((uint32_t)d->value * d->w) / d->max) != d->shown) {
+        d->dirty = TRUE;
+    }
+    return RC_SUCCESS;
+}
+
+/**
+ * Append a value to a sparkline.
+ *
+ * @param w     Handle of a sparkline (IN).
+ * @param value New value (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no sparkline.
+ */
+RC_t ui_sparkline_push(ui_widget_t w, uint16_t value)
+{
+    ui_data_t *d = ui_get(w, UI_SPARKLINE);
+    ui_spark_t *s;
+
+    if (d == NULL) {
+        return RC_ERROR_BAD_PARAM;
+    }
+
+    s = &sparks[d->spark];
+    if (s->count == CFG_UI_SPARK_POINTS) {
+        memmove(&s->value[0], &s->value[1], (CFG_UI_SPARK_POINTS - 1) * sizeof(s->value[0]));
+        s->count--;
+    }
+    s->value[s->count++] = (value > d->max) ? d->max : value;
+    d->dirty = TRUE;
+    return RC_SUCCESS;
+}
+
+/**
+ * Force a full repaint of a widget on the next ui_render().
+ *
+ * @param w Handle of the widget (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no widget.
+ */
+RC_t ui_invalidate(ui_widget_t w)
+{
+    if ((w >= CFG_UI_WIDGETS) || (widgets[w].kind == UI_UNUSED)) {
+        return RC_ERROR_BAD_PARAM;
+    }
+
+    widgets[w].dirty = widgets[w].full = TRUE;
+    return RC_SUCCESS;
+}
+
+/**
+ * Force a full repaint of all widgets overlapping an area.
+ *
+ * @param x Left edge in pixels (IN).
+ * @param y Top edge in pixels (IN).
+ * @param w Width in pixels (IN).
+ * @param h Height in pixels (IN).
+ */
+void ui_invalidateArea(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    for (ui_widget_t i = 0; i < CFG_UI_WIDGETS; i++) {
+        ui_data_t *d = &widgets[i];
+
+        if ((d->kind != UI_UNUSED) &&
+            (d->x < x + w) && (x < d->x + d->w) &&
+            (d->y < y + h) && (y < d->y + d->h)) {
+            d->dirty = d->full = TRUE;
+        }
+    }
+}
+
+/**
+ * Repaint all dirty widgets in one pass.
+ *
+ * @return Number of widgets which were repainted.
+ */
+uint8_t ui_render(void)
+{
+    uint8_t painted = 0;
+
+    for (ui_widget_t i = 0; i < CFG_UI_WIDGETS; i++) {
+        ui_data_t *d = &widgets[i];
+
+        if ((d->kind == UI_UNUSED) || !d->dirty) {
+            continue;
+        }
+
+        switch (d->kind) {
+            case UI_LABEL:
+            case UI_NUMBER:
+                if (d->full) {
+                    TFT_field_invalidate(d->field);
+                }
+                (void)TFT_field_set(d->field, d->text);
+                break;
+            case UI_BAR:
+                ui_render_bar(d);
+                break;
+            case UI_SPARKLINE:
+                ui_render_sparkline(d);
+                break;
+            default:
+                break;
+        }
+        d->dirty = d->full = FALSE;
+        painted++;
+    }
+    return painted;
+}
+
+/* [ui.c] END OF FILE */
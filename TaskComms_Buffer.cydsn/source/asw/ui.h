@@ -0,0 +1,210 @@
+/* ========================================
+ *
+ * \file ui.h
+ * \author V.S. Agilan
+ * \date 21.01.26
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "global.h"
+#include "tft.h"
+
+#ifndef UI_H
+#define UI_H
+
+/* ========================================
+ *  Configuration
+ * ========================================
+ */
+
+/** Size of the static widget array. */
+#define CFG_UI_WIDGETS          24
+/** Sparklines which can exist at the same time, each keeps its own history. */
+#define CFG_UI_SPARKLINES       2
+/** Values shown by one sparkline, the oldest one is dropped first. */
+#define CFG_UI_SPARK_POINTS     32
+/** Maximum length of a label or number in characters (<= CFG_TFT_FIELD_LEN). */
+#define CFG_UI_TEXT_LEN         CFG_TFT_FIELD_LEN
+
+/* ========================================
+ *  Widgets
+ * ========================================
+ */
+
+/**
+ * Handle of a widget.
+ *
+ * Index into the static widget array, returned by the ui_*_create() functions.
+ */
+typedef uint8_t ui_widget_t;
+
+/** No widget, returned if the widget array or the TFT text fields are used up. */
+#define UI_WIDGET_NONE  0xFF
+
+/**
+ * Widget types.
+ */
+typedef enum {
+    UI_UNUSED,      /**< Free entry of the widget array. */
+    UI_LABEL,       /**< Text in a TFT text field. */
+    UI_NUMBER,      /**< Right aligned decimal number in a TFT text field. */
+    UI_BAR,         /**< Horizontal bar graph. */
+    UI_SPARKLINE    /**< Line chart of the last CFG_UI_SPARK_POINTS values. */
+} ui_kind_t;
+
+/**
+ * Initialize the widget layer and drop all widgets.
+ *
+ * Must follow TFT_init(). The TFT text fields of earlier widgets stay
+ * allocated, so this is meant to be called once at startup.
+ */
+void ui_init(void);
+
+/**
+ * Create a text label in the classic font.
+ *
+ * Colors and text size are taken from the current TFT text settings.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param len Width in characters (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or text field is left.
+ */
+ui_widget_t ui_label_create(int16_t x, int16_t y, uint8_t len);
+
+/**
+ * Create a right aligned decimal number in the classic font.
+ *
+ * Colors and text size are taken from the current TFT text settings. The
+ * number is blank until the first ui_number_set().
+ *
+ * @param x      Left edge in pixels (IN).
+ * @param y      Top edge in pixels (IN).
+ * @param digits Width in characters including the sign (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or text field is left.
+ */
+ui_widget_t ui_number_create(int16_t x, int16_t y, uint8_t digits);
+
+/**
+ * Create a horizontal bar graph which fills from the left.
+ *
+ * The bar is drawn in the current TFT foreground color on the background color.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param w   Width in pixels (IN).
+ * @param h   Height in pixels (IN).
+ * @param max Value of a full bar, larger values are clamped (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget is left.
+ */
+ui_widget_t ui_bar_create(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t max);
+
+/**
+ * Create a sparkline, a line chart of the last CFG_UI_SPARK_POINTS values.
+ *
+ * The line is drawn in the current TFT foreground color on the background color.
+ *
+ * @param x   Left edge in pixels (IN).
+ * @param y   Top edge in pixels (IN).
+ * @param w   Width in pixels (IN).
+ * @param h   Height in pixels (IN).
+ * @param max Value at the top edge, larger values are clamped (IN).
+ * @return Handle of the widget, UI_WIDGET_NONE if no widget or sparkline history is left.
+ */
+ui_widget_t ui_sparkline_create(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t max);
+
+/**
+ * Set the text of a label.
+ *
+ * Marks the label dirty only if the text differs from the current one.
+ *
+ * @param w    Handle of a label (IN).
+ * @param text Zero terminated text, cut to the width of the label (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no label, RC_ERROR_NULL if text is NULL.
+ */
+RC_t ui_label_set(ui_widget_t w, const char *text);
+
+/**
+ * Set the value of a number.
+ *
+ * Marks the number dirty only if the value or the blank state changes.
+ *
+ * @param w     Handle of a number (IN).
+ * @param value Value to show, too many digits are shown as '#' (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no number.
+ */
+RC_t ui_number_set(ui_widget_t w, int32_t value);
+
+/**
+ * Blank a number.
+ *
+ * @param w Handle of a number (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no number.
+ */
+RC_t ui_number_clear(ui_widget_t w);
+
+/**
+ * Set the value of a bar graph.
+ *
+ * Marks the bar dirty only if the filled width changes.
+ *
+ * @param w     Handle of a bar graph (IN).
+ * @param value New value, clamped to the maximum of the bar (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no bar graph.
+ */
+RC_t ui_bar_set(ui_widget_t w, uint16_t value);
+
+/**
+ * Append a value to a sparkline.
+ *
+ * Once the sparkline is full the oldest value is dropped and the line
+ * scrolls left by one point.
+ *
+ * @param w     Handle of a sparkline (IN).
+ * @param value New value, clamped to the maximum of the sparkline (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no sparkline.
+ */
+RC_t ui_sparkline_push(ui_widget_t w, uint16_t value);
+
+/**
+ * Force a full repaint of a widget on the next ui_render().
+ *
+ * @param w Handle of the widget (IN).
+ * @return RC_SUCCESS, RC_ERROR_BAD_PARAM if w is no widget.
+ */
+RC_t ui_invalidate(ui_widget_t w);
+
+/**
+ * Force a full repaint of all widgets overlapping an area, e.g. after
+ * something else was drawn there.
+ *
+ * @param x Left edge in pixels (IN).
+ * @param y Top edge in pixels (IN).
+ * @param w Width in pixels (IN).
+ * @param h Height in pixels (IN).
+ */
+void ui_invalidateArea(int16_t x, int16_t y, int16_t w, int16_t h);
+
+/**
+ * Repaint all dirty widgets in one pass.
+ *
+ * Text widgets redraw their changed characters, bar graphs the part between
+ * the old and the new filled width and sparklines the segments whose end
+ * points moved. Invalidated widgets are repainted completely.
+ *
+ * @return Number of widgets which were repainted.
+ */
+uint8_t ui_render(void);
+
+#endif
+
+/* [ui.h] END OF FILE */
\ No newline at end of file
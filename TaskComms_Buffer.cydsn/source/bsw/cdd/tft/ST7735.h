@@ -44,8 +44,10 @@ typedef enum{
     ST7735_RAMWR   =0x2C,
     ST7735_RAMRD   =0x2E,
     ST7735_PTLAR   =0x30,
+    ST7735_SCRLAR  =0x33,
     ST7735_COLMOD  =0x3A,
     ST7735_MADCTL  =0x36,
+    ST7735_VSCSAD  =0x37,
     ST7735_FRMCTR1 =0xB1,
     ST7735_FRMCTR2 =0xB2,
     ST7735_FRMCTR3 =0xB3,
@@ -0,0 +1,70 @@
+// FreeSans18pt7b subset " +-.0123456789:", run length coded (TFT_FONT_RLE)
+// Generated by host/tools/fontsubset, do not edit
+
+const uint8_t FreeSans18pt7bDigitsBitmaps[] PROGMEM = {
+  0x72, 0xE2, 0xE2, 0xE2, 0xE2, 0xE2, 0x7F, 0x0F, 0x0F, 0x03, 0x72, 0xE2,
+  0xE2, 0xE2, 0xE2, 0xE2, 0xE2, 0x00, 0x0F, 0x09, 0x0C, 0x56, 0x99, 0x6B,
+  0x44, 0x44, 0x34, 0x64, 0x23, 0x83, 0x23, 0x83, 0x13, 0xA6, 0xA6, 0xA6,
+  0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0x94, 0x13, 0x83, 0x23, 0x83,
+  0x24, 0x64, 0x34, 0x44, 0x5A, 0x69, 0x96, 0x00, 0x62, 0x62, 0x53, 0x44,
+  0x2F, 0x07, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53,
+  0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x53, 0x56, 0x8A, 0x5C, 0x35,
+  0x45, 0x23, 0x88, 0x87, 0xA6, 0xA3, 0xD3, 0xD3, 0xC4, 0xB4, 0xB4, 0xA5,
+  0x96, 0x95, 0x95, 0xA4, 0xC3, 0xC3, 0xD2, 0xD3, 0xDF, 0x0F, 0x0F, 0x03,
+  0x57, 0x9A, 0x6C, 0x44, 0x54, 0x43, 0x74, 0x23, 0x93, 0x23, 0x93, 0x23,
+  0x93, 0xE3, 0xC4, 0x97, 0xA6, 0xB8, 0xE4, 0xE4, 0xE3, 0xE6, 0xB6, 0xB7,
+  0xA3, 0x13, 0x93, 0x25, 0x55, 0x3D, 0x5B, 0x87, 0x00, 0xA3, 0xD3, 0xC4,
+  0xB5, 0xB5, 0xA6, 0x93, 0x13, 0x92, 0x23, 0x83, 0x23, 0x73, 0x33, 0x63,
+  0x43, 0x62, 0x53, 0x53, 0x53, 0x43, 0x63, 0x42, 0x73, 0x33, 0x73, 0x3F,
+  0x0F, 0x0F, 0x03, 0xA3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0x00, 0x3D, 0x4D,
+  0x3E, 0x33, 0xE3, 0xE3, 0xE3, 0xE3, 0xE3, 0x25, 0x6D, 0x4E, 0x35, 0x55,
+  0x23, 0x84, 0xE4, 0xE3, 0xE3, 0xE3, 0xE3, 0xE6, 0xA3, 0x14, 0x93, 0x24,
+  0x64, 0x4D, 0x5B, 0x86, 0x00, 0x65, 0x99, 0x6B, 0x44, 0x54, 0x33, 0x73,
+  0x23, 0x83, 0x23, 0xD2, 0xD3, 0xD3, 0x35, 0x53, 0x19, 0x3E, 0x26, 0x45,
+  0x14, 0x83, 0x14, 0x87, 0xA6, 0xA6, 0xA3, 0x12, 0xA3, 0x13, 0x84, 0x13,
+  0x83, 0x34, 0x45, 0x3C, 0x5A, 0x86, 0x00, 0x0F, 0x0F, 0x0F, 0x03, 0xD2,
+  0xD3, 0xC3, 0xD2, 0xD3, 0xC3, 0xD2, 0xD3, 0xD2, 0xD3, 0xD2, 0xD3, 0xD3,
+  0xC3, 0xD3, 0xD3, 0xC3, 0xD3, 0xD3, 0xD2, 0xD3, 0xD3, 0x00, 0x57, 0x8B,
+  0x5D, 0x44, 0x54, 0x34, 0x74, 0x23, 0x93, 0x23, 0x93, 0x23, 0x93, 0x24,
+  0x74, 0x34, 0x54, 0x5B, 0x79, 0x6D, 0x35, 0x55, 0x23, 0x93, 0x13, 0xA7,
+  0xB6, 0xB6, 0xB6, 0xA4, 0x13, 0x93, 0x25, 0x55, 0x3D, 0x5B, 0x87, 0x00,
+  0x56, 0x8A, 0x5C, 0x35, 0x44, 0x33, 0x83, 0x14, 0x83, 0x13, 0xA2, 0x13,
+  0xA6, 0xA6, 0xA6, 0x94, 0x13, 0x84, 0x14, 0x56, 0x2E, 0x39, 0x13, 0x55,
+  0x33, 0xD3, 0xD2, 0xD3, 0x23, 0x83, 0x23, 0x73, 0x34, 0x54, 0x4B, 0x69,
+  0x95, 0x00, 0x0C, 0xF0, 0xF0, 0x3C };
+
+const GFXglyph FreeSans18pt7bDigitsGlyphs[] PROGMEM = {
+  {     0,   0,   0,   9,    0,    1 },   // 0x20 ' '
+  {     0,   0,   0,  12,    0,    0 },   // 0x21 '!' (not in subset)
+  {     0,   0,   0,  12,    0,    0 },   // 0x22 '"' (not in subset)
+  {     0,   0,   0,  19,    0,    0 },   // 0x23 '#' (not in subset)
+  {     0,   0,   0,  19,    0,    0 },   // 0x24 '$' (not in subset)
+  {     0,   0,   0,  31,    0,    0 },   // 0x25 '%' (not in subset)
+  {     0,   0,   0,  23,    0,    0 },   // 0x26 '&' (not in subset)
+  {     0,   0,   0,   7,    0,    0 },   // 0x27 ''' (not in subset)
+  {     0,   0,   0,  12,    0,    0 },   // 0x28 '(' (not in subset)
+  {     0,   0,   0,  12,    0,    0 },   // 0x29 ')' (not in subset)
+  {     0,   0,   0,  14,    0,    0 },   // 0x2A '*' (not in subset)
+  {     0,  16,  16,  20,    2,  -15 },   // 0x2B '+'
+  {    18,   0,   0,  10,    0,    0 },   // 0x2C ',' (not in subset)
+  {    18,   8,   3,  12,    2,  -10 },   // 0x2D '-'
+  {    20,   3,   4,   9,    3,   -3 },   // 0x2E '.'
+  {    21,   0,   0,  10,    0,    0 },   // 0x2F '/' (not in subset)
+  {    21,  16,  25,  19,    2,  -24 },   // 0x30 '0'
+  {    56,   8,  25,  19,    4,  -24 },   // 0x31 '1'
+  {    80,  16,  25,  19,    2,  -24 },   // 0x32 '2'
+  {   108,  17,  25,  19,    1,  -24 },   // 0x33 '3'
+  {   141,  16,  25,  19,    1,  -24 },   // 0x34 '4'
+  {   178,  17,  25,  19,    1,  -24 },   // 0x35 '5'
+  {   209,  16,  25,  19,    2,  -24 },   // 0x36 '6'
+  {   247,  16,  25,  19,    2,  -24 },   // 0x37 '7'
+  {   274,  17,  25,  19,    1,  -24 },   // 0x38 '8'
+  {   312,  16,  25,  19,    1,  -24 },   // 0x39 '9'
+  {   350,   3,  19,   9,    3,  -18 } }; // 0x3A ':'
+
+const GFXfont FreeSans18pt7bDigits PROGMEM = {
+  (uint8_t  *)FreeSans18pt7bDigitsBitmaps,
+  (GFXglyph *)FreeSans18pt7bDigitsGlyphs,
+  0x20, 0x3A, 42, TFT_FONT_RLE };
+
+// Approx. 550 bytes
@@ -17,6 +17,8 @@
  * This prototype is for research purposes only. This software is provided "AS IS," without a warranty of any kind.
  */
 
+#include <stdint.h>
+#include <string.h>
 #include "tft.h"
 #include "ST7735.h"
 #include "glcdfont.h"
@@ -38,6 +40,12 @@
 // API glue for the Pins
 #define MODULE_DC(x)        PPCAT(CFG_TFT_DC_PIN, x)      
 #define MODULE_RES(x)       PPCAT(CFG_TFT_RES_PIN, x)  
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+#define MODULE_TXISR(x)     PPCAT(CFG_TFT_TX_ISR_MODULE, x)
+#endif
+#if (CFG_TFT_DMA == ON)
+#define MODULE_DMA(x)       PPCAT(CFG_TFT_DMA_MODULE, x)
+#endif
 #define TFT_DC_LOW          MODULE_DC(Write)(0)     /**< \brief Macro to set the DC(A0) pin LOW*/
 #define TFT_DC_HIGH         MODULE_DC(Write)(1)     /**< \brief Macro to set the DC(A0) pin HIGH*/
 #define TFT_RES_LOW         MODULE_RES(Write)(0)    /**< \brief Macro to set the Reset pin LOW*/
@@ -69,10 +77,71 @@
  #define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
 #endif
 
+#define TFT_REC_CMD                 0x80        /**< \brief Record header of a command, the lower bits hold the number of arguments*/
+#define TFT_REC_ARGS                0x3F        /**< \brief Most arguments of a command record*/
+#define TFT_REC_RUN                 0x80        /**< \brief Longest data run, its header holds length - 1*/
+#define TFT_REC_REP                 0xC0        /**< \brief Record header of a repeated pixel, followed by the color and the pixel count*/
+#define TFT_REC_REP_SZ              5           /**< \brief Bytes of a repeat record*/
+#define TFT_REC_REP_MAX             0xFFFF      /**< \brief Most pixels of a repeat record*/
+#define TFT_RB_NONE                 0xFFFF      /**< \brief No record*/
+
 #define TFT_write_cmd(x)            TFT_send(TFT_CMD,x)
 #define TFT_write_data(x)           TFT_send(TFT_DATA,x)
 #define TFT_write_stream(x)         TFT_send(TFT_STREAM,x)
 
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+// Leave the ISR, it runs again once one of the given TX status bits is set
+#define TFT_TX_WAIT(sts)            { MODULE_SPI(SetTxInterruptMode)(sts); return; }
+#else
+// No interrupt, poll the TX status
+#define TFT_TX_WAIT(sts)            continue
+#endif
+
+#if (CFG_TFT_GLYPH_CACHE == ON)
+#define TFT_GLYPH_BLOCK_SZ          (6 * 8 * 2)                                         /**< \brief Bytes of an expanded 1x glyph, allocation unit of the glyph cache*/
+#define TFT_GLYPH_BLOCKS            (CFG_TFT_GLYPH_CACHE_BYTES / TFT_GLYPH_BLOCK_SZ)    /**< \brief Number of blocks, a glyph of size s takes s*s of them*/
+#define TFT_GLYPH_NONE              0xFF                                                /**< \brief End of a block chain*/
+
+#if (TFT_GLYPH_BLOCKS < 1) || (TFT_GLYPH_BLOCKS >= TFT_GLYPH_NONE)
+#error "CFG_TFT_GLYPH_CACHE_BYTES has to hold 1..254 glyphs of size 1"
+#endif
+#endif
+
+#if (CFG_TFT_DMA == ON)
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+#error "CFG_TFT_DMA and CFG_TFT_SPI_TX_IRQ both need the tx_interrupt of the SPI"
+#endif
+#define TFT_DMA_TD_MAX              4094                                                /**< \brief Bytes per TD, the count has 12 bits, kept even for whole pixels*/
+#define TFT_DMA_ADDR(p)             ((uint32_t)(uintptr_t)(p))                          /**< \brief Bus address of a RAM buffer*/
+#endif
+
+#if (CFG_TFT_TX_BLOCKING == ON) && (CFG_TFT_SPI_TX_IRQ == OFF)
+#error "CFG_TFT_TX_BLOCKING needs CFG_TFT_SPI_TX_IRQ"
+#endif
+
+#if (CFG_TFT_SHAPE_SPANS == ON)
+#define TFT_SIDE_NEG                0x1     /**< \brief Run left of (above) the center of a mirrored pair*/
+#define TFT_SIDE_POS                0x2     /**< \brief Run right of (below) the center of a mirrored pair*/
+#define TFT_SIDE_BOTH               (TFT_SIDE_NEG | TFT_SIDE_POS)
+#define TFT_SIDES(c, neg, pos)      ((((c) & (neg)) ? TFT_SIDE_NEG : 0) | (((c) & (pos)) ? TFT_SIDE_POS : 0))  /**< \brief Sides of the corners neg and pos in cornername c*/
+#define TFT_WINDOW_NONE             0xFF    /**< \brief Address of the controller not known*/
+#endif
+
+#if (CFG_TFT_STRIP == ON)
+#define TFT_STRIP_W                 ((CFG_TFT_WIDTH > CFG_TFT_HEIGHT) ? CFG_TFT_WIDTH : CFG_TFT_HEIGHT)   /**< \brief Longest line of all rotations*/
+#define TFT_STRIPS                  ((TFT_STRIP_W + CFG_TFT_STRIP_LINES - 1) / CFG_TFT_STRIP_LINES)       /**< \brief Strips of the tallest rotation*/
+#define TFT_STRIP_LINE_SZ           ((TFT_STRIP_W * CFG_TFT_STRIP_BPP + 7) / 8)                         /**< \brief Bytes of a strip line*/
+#if (CFG_TFT_STRIP_BPP == 8)
+#define TFT_PALETTE_SZ              256                                                                 /**< \brief Colors of a strip palette*/
+#define TFT_STRIP_INDEX(l, px)      ((l)[px])                                                           /**< \brief Palette index of pixel px of strip line l*/
+#elif (CFG_TFT_STRIP_BPP == 4)
+#define TFT_PALETTE_SZ              16
+#define TFT_STRIP_INDEX(l, px)      (((l)[(px) >> 1] >> (((px) & 1) ? 0 : 4)) & 0x0F)
+#elif (CFG_TFT_STRIP_BPP != 16)
+#error "CFG_TFT_STRIP_BPP must be 16, 8 or 4"
+#endif
+#endif
+
 //-------------------------------------[types]
 /**
 * \brief Data send to the TFT is either DATA or COMMAND data.
@@ -80,28 +149,263 @@
 typedef enum{
     TFT_CMD,                        /**< Payload is command. */
     TFT_DATA,                       /**< Payload is data */
-    TFT_STREAM                      /**< D/C has already been set */
+    TFT_STREAM                      /**< Payload is pixel data, sent like #TFT_DATA */
 }TFT_payload_t;
 
 /**
-* \brief Outgoing data to the tft
+* \brief Outgoing data to the tft, packed records of variable length
+*
+* A record starts with a header byte:
+* - [#TFT_REC_CMD | nargs][cmd][args...]: command (D/C low) and its arguments (D/C high)
+* - [length - 1][bytes...]: data run (D/C high) of up to #TFT_REC_RUN bytes
+* - [#TFT_REC_REP][color hi][color lo][count lo][count hi]: pixel repeated count
+*   times (D/C high), expanded by the TX service
+*
+* D/C only changes at record boundaries and after the command byte. The last
+* record is extended by bytes of the same kind as long as it is not sent
+* completely, even if its header has already been read by the TX service.
 */
-typedef struct{
-    TFT_payload_t   DC;             /**< Determines if this is a a command (#TFT_CMD) or data (#TFT_DATA) */
-    uint8_t         payload;
-}TFT_data_t;
-
 typedef struct {
-    uint16_t    read;
-    uint16_t    write;
-    uint16_t    fill;
-    TFT_data_t  buffer[CFG_TFT_RB_OUT_SZ];
+    uint16_t    read;               /**< Next byte to send */
+    uint16_t    write;              /**< Next free byte */
+    volatile uint16_t fill;         /**< Bytes incl. headers, changed by the TX interrupt with #CFG_TFT_SPI_TX_IRQ */
+    uint16_t    last;               /**< Header of the last record */
+    uint8_t     lastHdr;            /**< Copy of the last header, the TX service may have read it */
+    uint16_t    rdHdr;              /**< Header of the record being sent while it is the last one, else #TFT_RB_NONE */
+    uint8_t     rdLeft;             /**< Arguments or data bytes left of the record being sent */
+    boolean_t   rdCmd;              /**< The command byte of the record being sent is next */
+    uint32_t    rdRep;              /**< Bytes left of the repeat record being expanded */
+    TFT_color_t rdColor;            /**< Color of the repeat record being expanded */
+    uint8_t     dc;                 /**< Level of the D/C pin, 0xFF = unknown */
+    uint32_t    isrCalls;           /**< Runs of the TX service routine */
+#if (CFG_TFT_TX_BLOCKING == ON)
+    volatile boolean_t waiting;     /**< #CFG_TFT_TX_TASK waits for #CFG_TFT_TX_EVENT */
+#endif
+    uint32_t    waits;              /**< Producer waited for room */
+    uint8_t     buffer[CFG_TFT_RB_OUT_SZ];
 }TFT_RB_out_t;
 
+#if (CFG_TFT_DMA == ON)
+/**
+* \brief DMA channel feeding the SPI TX FIFO
+*/
+typedef struct{
+    boolean_t           ready;                          /**< Channel and TDs allocated */
+    uint8_t             ch;                             /**< Channel of #CFG_TFT_DMA_MODULE */
+    uint8_t             td[CFG_TFT_DMA_TDS];            /**< TDs of a chain */
+    volatile boolean_t  busy;                           /**< Chain running, cleared by the nrq */
+    volatile boolean_t  sleeping;                       /**< #CFG_TFT_DMA_TASK waits for #CFG_TFT_DMA_EVENT */
+    uint32_t            count;                          /**< Started chains */
+    boolean_t           fillValid;                      /**< pattern holds fillColor */
+    TFT_color_t         fillColor;
+    uint8_t             pattern[CFG_TFT_DMA_FILL_PX * 2];   /**< Source of fills, SPI byte order */
+}TFT_dma_t;
+#endif
+
+#if (CFG_TFT_GLYPH_CACHE == ON)
+/**
+* \brief Cached glyph, the expanded pixels are spread over a chain of blocks
+*/
+typedef struct{
+    uint32_t        used;           /**< LRU stamp, 0 = entry is free */
+    TFT_color_t     color;          /**< Foreground color the glyph was expanded with */
+    TFT_color_t     bg;             /**< Background color the glyph was expanded with */
+    unsigned char   c;              /**< Character */
+    uint8_t         size;           /**< Text size */
+    uint8_t         block;          /**< First block of the chain */
+}TFT_glyph_t;
+
+/**
+* \brief Glyph cache of the classic font, row-major RGB565 in SPI byte order
+*/
+typedef struct{
+    uint32_t    clock;                                      /**< LRU time, advances per lookup */
+    uint32_t    hits;
+    uint32_t    misses;
+    uint8_t     free;                                       /**< Head of the free block chain */
+    uint8_t     freeCnt;                                    /**< Number of free blocks */
+    uint8_t     next[TFT_GLYPH_BLOCKS];                     /**< Next block of the same chain */
+    TFT_glyph_t entry[TFT_GLYPH_BLOCKS];                    /**< A glyph takes at least one block */
+    uint8_t     pool[TFT_GLYPH_BLOCKS][TFT_GLYPH_BLOCK_SZ];
+}TFT_glyph_cache_t;
+#endif
+
+/**
+* \brief Text field, remembers the shown characters
+*/
+typedef struct{
+    int16_t         x, y;           /**< Top left (classic font) or baseline (custom font) */
+    const GFXfont  *font;           /**< NULL = classic font */
+    TFT_color_t     color;
+    TFT_color_t     bg;
+    uint8_t         size;           /**< Text size */
+    uint8_t         len;            /**< Width in characters, 0 = field unused */
+    uint8_t         pitch;          /**< Cell width in pixels */
+    int8_t          top;            /**< Custom font: top of the cells relative to the baseline (unscaled) */
+    uint8_t         height;         /**< Custom font: cell height (unscaled) */
+    boolean_t       valid;          /**< shown matches the screen */
+    char            shown[CFG_TFT_FIELD_LEN];
+}TFT_field_data_t;
+
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+/**
+* \brief Measured string, the bounds are relative to the start position and unwrapped
+*/
+typedef struct{
+    uint32_t        hash;           /**< FNV-1a of the string, 0 = entry is free */
+    const GFXfont  *font;           /**< NULL = classic font */
+    uint8_t         size;           /**< Text size */
+    uint8_t         len;            /**< String length */
+    char            text[CFG_TFT_BOUNDS_LEN];   /**< String without terminator, compared on a hash match */
+    int16_t         minx, miny;     /**< Upper left pixel */
+    int16_t         maxx, maxy;     /**< Lower right pixel, maxx + 1 is the right edge the wrap check sees. Empty glyphs give maxx < minx, no glyph at all INT16_MIN */
+}TFT_bounds_t;
+
+/**
+* \brief Cache of #TFT_getTextBounds, entries are replaced round robin
+*/
+typedef struct{
+    uint8_t         next;           /**< Entry replaced by the next miss */
+    uint32_t        hits;
+    uint32_t        misses;
+    TFT_bounds_t    entry[CFG_TFT_BOUNDS_CACHE];
+}TFT_bounds_cache_t;
+#endif
+
+/**
+* \brief Advances of the digits and the minus sign of one font
+*/
+typedef struct{
+    const GFXfont  *font;           /**< Font of the table, NULL = classic font */
+    boolean_t       valid;
+    uint8_t         digit[10];      /**< xAdvance of '0'..'9' (unscaled), 0 = not in the font */
+    uint8_t         minus;          /**< xAdvance of '-' (unscaled) */
+    uint8_t         widest;         /**< Largest digit advance (unscaled) */
+    boolean_t       tabular;        /**< All digits advance by widest */
+}TFT_advance_t;
+
+#if (CFG_TFT_STRIP == ON)
+/**
+* \brief Primitive recorded by the strip renderer
+*/
+typedef enum{
+    TFT_PRIM_FILL,                  /**< Solid rectangle */
+    TFT_PRIM_CHAR,                  /**< Classic font character */
+    TFT_PRIM_GLYPH                  /**< Custom font glyph, transparent */
+}TFT_prim_t;
+
+/**
+* \brief Dirty rectangle and the primitive which paints it
+*/
+typedef struct{
+    int16_t         x, y, w, h;     /**< Dirty rectangle, clipped to the screen */
+    int16_t         ox, oy;         /**< Unclipped origin of the character cell or glyph box */
+    TFT_color_t     color;
+    TFT_color_t     bg;             /**< Classic font only, equal to color = transparent */
+    const GFXfont  *font;           /**< Font of a glyph */
+    uint8_t         prim;           /**< See #TFT_prim_t */
+    uint8_t         c;              /**< Character */
+    uint8_t         size;           /**< Text size */
+#if (CFG_TFT_STRIP_BPP < 16)
+    uint8_t         ci, bi;         /**< Palette indices of color and bg */
+#endif
+}TFT_dirty_t;
+
+/**
+* \brief Strip renderer state, one strip of pixels in SPI byte order and its coverage
+*/
+typedef struct{
+    boolean_t   open;                                           /**< Frame is being recorded */
+#if (CFG_TFT_STRIP_SKIP == ON)
+    boolean_t   hashValid;                                      /**< No immediate drawing since the last frame */
+    uint32_t    hash[TFT_STRIPS];                               /**< Content of fully drawn strips, 0 = unknown */
+#endif
+    uint8_t     cnt;                                            /**< Recorded primitives */
+    TFT_dirty_t rect[CFG_TFT_STRIP_CMDS];
+    uint8_t     mask[CFG_TFT_STRIP_LINES][(TFT_STRIP_W + 7) / 8];   /**< Pixels written by the primitives */
+#if (CFG_TFT_STRIP_BPP < 16)
+    uint16_t    colors;                                         /**< Used palette entries */
+    TFT_color_t palette[TFT_PALETTE_SZ];                        /**< RGB565 of the pixel indices */
+    uint8_t     line[TFT_STRIP_W * 2];                          /**< Line expanded to RGB565 for the SPI */
+#endif
+    uint8_t     buf[CFG_TFT_STRIP_LINES][TFT_STRIP_LINE_SZ];    /**< RGB565 in SPI byte order or palette indices */
+}TFT_strip_t;
+#endif
+
+#if (CFG_TFT_SHAPE_SPANS == ON)
+/**
+* \brief Rows with the same columns, collected until a row differs
+*/
+typedef struct{
+    int16_t     x0, x1;             /**< Columns */
+    int16_t     y0, y1;             /**< First and last row, y1 < y0 = empty */
+}TFT_span_t;
+#endif
+
+#if (CFG_TFT_QUEUE == ON)
+/**
+* \brief Commands of the draw queue
+*/
+typedef enum{
+    TFT_QUEUE_FILL,
+    TFT_QUEUE_TEXT,
+    TFT_QUEUE_NUMBER
+}TFT_queue_kind_t;
+
+/**
+* \brief Queued draw command with its arguments
+*/
+typedef struct{
+    uint8_t         kind;           /**< See #TFT_queue_kind_t */
+    uint8_t         size;           /**< Text size */
+    uint8_t         len;            /**< Characters of a text or number */
+    boolean_t       drop;           /**< Covered by a later command of the batch */
+    int16_t         x, y, w, h;     /**< Box on the screen */
+    TFT_color_t     color;
+    TFT_color_t     bg;             /**< Text only, equal to color = transparent */
+    union{
+        char        text[CFG_TFT_QUEUE_TEXT];
+        int32_t     value;
+    }arg;
+}TFT_queue_cmd_t;
+
+/**
+* \brief Draw queue, producers fill free entries, the render task drains whole batches
+*/
+typedef struct{
+    uint8_t         read;
+    uint8_t         write;
+    uint8_t         fill;
+    uint32_t        drawn;
+    uint32_t        dropped;
+    TFT_queue_cmd_t cmd[CFG_TFT_QUEUE_CMDS];
+}TFT_queue_t;
+#endif
+
+#if (CFG_TFT_CONSOLE == ON)
+/**
+* \brief Console band, the lines live in fixed slots of the frame memory and the scroll start rotates through them
+*/
+typedef struct{
+    boolean_t   active;
+    uint8_t     top;                /**< First row of the band */
+    uint8_t     lines;              /**< Slots in the band */
+    uint8_t     height;             /**< Rows per slot */
+    uint8_t     used;               /**< Slots written since the start */
+    uint8_t     first;              /**< Slot shown at the top of the band once all are used */
+    uint8_t     size;               /**< Text size */
+    uint8_t     rows;               /**< Rows cleared by #TFT_console_stop */
+    TFT_color_t color;
+    TFT_color_t bg;
+}TFT_console_t;
+#endif
+
 
 //-------------------------------------[local variables]
 
+#if (CFG_TFT_SPI_TX_IRQ == OFF)
 static const char* TAG="TFT";
+#endif
 
 static uint8_t  colstart;           /**< \brief Column (RAM) start*/
 static uint8_t  rowstart;           /**< \brief Row (RAM) start*/
@@ -123,71 +427,565 @@ static boolean_t wrap;              /**< \brief If set, 'wrap' text at right edg
 static GFXfont *gfxFont;            /**< \brief Current Font*/ 
 
 static TFT_RB_out_t TFT_RB_out;     /**< \brief Ringbuffer for SPI communication*/
+
+#if (CFG_TFT_SHAPE_SPANS == ON)
+static uint8_t  window[4];          /**< \brief Last CASET and RASET addresses (x0, x1, y0, y1), #TFT_WINDOW_NONE = unknown*/
+#endif
+
+#if (CFG_TFT_DMA == ON)
+static TFT_dma_t dma;               /**< \brief DMA channel of the SPI*/
+#endif
+
+#if (CFG_TFT_GLYPH_CACHE == ON)
+static TFT_glyph_cache_t glyphCache;    /**< \brief Expanded glyphs of the classic font*/
+#endif
+
+#if (CFG_TFT_STRIP == ON)
+static TFT_strip_t strip;           /**< \brief Strip renderer*/
+#endif
+
+static TFT_field_data_t fields[CFG_TFT_FIELDS];     /**< \brief Text fields*/
+
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+static TFT_bounds_cache_t boundsCache;              /**< \brief Measured strings*/
+#endif
+static TFT_advance_t advance;                       /**< \brief Digit advances of the last measured font*/
+
+#if (CFG_TFT_CONSOLE == ON)
+static TFT_console_t console;                       /**< \brief Console mode*/
+#endif
+
+#if (CFG_TFT_QUEUE == ON)
+static TFT_queue_t queue;                           /**< \brief Draw commands of other tasks*/
+#endif
+
+static TFT_color_t blit[CFG_TFT_BLIT_PX];           /**< \brief Bitmap pixels in SPI byte order*/
     
 //-------------------------------------[local function prototypes]
 
 static void setAddrWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
 static void charBounds(char c, int16_t *x, int16_t *y,  int16_t *minx, int16_t *miny, int16_t *maxx, int16_t *maxy);
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+static TFT_bounds_t* boundsCacheGet(const char *str);
+#endif
+static const TFT_advance_t* advanceTable(void);
 static void TFT_drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, TFT_color_t color);
 static void TFT_fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, TFT_color_t color);
 
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+static void TFT_rb_wait(uint8_t *irq, uint16_t need);
+#endif
 static RC_t TFT_send(TFT_payload_t type, uint8_t payload);
+static void TFT_send_block(const uint8_t *data, uint16_t len);
+static void TFT_send_repeat(TFT_color_t color, uint32_t px);
+#if (CFG_TFT_DMA == ON)
+static void dmaWait(void);
+static boolean_t dmaReachable(const uint8_t *data, uint32_t len);
+static void dmaStream(const uint8_t *data, uint16_t len);
+static void dmaFill(TFT_color_t color, uint32_t px);
+#endif
+#if (CFG_TFT_GLYPH_CACHE == ON)
+static TFT_glyph_t* glyphCacheGet(unsigned char c, TFT_color_t color, TFT_color_t bg, uint8_t size);
+static void glyphCacheRelease(TFT_glyph_t *g);
+#endif
+#if (CFG_TFT_GFX_SPANS == ON) || (CFG_TFT_FONT_RLE == ON)
+static void charSpan(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color);
+#endif
+#if (CFG_TFT_FONT_RLE == ON) && (CFG_TFT_STRIP == ON)
+static boolean_t rlePixel(const uint8_t *p, uint16_t bit);
+#endif
+#if (CFG_TFT_SHAPE_SPANS == ON)
+static void spanRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, TFT_color_t color);
+static void spanMirror(int16_t m, int16_t a, int16_t b, int16_t c0, int16_t c1, uint8_t sides, boolean_t vertical, TFT_color_t color);
+static void spanAdd(TFT_span_t *s, int16_t y, int16_t x0, int16_t x1, TFT_color_t color);
+static void spanFlush(TFT_span_t *s, TFT_color_t color);
+static void circleRuns(int16_t x0, int16_t y0, int16_t r, int16_t a, uint8_t cornername, int16_t delta, boolean_t fill, TFT_color_t color);
+static void arcRuns(int16_t x0, int16_t y0, int16_t a, int16_t b, int16_t y, uint8_t cornername, TFT_color_t color);
+static void discRuns(int16_t x0, int16_t y0, int16_t a, int16_t b, int16_t y, uint8_t cornername, int16_t delta, TFT_color_t color);
+#endif
+#if (CFG_TFT_STRIP == ON)
+static boolean_t stripFill(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color);
+static boolean_t stripChar(int16_t x, int16_t y, unsigned char c, TFT_color_t color, TFT_color_t bg, uint8_t size);
+static TFT_dirty_t* stripAdd(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color, TFT_color_t bg);
+#if (CFG_TFT_STRIP_BPP < 16)
+static uint16_t stripIndex(TFT_color_t c);
+#endif
+static void stripRaster(const TFT_dirty_t *d, int16_t s0, int16_t n);
+static const uint8_t* stripLine(int16_t r, int16_t x0, int16_t x1);
+static void stripSend(uint8_t s, int16_t s0, int16_t n);
+static void stripFlush(void);
+#endif
+static boolean_t blitWindow(int16_t x, int16_t y, int16_t w, int16_t h, int16_t *c0, int16_t *c1, int16_t *r0, int16_t *r1);
+static void blitPut(uint16_t *n, TFT_color_t c);
+#if (CFG_TFT_CONSOLE == ON)
+static void consoleScroll(uint16_t ssa);
+#endif
+#if (CFG_TFT_QUEUE == ON)
+static RC_t queuePut(TFT_queue_cmd_t *c);
+static void queueMerge(uint8_t n);
+static void queueDraw(const TFT_queue_cmd_t *c);
+#endif
 //-------------------------------------[Implementation]
 
 //----------------- Ringbuffer
 
+// Moves the records of the ringbuffer into the SPI TX FIFO. The FIFO is
+// filled with as many bytes of the same D/C level as fit, D/C only changes
+// once the last byte of the other level has left the shifter.
 void __TFT_SPI_TX_ISR(void){
     
-    //check if we have data waiting
-    if(TFT_RB_out.fill==0)
-        return;
-    
-    //get the next frame to be send
-    TFT_data_t* p_next_frame=&TFT_RB_out.buffer[TFT_RB_out.read++];
-    
-    //adjust read index and fill level
-    TFT_RB_out.read%=CFG_TFT_RB_OUT_SZ;
-    TFT_RB_out.fill--;
+    TFT_RB_out.isrCalls++;
     
-    //check payload type
-    switch(p_next_frame->DC){
-        case TFT_CMD:
-            TFT_DC_LOW;
-            break;
+    while(TFT_RB_out.fill>0){
+        uint8_t sts=MODULE_SPI(ReadTxStatus)();
+        uint8_t dc;
+        uint8_t room;
         
-        case TFT_DATA:
-            TFT_DC_HIGH;
-            break;
-        default:
-        break;
+        //header of the next record
+        if(!TFT_RB_out.rdCmd && (TFT_RB_out.rdLeft==0) && (TFT_RB_out.rdRep==0)){
+            uint16_t r=TFT_RB_out.read;
+            uint8_t  hdr=TFT_RB_out.buffer[r];
+            
+            TFT_RB_out.rdHdr=r;
+            if(hdr>=TFT_REC_REP){
+                //color and count stay in the ringbuffer until the record is expanded
+                TFT_RB_out.rdColor=(TFT_RB_out.buffer[(r + 1) % CFG_TFT_RB_OUT_SZ] << 8) |
+                                    TFT_RB_out.buffer[(r + 2) % CFG_TFT_RB_OUT_SZ];
+                TFT_RB_out.rdRep=2 * (uint32_t)(TFT_RB_out.buffer[(r + 3) % CFG_TFT_RB_OUT_SZ] |
+                                               (TFT_RB_out.buffer[(r + 4) % CFG_TFT_RB_OUT_SZ] << 8));
+            } else {
+                TFT_RB_out.rdCmd=(hdr & TFT_REC_CMD) ? TRUE : FALSE;
+                TFT_RB_out.rdLeft=(hdr & TFT_REC_CMD) ? (hdr & TFT_REC_ARGS) : hdr + 1;
+            }
+            TFT_RB_out.read=(r + 1) % CFG_TFT_RB_OUT_SZ;
+            TFT_RB_out.fill--;
+        }
+        dc=TFT_RB_out.rdCmd ? 0 : 1;
+        
+        //switch D/C at a command/data boundary
+        if(dc!=TFT_RB_out.dc){
+            if(0==(sts & MODULE_SPI(STS_SPI_IDLE)))
+                TFT_TX_WAIT(MODULE_SPI(STS_SPI_DONE));
+            MODULE_DC(Write)(dc);
+            TFT_RB_out.dc=dc;
+        }
+        
+        //free FIFO entries, the status only tells empty or not full
+        if(sts & MODULE_SPI(STS_TX_FIFO_EMPTY))
+            room=MODULE_SPI(FIFO_SIZE);
+        else if(sts & MODULE_SPI(STS_TX_FIFO_NOT_FULL))
+            room=1;
+        else
+            TFT_TX_WAIT(MODULE_SPI(STS_TX_FIFO_EMPTY));
+        
+        //the command byte, or a burst of arguments / data
+        if(TFT_RB_out.rdCmd){
+            MODULE_SPI(WriteTxData)(TFT_RB_out.buffer[TFT_RB_out.read]);
+            TFT_RB_out.read=(TFT_RB_out.read + 1) % CFG_TFT_RB_OUT_SZ;
+            TFT_RB_out.fill--;
+            TFT_RB_out.rdCmd=FALSE;
+        } else if(TFT_RB_out.rdRep>0){
+            //even bytes left: high byte next
+            while((room>0) && (TFT_RB_out.rdRep>0)){
+                MODULE_SPI(WriteTxData)((TFT_RB_out.rdRep & 1) ? (uint8_t)TFT_RB_out.rdColor : TFT_RB_out.rdColor >> 8);
+                TFT_RB_out.rdRep--;
+                room--;
+            }
+            if(TFT_RB_out.rdRep==0){
+                TFT_RB_out.read=(TFT_RB_out.read + TFT_REC_REP_SZ - 1) % CFG_TFT_RB_OUT_SZ;
+                TFT_RB_out.fill-=TFT_REC_REP_SZ - 1;
+            }
+        } else {
+            while((room>0) && (TFT_RB_out.rdLeft>0)){
+                MODULE_SPI(WriteTxData)(TFT_RB_out.buffer[TFT_RB_out.read]);
+                TFT_RB_out.read=(TFT_RB_out.read + 1) % CFG_TFT_RB_OUT_SZ;
+                TFT_RB_out.fill--;
+                TFT_RB_out.rdLeft--;
+                room--;
+            }
+        }
+        if(TFT_RB_out.rdLeft==0)
+            TFT_RB_out.rdHdr=TFT_RB_NONE;
+        
+#if (CFG_TFT_TX_BLOCKING == ON)
+        //wake the producer once the ringbuffer has drained to the low watermark
+        if(TFT_RB_out.waiting && (TFT_RB_out.fill<=CFG_TFT_RB_OUT_LOW)){
+            TFT_RB_out.waiting=FALSE;
+            SetEvent(CFG_TFT_TX_TASK, CFG_TFT_TX_EVENT);
+        }
+#endif
     }
+    
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+    //ringbuffer empty, TFT_send triggers the next run
+    MODULE_SPI(SetTxInterruptMode)(0);
+#endif
+}
 
-    MODULE_SPI(WriteTxData)(p_next_frame->payload);    
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+// Wait until the ringbuffer has room for need bytes, called and returning
+// inside the critical section irq. With CFG_TFT_TX_BLOCKING the TX task
+// sleeps on its event until the TX interrupt has drained the ringbuffer to
+// the low watermark, any other caller serves the FIFO itself. This also
+// works in TFT_init, before the OS has installed the TX interrupt.
+static void TFT_rb_wait(uint8_t *irq, uint16_t need){
+#if (CFG_TFT_TX_BLOCKING == ON)
+    TaskType  task=INVALID_TASK;
+    boolean_t slept=FALSE;
+    
+    GetTaskID(&task);
+#endif
+    TFT_RB_out.waits++;
+    while(CFG_TFT_RB_OUT_SZ - TFT_RB_out.fill < need){
+#if (CFG_TFT_TX_BLOCKING == ON)
+        if(task==CFG_TFT_TX_TASK){
+            TFT_RB_out.waiting=TRUE;
+            CyExitCriticalSection(*irq);
+            WaitEvent(CFG_TFT_TX_EVENT);
+            ClearEvent(CFG_TFT_TX_EVENT);
+            *irq=CyEnterCriticalSection();
+            slept=TRUE;
+        } else {
+            __TFT_SPI_TX_ISR();
+        }
+#else
+        //sleep until the TX interrupt has made room, WFI returns on the
+        //pending interrupt, which runs when the critical section ends
+        CY_PM_WFI;
+        CyExitCriticalSection(*irq);
+        *irq=CyEnterCriticalSection();
+#endif
+    }
+#if (CFG_TFT_TX_BLOCKING == ON)
+    //the event may be shared, hand back a notification consumed here
+    if(slept){
+        CyExitCriticalSection(*irq);
+        SetEvent(task, CFG_TFT_TX_EVENT);
+        *irq=CyEnterCriticalSection();
+    }
+#endif
 }
+#endif
 
+// Append a byte to the records of the ringbuffer. Arguments and data extend
+// the last record while it has unsent bytes, a command starts a new one.
 RC_t TFT_send(TFT_payload_t type, uint8_t payload){
 
-    //check if buffer is full
-    if(TFT_RB_out.fill>=CFG_TFT_RB_OUT_SZ){
+#if (CFG_TFT_DMA == ON)
+    //the SPI belongs to the DMA until its chain has finished
+    if(dma.busy)
+        dmaWait();
+#endif
+
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+    uint8_t  irq=CyEnterCriticalSection();
+#endif
+    uint16_t fill;
+    
+    for(;;){
+        uint8_t hdr=TFT_RB_out.lastHdr;
+        
+        fill=TFT_RB_out.fill;
+        if((fill>0) && (fill<CFG_TFT_RB_OUT_SZ) && (type!=TFT_CMD) && (hdr<TFT_REC_REP) &&
+           ((hdr & TFT_REC_CMD) ? ((hdr & TFT_REC_ARGS) < TFT_REC_ARGS) : (hdr < TFT_REC_RUN - 1))){
+            TFT_RB_out.buffer[TFT_RB_out.last]=TFT_RB_out.lastHdr=hdr + 1;
+            //the TX service has the header already
+            if(TFT_RB_out.rdHdr==TFT_RB_out.last)
+                TFT_RB_out.rdLeft++;
+            break;
+        }
+        if(fill<=CFG_TFT_RB_OUT_SZ - 2){
+            //the record being sent is complete, its header slot may be reused
+            TFT_RB_out.rdHdr=TFT_RB_NONE;
+            TFT_RB_out.last=TFT_RB_out.write;
+            TFT_RB_out.lastHdr=(type==TFT_CMD) ? TFT_REC_CMD : 0;
+            TFT_RB_out.buffer[TFT_RB_out.write]=TFT_RB_out.lastHdr;
+            TFT_RB_out.write=(TFT_RB_out.write + 1) % CFG_TFT_RB_OUT_SZ;
+            TFT_RB_out.fill++;
+            break;
+        }
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+        TFT_rb_wait(&irq, 2);
+#else
         //TODO: fire event or DET STOP
         LOG_E(TAG,"Buffer overflow");
         return RC_ERROR_BUFFER_FULL;
+#endif
     }
-    
-    //add frame to buffer
-    TFT_RB_out.buffer[TFT_RB_out.write++]=(TFT_data_t){type,payload};
-
-    //adjust write index and fill level
-    TFT_RB_out.write%=CFG_TFT_RB_OUT_SZ;
+    TFT_RB_out.buffer[TFT_RB_out.write]=payload;
+    TFT_RB_out.write=(TFT_RB_out.write + 1) % CFG_TFT_RB_OUT_SZ;
     TFT_RB_out.fill++;
     
-    //check if this is the only entry in the ringbuffer and trigger the ISR
-    if(TFT_RB_out.fill==1)
+    //the ISR is idle with an empty ringbuffer, trigger it
+    if(fill==0)
         __TFT_SPI_TX_ISR();
 
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+    CyExitCriticalSection(irq);
+#endif
     return RC_SUCCESS;
 }
 
+// Stream a block of pixel data. With the TX interrupt the block is queued
+// in the ringbuffer as data runs. Otherwise, with an empty ringbuffer, the
+// bytes go straight to the SPI, which blocks on a full FIFO. Long blocks
+// are handed to the DMA if it is enabled.
+static void TFT_send_block(const uint8_t *data, uint16_t len){
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+    while(len>0){
+        uint8_t  irq=CyEnterCriticalSection();
+        uint16_t fill=TFT_RB_out.fill;
+        uint16_t free=CFG_TFT_RB_OUT_SZ - fill;
+        uint8_t  hdr=TFT_RB_out.lastHdr;
+        uint16_t n;
+        
+        if((fill>0) && (free>=1) && !(hdr & TFT_REC_CMD) && (hdr < TFT_REC_RUN - 1)){
+            //extend the last data run
+            n=TFT_REC_RUN - 1 - hdr;
+            if(n>free) n=free;
+            if(n>len) n=len;
+            TFT_RB_out.buffer[TFT_RB_out.last]=TFT_RB_out.lastHdr=hdr + n;
+            if(TFT_RB_out.rdHdr==TFT_RB_out.last)
+                TFT_RB_out.rdLeft+=n;
+        } else if(free>=2){
+            //new data run
+            n=free - 1;
+            if(n>TFT_REC_RUN) n=TFT_REC_RUN;
+            if(n>len) n=len;
+            TFT_RB_out.rdHdr=TFT_RB_NONE;
+            TFT_RB_out.last=TFT_RB_out.write;
+            TFT_RB_out.buffer[TFT_RB_out.write]=TFT_RB_out.lastHdr=n - 1;
+            TFT_RB_out.write=(TFT_RB_out.write + 1) % CFG_TFT_RB_OUT_SZ;
+            TFT_RB_out.fill++;
+        } else {
+            TFT_rb_wait(&irq, 2);
+            CyExitCriticalSection(irq);
+            continue;
+        }
+        
+        len-=n;
+        for(uint16_t i=n; i>0; i--){
+            TFT_RB_out.buffer[TFT_RB_out.write]=*data++;
+            TFT_RB_out.write=(TFT_RB_out.write + 1) % CFG_TFT_RB_OUT_SZ;
+        }
+        TFT_RB_out.fill+=n;
+        
+        //the ISR is idle with an empty ringbuffer
+        if(fill==0)
+            __TFT_SPI_TX_ISR();
+        CyExitCriticalSection(irq);
+    }
+#else
+#if (CFG_TFT_DMA == ON)
+    if((len>=CFG_TFT_DMA_MIN_BYTES) && dmaReachable(data, len)){
+        dmaStream(data, len);
+        return;
+    }
+    if(dma.busy)
+        dmaWait();
+#endif
+    if(TFT_RB_out.fill==0) {
+        //D/C may only change once the command has left the shifter
+        if(TFT_RB_out.dc!=1){
+            while(0==(MODULE_SPI(ReadTxStatus)() & MODULE_SPI(STS_SPI_IDLE)));
+            TFT_DC_HIGH;
+            TFT_RB_out.dc=1;
+        }
+        while(len--)
+            MODULE_SPI(WriteTxData)(*data++);
+        return;
+    }
+    while(len--)
+        TFT_write_stream(*data++);
+#endif
+}
+
+// Queue px pixels of one color as repeat records, which the TX service
+// expands. The queue space and producer time do not depend on px.
+static void TFT_send_repeat(TFT_color_t color, uint32_t px){
+
+#if (CFG_TFT_DMA == ON)
+    if(dma.busy)
+        dmaWait();
+#endif
+
+    while(px>0){
+        uint16_t n=(px>TFT_REC_REP_MAX) ? TFT_REC_REP_MAX : px;
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+        uint8_t  irq=CyEnterCriticalSection();
+        
+        if(TFT_RB_out.fill>CFG_TFT_RB_OUT_SZ - TFT_REC_REP_SZ)
+            TFT_rb_wait(&irq, TFT_REC_REP_SZ);
+#else
+        //the polled TX service empties the ringbuffer before it returns
+        while(TFT_RB_out.fill>CFG_TFT_RB_OUT_SZ - TFT_REC_REP_SZ)
+            __TFT_SPI_TX_ISR();
+#endif
+        uint16_t fill=TFT_RB_out.fill;
+        uint16_t w=TFT_RB_out.write;
+        
+        TFT_RB_out.rdHdr=TFT_RB_NONE;
+        TFT_RB_out.last=w;
+        TFT_RB_out.lastHdr=TFT_REC_REP;
+        TFT_RB_out.buffer[w]=TFT_REC_REP;
+        TFT_RB_out.buffer[(w + 1) % CFG_TFT_RB_OUT_SZ]=color >> 8;
+        TFT_RB_out.buffer[(w + 2) % CFG_TFT_RB_OUT_SZ]=color;
+        TFT_RB_out.buffer[(w + 3) % CFG_TFT_RB_OUT_SZ]=n;
+        TFT_RB_out.buffer[(w + 4) % CFG_TFT_RB_OUT_SZ]=n >> 8;
+        TFT_RB_out.write=(w + TFT_REC_REP_SZ) % CFG_TFT_RB_OUT_SZ;
+        TFT_RB_out.fill+=TFT_REC_REP_SZ;
+        px-=n;
+        
+        //the ISR is idle with an empty ringbuffer
+        if(fill==0)
+            __TFT_SPI_TX_ISR();
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+        CyExitCriticalSection(irq);
+#endif
+    }
+}
+
+uint32_t TFT_getTxIsrCount(void){
+    return TFT_RB_out.isrCalls;
+}
+
+#if (CFG_TFT_TX_BLOCKING == ON)
+void TFT_txIsr(void){
+    __TFT_SPI_TX_ISR();
+}
+#endif
+
+uint32_t TFT_getTxWaitCount(void){
+    return TFT_RB_out.waits;
+}
+
+uint32_t TFT_getDmaCount(void){
+#if (CFG_TFT_DMA == ON)
+    return dma.count;
+#else
+    return 0;
+#endif
+}
+
+//----------------- DMA
+#if (CFG_TFT_DMA == ON)
+
+// End of a chain, called from the ISR2 of the nrq
+void TFT_dmaIsr(void){
+    dma.busy=FALSE;
+    if(dma.sleeping)
+        SetEvent(CFG_TFT_DMA_TASK, CFG_TFT_DMA_EVENT);
+}
+
+// Wait for the end of the running chain. The configured task sleeps on its
+// event, everybody else (tsk_init, other tasks) with WFI.
+static void dmaWait(void){
+    TaskType  task=INVALID_TASK;
+    boolean_t slept=FALSE;
+    
+    if(!dma.busy) return;
+    GetTaskID(&task);
+    dma.sleeping=(task==CFG_TFT_DMA_TASK);
+    while(dma.busy){
+        if(dma.sleeping){
+            WaitEvent(CFG_TFT_DMA_EVENT);
+            ClearEvent(CFG_TFT_DMA_EVENT);
+            slept=TRUE;
+        } else {
+            //WFI returns on a pending nrq even inside the critical section
+            uint8_t irq=CyEnterCriticalSection();
+            if(dma.busy)
+                CY_PM_WFI;
+            CyExitCriticalSection(irq);
+        }
+    }
+    dma.sleeping=FALSE;
+    
+    //the event may be shared, hand back a notification consumed here
+    if(slept)
+        SetEvent(task, CFG_TFT_DMA_EVENT);
+}
+
+// A chain shares the upper 16 address bits, SRAM straddles 0x20000000
+static boolean_t dmaReachable(const uint8_t *data, uint32_t len){
+    return HI16(TFT_DMA_ADDR(data))==HI16(TFT_DMA_ADDR(data + len - 1));
+}
+
+// Start a chain for up to CFG_TFT_DMA_TDS TDs of len bytes. Every TD sends
+// up to step bytes from src, advanced by step per TD if advance is set.
+// cfg selects the fixed (0) or incrementing (TD_INC_SRC_ADR) source.
+// Returns the bytes covered by the chain.
+static uint32_t dmaStart(const uint8_t *src, uint32_t len, uint16_t step, boolean_t advance, uint8_t cfg){
+    uint32_t sent=0;
+    
+    dmaWait();
+    
+    //D/C may only change once the command has left the shifter
+    if(TFT_RB_out.dc!=1){
+        while(0==(MODULE_SPI(ReadTxStatus)() & MODULE_SPI(STS_SPI_IDLE)));
+        TFT_DC_HIGH;
+        TFT_RB_out.dc=1;
+    }
+    
+    for(uint8_t n=0; (n<CFG_TFT_DMA_TDS) && (sent<len); n++) {
+        uint16_t  cnt  = ((len - sent) > step) ? step : (uint16_t)(len - sent);
+        boolean_t last;
+        
+        CyDmaTdSetAddress(dma.td[n], LO16(TFT_DMA_ADDR(advance ? src + sent : src)),
+                          LO16(TFT_DMA_ADDR(MODULE_SPI(TXDATA_PTR))));
+        sent+=cnt;
+        last=(sent==len) || (n==CFG_TFT_DMA_TDS-1);
+        CyDmaTdSetConfiguration(dma.td[n], cnt, last ? CY_DMA_DISABLE_TD : dma.td[n+1],
+                                cfg | (last ? MODULE_DMA(_TD_TERMOUT_EN) : 0));
+    }
+    
+    //every request (TX FIFO not full) moves one byte
+    CyDmaChSetExtendedAddress(dma.ch, HI16(TFT_DMA_ADDR(src)), HI16(CYDEV_PERIPH_BASE));
+    CyDmaChSetInitialTd(dma.ch, dma.td[0]);
+    dma.busy=TRUE;
+    dma.count++;
+    CyDmaChEnable(dma.ch, 1);
+    return sent;
+}
+
+// Stream a pixel buffer, returns once the DMA has read all of it
+static void dmaStream(const uint8_t *data, uint16_t len){
+    while(len>0){
+        uint16_t n=dmaStart(data, len, TFT_DMA_TD_MAX, TRUE, TD_INC_SRC_ADR);
+        data+=n;
+        len-=n;
+    }
+    dmaWait();
+}
+
+// Solid fill of px pixels, returns while the last chain is running. The SPI
+// takes bytes, so only a color with equal bytes can be a fixed source,
+// any other repeats a pattern line per TD.
+static void dmaFill(TFT_color_t color, uint32_t px){
+    uint8_t   hi = color >> 8, lo = color;
+    boolean_t fixed = (hi == lo);
+    uint32_t  len = px * 2;
+    
+    //the running chain may still read the pattern
+    dmaWait();
+    if(!dma.fillValid || (dma.fillColor!=color)) {
+        for(uint16_t i=0; i<sizeof(dma.pattern); i+=2) {
+            dma.pattern[i]=hi;
+            dma.pattern[i+1]=lo;
+        }
+        dma.fillColor=color;
+        dma.fillValid=TRUE;
+    }
+    
+    while(len>0){
+        if(fixed)
+            len-=dmaStart(dma.pattern, len, TFT_DMA_TD_MAX, FALSE, 0);
+        else
+            len-=dmaStart(dma.pattern, len, sizeof(dma.pattern), FALSE, TD_INC_SRC_ADR);
+    }
+}
+#endif
+
 
 //----------------- CTRL
 void TFT_init(){
@@ -204,26 +1002,104 @@ void TFT_init(){
     wrap=TRUE;
     gfxFont=NULL;
     ystart = xstart = colstart  = rowstart = 0;
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    memset(window, TFT_WINDOW_NONE, sizeof(window));
+#endif
     
     //init ringbuffer
     TFT_RB_out.read=0;
     TFT_RB_out.write=0;
     TFT_RB_out.fill=0;
+    TFT_RB_out.last=0;
+    TFT_RB_out.lastHdr=0;
+    TFT_RB_out.rdHdr=TFT_RB_NONE;
+    TFT_RB_out.rdLeft=0;
+    TFT_RB_out.rdCmd=FALSE;
+    TFT_RB_out.rdRep=0;
+#if (CFG_TFT_TX_BLOCKING == ON)
+    TFT_RB_out.waiting=FALSE;
+#endif
+    TFT_RB_out.waits=0;
+    TFT_RB_out.dc=0xFF;
+    TFT_RB_out.isrCalls=0;
     
-    //Start SPI Interface
-    MODULE_SPI(Start)();
+    //init DMA, the TDs are allocated once
+#if (CFG_TFT_DMA == ON)
+    if(!dma.ready) {
+        dma.ch=MODULE_DMA(DmaInitialize)(1, 1, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+        for(uint8_t i=0; i<CFG_TFT_DMA_TDS; i++)
+            dma.td[i]=CyDmaTdAllocate();
+        dma.ready=TRUE;
+    }
+    dma.busy=FALSE;
+    dma.sleeping=FALSE;
+    dma.count=0;
+    dma.fillValid=FALSE;
+#endif
     
-    //Perform Hardware reset
-    TFT_RES_HIGH;
-    CFG_TFT_DELAY_MS(100);
-    TFT_RES_LOW;
-	CFG_TFT_DELAY_MS(100);
-	TFT_RES_HIGH;
-	CFG_TFT_DELAY_MS(20);
+    //init glyph cache
+#if (CFG_TFT_GLYPH_CACHE == ON)
+    glyphCache.clock=0;
+    glyphCache.hits=0;
+    glyphCache.misses=0;
+#endif
+    TFT_clearGlyphCache();
     
-    //Software reset
-    TFT_write_cmd(ST7735_SWRESET);
-    CFG_TFT_DELAY_MS(50);
+    //init text fields
+    memset(fields, 0, sizeof(fields));
+
+    //init text measurement
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+    memset(&boundsCache, 0, sizeof(boundsCache));
+#endif
+    advance.valid=FALSE;
+    
+    //init draw queue
+#if (CFG_TFT_QUEUE == ON)
+    memset(&queue, 0, sizeof(queue));
+#endif
+    
+    //init console, SWRESET leaves the scroll mode
+#if (CFG_TFT_CONSOLE == ON)
+    console.active=FALSE;
+#endif
+    
+    //init strip renderer
+#if (CFG_TFT_STRIP == ON)
+    strip.open=FALSE;
+#if (CFG_TFT_STRIP_SKIP == ON)
+    strip.hashValid=FALSE;
+#endif
+    strip.cnt=0;
+#if (CFG_TFT_STRIP_BPP < 16)
+    strip.colors=0;
+#endif
+#endif
+    
+    //Start SPI Interface
+    MODULE_SPI(Start)();
+#if (CFG_TFT_SPI_TX_IRQ == ON)
+    MODULE_SPI(SetTxInterruptMode)(0);
+#if (CFG_TFT_TX_BLOCKING == OFF)
+    MODULE_TXISR(StartEx)(__TFT_SPI_TX_ISR);
+#endif
+#endif
+#if (CFG_TFT_DMA == ON)
+    //the request stays enabled, it is only served while a chain runs
+    MODULE_SPI(SetTxInterruptMode)(MODULE_SPI(STS_TX_FIFO_NOT_FULL));
+#endif
+    
+    //Perform Hardware reset
+    TFT_RES_HIGH;
+    CFG_TFT_DELAY_MS(100);
+    TFT_RES_LOW;
+	CFG_TFT_DELAY_MS(100);
+	TFT_RES_HIGH;
+	CFG_TFT_DELAY_MS(20);
+    
+    //Software reset
+    TFT_write_cmd(ST7735_SWRESET);
+    CFG_TFT_DELAY_MS(50);
     
     //sleep out
     TFT_write_cmd(ST7735_SLPOUT);    //Sleep out
@@ -264,23 +1140,54 @@ uint8_t TFT_getBacklight(){
 
 void setAddrWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
 
-    TFT_write_cmd(ST7735_CASET);   // Column addr set
-    TFT_write_data(0x00);
-    TFT_write_data(x0+xstart);         // XSTART 
-    TFT_write_data(0x00);
-    TFT_write_data(x1+xstart);         // XEND
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    // The controller keeps the addresses, RAMWR restarts at the window origin
+    boolean_t cols=(window[0] != x0) || (window[1] != x1);
+    boolean_t rows=(window[2] != y0) || (window[3] != y1);
+    
+    window[0]=x0;
+    window[1]=x1;
+    window[2]=y0;
+    window[3]=y1;
+#else
+    boolean_t cols=TRUE;
+    boolean_t rows=TRUE;
+#endif
 
-    TFT_write_cmd(ST7735_RASET);   // Row addr set
-    TFT_write_data(0x00);
-    TFT_write_data(y0+ystart);         // YSTART
-    TFT_write_data(0x00);
-    TFT_write_data(y1+ystart);         // YEND
+    if(cols) {
+        TFT_write_cmd(ST7735_CASET);   // Column addr set
+        TFT_write_data(0x00);
+        TFT_write_data(x0+xstart);         // XSTART 
+        TFT_write_data(0x00);
+        TFT_write_data(x1+xstart);         // XEND
+    }
+
+    if(rows) {
+        TFT_write_cmd(ST7735_RASET);   // Row addr set
+        TFT_write_data(0x00);
+        TFT_write_data(y0+ystart);         // YSTART
+        TFT_write_data(0x00);
+        TFT_write_data(y1+ystart);         // YEND
+    }
 
     TFT_write_cmd(ST7735_RAMWR);   // write to RAM
 }
 
 void TFT_setRotation(TFT_rotation_t m) {
 
+#if (CFG_TFT_STRIP == ON) && (CFG_TFT_STRIP_SKIP == ON)
+    strip.hashValid=FALSE;          // Strips change with the rotation
+#endif
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    memset(window, TFT_WINDOW_NONE, sizeof(window));    // Offsets change with the rotation
+#endif
+#if (CFG_TFT_CONSOLE == ON)
+    if(console.active) {
+        TFT_write_cmd(ST7735_NORON);                    // Scroll areas are rows of the frame memory
+        console.active=FALSE;
+    }
+#endif
+
     //Memory data access control entry
     TFT_write_cmd(ST7735_MADCTL);
     rotation = m % 4; // can't be higher than 3
@@ -352,6 +1259,8 @@ void TFT_setTextSize(uint8_t s) {
     textsize = (s > 0) ? s : 1;
 }
 
+uint8_t TFT_getTextSize(void){return textsize;}
+
 void TFT_setFont(const GFXfont *f) {
     if(f) {            // Font struct pointer passed in?
         if(!gfxFont) { // And no current font struct?
@@ -377,6 +1286,19 @@ void TFT_getTextBounds(char *str, int16_t x, int16_t y, int16_t *x1, int16_t *y1
 
     int16_t minx = _width, miny = _height, maxx = -1, maxy = -1;
 
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+    // The measured box moves with the start position as long as no
+    // character wraps. Clip the moved box the same way as the loop below.
+    TFT_bounds_t *b = boundsCacheGet(str);
+    if(b && (!wrap || ((int32_t)x + b->maxx < _width))) {
+        int32_t bx1 = (int32_t)x + b->minx, bx2 = (int32_t)x + b->maxx,
+                by1 = (int32_t)y + b->miny, by2 = (int32_t)y + b->maxy;
+        minx = (bx1 < _width)  ? bx1 : _width;
+        miny = (by1 < _height) ? by1 : _height;
+        maxx = (bx2 > -1) ? bx2 : -1;
+        maxy = (by2 > -1) ? by2 : -1;
+    } else
+#endif
     while((c = *str++))
         charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
 
@@ -390,6 +1312,105 @@ void TFT_getTextBounds(char *str, int16_t x, int16_t y, int16_t *x1, int16_t *y1
     }
 }
 
+void TFT_getBoundsCacheStats(uint32_t *hits, uint32_t *misses){
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+    if(hits)   *hits=boundsCache.hits;
+    if(misses) *misses=boundsCache.misses;
+#else
+    if(hits)   *hits=0;
+    if(misses) *misses=0;
+#endif
+}
+
+uint16_t TFT_getDigitsWidth(uint8_t digits){
+    return (uint16_t)digits * advanceTable()->widest * textsize;
+}
+
+uint16_t TFT_getNumberWidth(int32_t value){
+    const TFT_advance_t *a = advanceTable();
+    uint32_t u = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+    uint16_t w = (value < 0) ? a->minus : 0;
+
+    do {
+        w += a->tabular ? a->widest : a->digit[u % 10];
+        u /= 10;
+    } while(u);
+    return w * textsize;
+}
+
+#if (CFG_TFT_BOUNDS_CACHE > 0)
+// Bounds of a string in the current font and size relative to the start
+// position, measured without wrapping on a miss. NULL for strings with
+// newlines, those depend on the absolute position, and for strings longer
+// than CFG_TFT_BOUNDS_LEN. The hash only preselects, the text decides.
+static TFT_bounds_t* boundsCacheGet(const char *str){
+    uint32_t     h = 2166136261u;   // FNV-1a
+    uint16_t     len = 0;
+    TFT_bounds_t *b;
+
+    for(const char *p=str; *p; p++, len++) {
+        if((*p == '\n') || (len == CFG_TFT_BOUNDS_LEN))
+            return NULL;
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    if(h == 0) h = 1;
+
+    for(b=boundsCache.entry; b<&boundsCache.entry[CFG_TFT_BOUNDS_CACHE]; b++) {
+        if((b->hash == h) && (b->len == len) && (b->font == gfxFont) && (b->size == textsize) &&
+           (memcmp(b->text, str, len) == 0)) {
+            boundsCache.hits++;
+            return b;
+        }
+    }
+    boundsCache.misses++;
+
+    b = &boundsCache.entry[boundsCache.next];
+    boundsCache.next = (boundsCache.next + 1) % CFG_TFT_BOUNDS_CACHE;
+
+    int16_t   x = 0, y = 0;
+    boolean_t w = wrap;
+    memcpy(b->text, str, len);
+    b->minx = b->miny = INT16_MAX;
+    b->maxx = b->maxy = INT16_MIN;
+    wrap = FALSE;
+    while(*str)
+        charBounds(*str++, &x, &y, &b->minx, &b->miny, &b->maxx, &b->maxy);
+    wrap = w;
+
+    b->hash = h;
+    b->len  = len;
+    b->font = gfxFont;
+    b->size = textsize;
+    return b;
+}
+#endif
+
+// Digit advances of the current font, rebuilt when the font changed
+static const TFT_advance_t* advanceTable(void){
+    if(advance.valid && (advance.font == gfxFont))
+        return &advance;
+
+    advance.font    = gfxFont;
+    advance.valid   = TRUE;
+    advance.widest  = 0;
+    advance.tabular = TRUE;
+    advance.minus   = 6;
+    for(uint8_t i=0; i<10; i++) {
+        uint8_t xa = 6;                     // Classic font cell
+        if(gfxFont) {
+            uint8_t first = pgm_read_byte(&gfxFont->first), last = pgm_read_byte(&gfxFont->last);
+            GFXglyph *glyph = (GFXglyph *)pgm_read_pointer(&gfxFont->glyph);
+            xa = (('0' + i >= first) && ('0' + i <= last)) ? pgm_read_byte(&glyph['0' + i - first].xAdvance) : 0;
+            if(i == 0)
+                advance.minus = (('-' >= first) && ('-' <= last)) ? pgm_read_byte(&glyph['-' - first].xAdvance) : 0;
+        }
+        advance.digit[i] = xa;
+        if((i > 0) && (xa != advance.widest)) advance.tabular = FALSE;
+        if(xa > advance.widest) advance.widest = xa;
+    }
+    return &advance;
+}
+
 void charBounds(char c, int16_t *x, int16_t *y,  int16_t *minx, int16_t *miny, int16_t *maxx, int16_t *maxy) {
 
     if(gfxFont) {
@@ -535,32 +1556,41 @@ void TFT_fillScreen(TFT_color_t color) {
 void TFT_clearScreen(void){TFT_fillScreen(TFT_getBGcolor());};
 
 void TFT_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color) {
+
+#if (CFG_TFT_STRIP == ON)
+    if(stripFill(x, y, w, h, color)) return;
+#endif
     
     // rudimentary clipping (drawChar w/big text requires this)
-    if((x >= _width) || (y >= _height)) return;
+    if(x < 0) { w += x; x = 0; }
+    if(y < 0) { h += y; y = 0; }
+    if((x >= _width) || (y >= _height) || (w <= 0) || (h <= 0)) return;
     
     if((x + w - 1) >= _width)  w = _width  - x;
     if((y + h - 1) >= _height) h = _height - y;
     
     setAddrWindow(x, y, x+w-1, y+h-1);
 
-    uint8_t hi = color >> 8, lo = color;
-    
-    TFT_DC_HIGH;
-    for(y=h; y>0; y--) {
-        for(x=w; x>0; x--) {
-          TFT_write_stream(hi);
-          TFT_write_stream(lo);
-        }
+#if (CFG_TFT_DMA == ON)
+    if((w > 0) && (h > 0) && ((uint32_t)w * h * 2 >= CFG_TFT_DMA_MIN_BYTES) &&
+       dmaReachable(dma.pattern, sizeof(dma.pattern))) {
+        dmaFill(color, (uint32_t)w * h);
+        return;
     }
+#endif
+
+    if((w > 0) && (h > 0))
+        TFT_send_repeat(color, (uint32_t)w * h);
 }
 
 void TFT_drawPixel(int16_t x, int16_t y, TFT_color_t color) {
 
+#if (CFG_TFT_STRIP == ON)
+    if(stripFill(x, y, 1, 1, color)) return;
+#endif
     if((x < 0) ||(x >= _width) || (y < 0) || (y >= _height)) return;
-    setAddrWindow(x,y,x+1,y+1);
+    setAddrWindow(x,y,x,y);
 
-    TFT_DC_HIGH;
     TFT_write_stream(color >> 8);
     TFT_write_stream(color);
 
@@ -568,39 +1598,51 @@ void TFT_drawPixel(int16_t x, int16_t y, TFT_color_t color) {
 
 void TFT_fastVLine(int16_t x, int16_t y, int16_t h, TFT_color_t color) {
 
+#if (CFG_TFT_STRIP == ON)
+  if(stripFill(x, y, 1, h, color)) return;
+#endif
+
   // Rudimentary clipping
-  if((x >= _width) || (y >= _height)) return;
+  if(y < 0) { h += y; y = 0; }
+  if((x < 0) || (x >= _width) || (y >= _height) || (h <= 0)) return;
   if((y+h-1) >= _height) h = _height-y;
   setAddrWindow(x, y, x, y+h-1);
 
-  uint8_t hi = color >> 8, lo = color;
-    
-  TFT_DC_HIGH;
-  while (h--) {
-    TFT_write_stream(hi);
-    TFT_write_stream(lo);
-  }
+  if (h > 0)
+    TFT_send_repeat(color, h);
 }
 
 void TFT_fastHLine(int16_t x, int16_t y, int16_t w,  TFT_color_t color) {
 
+#if (CFG_TFT_STRIP == ON)
+    if(stripFill(x, y, w, 1, color)) return;
+#endif
+
     // Rudimentary clipping
-    if((x >= _width) || (y >= _height)) return;
+    if(x < 0) { w += x; x = 0; }
+    if((y < 0) || (x >= _width) || (y >= _height) || (w <= 0)) return;
     if((x+w-1) >= _width)  w = _width-x;
     setAddrWindow(x, y, x+w-1, y);
 
-    uint8_t hi = color >> 8, lo = color;
-
-    TFT_DC_HIGH;
-
-    while (w--) {
-        TFT_write_stream(hi);
-        TFT_write_stream(lo);
-    }
+    if (w > 0)
+        TFT_send_repeat(color, w);
 }
 
 // Bresenham's algorithm - thx wikpedia
 void TFT_writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,  TFT_color_t color) {
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    // Axis aligned lines are a single window
+    if (y0 == y1) {
+        if (x0 > x1) _swap_int16_t(x0, x1);
+        spanRect(x0, y0, x1, y0, color);
+        return;
+    }
+    if (x0 == x1) {
+        if (y0 > y1) _swap_int16_t(y0, y1);
+        spanRect(x0, y0, x0, y1, color);
+        return;
+    }
+#endif
     int16_t steep = _abs(y1 - y0) > _abs(x1 - x0);
     if (steep) {
         _swap_int16_t(x0, y0);
@@ -625,6 +1667,26 @@ void TFT_writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,  TFT_color_t
         ystep = -1;
     }
 
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    // Pixels on the major axis until the minor one steps share one window
+    int16_t run = x0;
+
+    for (; x0<=x1; x0++) {
+        err -= dy;
+        if ((err < 0) || (x0 == x1)) {
+            if (steep) {
+                spanRect(y0, run, y0, x0, color);
+            } else {
+                spanRect(run, y0, x0, y0, color);
+            }
+            run = x0 + 1;
+        }
+        if (err < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+#else
     for (; x0<=x1; x0++) {
         if (steep) {
             TFT_drawPixel(y0, x0, color);
@@ -637,6 +1699,7 @@ void TFT_writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,  TFT_color_t
             err += dx;
         }
     }
+#endif
 }
 
 void TFT_invertDisplay(boolean_t i) {
@@ -645,6 +1708,9 @@ void TFT_invertDisplay(boolean_t i) {
 
 // Draw a circle outline
 void TFT_drawCircle(int16_t x0, int16_t y0, int16_t r, TFT_color_t color) {
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    circleRuns(x0, y0, r, 0, 0xF, 0, FALSE, color);
+#else
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -676,9 +1742,13 @@ void TFT_drawCircle(int16_t x0, int16_t y0, int16_t r, TFT_color_t color) {
         TFT_drawPixel(x0 - y, y0 - x, color);
     }
 
+#endif
 }
 
 void TFT_drawCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t cornername, TFT_color_t color) {
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    circleRuns(x0, y0, r, 1, cornername, 0, FALSE, color);
+#else
     int16_t f     = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -711,17 +1781,25 @@ void TFT_drawCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t cornername
             TFT_drawPixel(x0 - x, y0 - y, color);
         }
     }
+#endif
 }
 
 void TFT_fillCircle(int16_t x0, int16_t y0, int16_t r, TFT_color_t color) {
 
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    circleRuns(x0, y0, r, 0, 3, 0, TRUE, color);
+#else
     TFT_fastVLine(x0, y0-r, 2*r+1, color);
     TFT_fillCircleHelper(x0, y0, r, 3, 0, color);
+#endif
 }
 
 // Used to do circles and roundrects
 void TFT_fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, TFT_color_t color) {
 
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    circleRuns(x0, y0, r, 1, cornername, delta, TRUE, color);
+#else
     int16_t f     = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -747,6 +1825,7 @@ void TFT_fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
             TFT_fastVLine(x0-y, y0-x, 2*x+1+delta, color);
         }
     }
+#endif
 }
 
 // Draw a triangle
@@ -760,6 +1839,9 @@ void TFT_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2
 void TFT_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, TFT_color_t color) {
 
     int16_t a, b, y, last;
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    TFT_span_t span = { 0, 0, 0, -1 };
+#endif
 
     // Sort coordinates by Y order (y2 >= y1 >= y0)
     if (y0 > y1) {
@@ -778,7 +1860,11 @@ void TFT_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2
         else if(x1 > b) b = x1;
         if(x2 < a)      a = x2;
         else if(x2 > b) b = x2;
+#if (CFG_TFT_SHAPE_SPANS == ON)
+        spanRect(a, y0, b, y0, color);
+#else
         TFT_fastHLine(a, y0, b-a+1, color);
+#endif
         return;
     }
 
@@ -812,7 +1898,11 @@ void TFT_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2
         b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
         */
         if(a > b) _swap_int16_t(a,b);
+#if (CFG_TFT_SHAPE_SPANS == ON)
+        spanAdd(&span, y, a, b, color);
+#else
         TFT_fastHLine(a, y, b-a+1, color);
+#endif
     }
 
     // For lower part of triangle, find scanline crossings for segments
@@ -829,8 +1919,15 @@ void TFT_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2
         b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
         */
         if(a > b) _swap_int16_t(a,b);
+#if (CFG_TFT_SHAPE_SPANS == ON)
+        spanAdd(&span, y, a, b, color);
+#else
         TFT_fastHLine(a, y, b-a+1, color);
+#endif
     }
+#if (CFG_TFT_SHAPE_SPANS == ON)
+    spanFlush(&span, color);
+#endif
 }
 
 // Draw a rounded rectangle
@@ -868,9 +1965,1060 @@ void TFT_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,  TFT_color_t color
     TFT_fastVLine(x+w-1, y, h, color);
 }
 
+//----------------- Span rasteriser
+
+#if (CFG_TFT_SHAPE_SPANS == ON)
+// Rectangle of a shape from its corners, clipped on all sides
+static void spanRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, TFT_color_t color){
+    if(x0 < 0) x0 = 0;
+    if(y0 < 0) y0 = 0;
+    if(x1 >= _width)  x1 = _width - 1;
+    if(y1 >= (int16_t)_height) y1 = _height - 1;
+    if((x0 > x1) || (y0 > y1)) return;
+
+    TFT_fillRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1, color);
+}
+
+// Runs m+a..m+b and m-b..m-a across the lines c0..c1 (columns, or rows if
+// vertical), one run if both sides meet in the center
+static void spanMirror(int16_t m, int16_t a, int16_t b, int16_t c0, int16_t c1, uint8_t sides, boolean_t vertical, TFT_color_t color){
+    int16_t lo = m - b;
+    int16_t hi = m + b;
+
+    if((a == 0) && (sides == TFT_SIDE_BOTH)) {
+        if(vertical) spanRect(c0, lo, c1, hi, color);
+        else         spanRect(lo, c0, hi, c1, color);
+        return;
+    }
+    if(sides & TFT_SIDE_POS) {
+        if(vertical) spanRect(c0, m + a, c1, hi, color);
+        else         spanRect(m + a, c0, hi, c1, color);
+    }
+    if(sides & TFT_SIDE_NEG) {
+        if(vertical) spanRect(c0, lo, c1, m - a, color);
+        else         spanRect(lo, c0, m - a, c1, color);
+    }
+}
+
+// Add row y with the columns x0..x1, following rows with the same columns
+// share one window
+static void spanAdd(TFT_span_t *s, int16_t y, int16_t x0, int16_t x1, TFT_color_t color){
+    if((s->y1 >= s->y0) && (s->x0 == x0) && (s->x1 == x1) && (s->y1 + 1 == y)) {
+        s->y1 = y;
+        return;
+    }
+    spanFlush(s, color);
+    s->x0 = x0;
+    s->x1 = x1;
+    s->y0 = s->y1 = y;
+}
+
+static void spanFlush(TFT_span_t *s, TFT_color_t color){
+    if(s->y1 >= s->y0)
+        spanRect(s->x0, s->y0, s->x1, s->y1, color);
+    s->y1 = s->y0 - 1;
+}
+
+// Midpoint circle like TFT_drawCircle, the points (x, y) of the octant above
+// the diagonal are handed on as runs a..b of the same y. a = 0 starts with
+// the points on the axes, a = 1 leaves them out like the helpers do.
+static void circleRuns(int16_t x0, int16_t y0, int16_t r, int16_t a, uint8_t cornername, int16_t delta, boolean_t fill, TFT_color_t color){
+    int16_t f     = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x     = 0;
+    int16_t y     = r;
+
+    while (x<y) {
+        if (f >= 0) {
+            // y changes, the run ends
+            if(fill) discRuns(x0, y0, a, x, y, cornername, delta, color);
+            else     arcRuns(x0, y0, a, x, y, cornername, color);
+            a = x + 1;
+            y--;
+            ddF_y += 2;
+            f     += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f     += ddF_x;
+    }
+    if(fill) discRuns(x0, y0, a, x, y, cornername, delta, color);
+    else     arcRuns(x0, y0, a, x, y, cornername, color);
+}
+
+// Outline: the run is a line on the rows y0-y and y0+y and on the columns
+// x0+y and x0-y, corners like TFT_drawCircleHelper
+static void arcRuns(int16_t x0, int16_t y0, int16_t a, int16_t b, int16_t y, uint8_t cornername, TFT_color_t color){
+    if(a > b) return;
+
+    spanMirror(x0, a, b, y0 - y, y0 - y, TFT_SIDES(cornername, 0x1, 0x2), FALSE, color);
+    if((y == 0) && (a == 0)) return;     // r = 0, a single pixel
+    spanMirror(x0, a, b, y0 + y, y0 + y, TFT_SIDES(cornername, 0x8, 0x4), FALSE, color);
+    spanMirror(y0, a, b, x0 + y, x0 + y, TFT_SIDES(cornername, 0x2, 0x4), TRUE, color);
+    spanMirror(y0, a, b, x0 - y, x0 - y, TFT_SIDES(cornername, 0x1, 0x8), TRUE, color);
+}
+
+// Filled: the columns x0+a..x0+b reach from row y0-y to y0+y+delta, the
+// column x0+y from y0-b to y0+b+delta, mirrored to the left for corner 0x2.
+// These are the pixels of the vertical lines of TFT_fillCircleHelper.
+static void discRuns(int16_t x0, int16_t y0, int16_t a, int16_t b, int16_t y, uint8_t cornername, int16_t delta, TFT_color_t color){
+    uint8_t sides = TFT_SIDES(cornername, 0x2, 0x1);
+
+    if(a > b) return;
+
+    spanMirror(x0, a, b, y0 - y, y0 + y + delta, sides, FALSE, color);
+    if(b > 0)
+        spanMirror(x0, y, y, y0 - b, y0 + b + delta, sides, FALSE, color);
+}
+#endif
+
+//----------------- Strip renderer
+
+void TFT_beginFrame(void){
+#if (CFG_TFT_STRIP == ON)
+    strip.open=TRUE;
+    strip.cnt=0;
+#endif
+}
+
+void TFT_endFrame(void){
+#if (CFG_TFT_STRIP == ON)
+    if(!strip.open)
+        return;
+    stripFlush();
+    strip.open=FALSE;
+#endif
+}
+
+#if (CFG_TFT_STRIP == ON)
+// Clip a dirty rectangle and append it with its colors, renders the list in
+// between if it or the palette is full. NULL if nothing of the rectangle is visible.
+static TFT_dirty_t* stripAdd(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color, TFT_color_t bg){
+    TFT_dirty_t *d;
+#if (CFG_TFT_STRIP_BPP < 16)
+    uint16_t    ci, bi;
+#endif
+
+    if(x < 0) { w += x; x = 0; }
+    if(y < 0) { h += y; y = 0; }
+    if((x + w) > _width)  w = _width - x;
+    if((y + h) > _height) h = _height - y;
+    if((w <= 0) || (h <= 0))
+        return NULL;
+
+#if (CFG_TFT_STRIP_BPP < 16)
+    ci = stripIndex(color);
+    bi = stripIndex(bg);
+    if((strip.cnt >= CFG_TFT_STRIP_CMDS) || (ci >= TFT_PALETTE_SZ) || (bi >= TFT_PALETTE_SZ)) {
+        stripFlush();
+        ci = stripIndex(color);
+        bi = stripIndex(bg);
+    }
+#else
+    if(strip.cnt >= CFG_TFT_STRIP_CMDS)
+        stripFlush();
+#endif
+
+    d = &strip.rect[strip.cnt++];
+    d->x = x;
+    d->y = y;
+    d->w = w;
+    d->h = h;
+    d->color = color;
+    d->bg    = bg;
+#if (CFG_TFT_STRIP_BPP < 16)
+    d->ci    = ci;
+    d->bi    = bi;
+#endif
+    return d;
+}
+
+#if (CFG_TFT_STRIP_BPP < 16)
+// Palette index of a color, a new color takes the next entry. TFT_PALETTE_SZ if the palette is full.
+static uint16_t stripIndex(TFT_color_t c){
+    uint16_t i;
+
+    for(i=0; (i<strip.colors) && (strip.palette[i] != c); i++);
+    if((i == strip.colors) && (i < TFT_PALETTE_SZ))
+        strip.palette[strip.colors++] = c;
+    return i;
+}
+#endif
+
+// Record a solid rectangle. FALSE if no frame is open, the caller draws immediately.
+static boolean_t stripFill(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color){
+    TFT_dirty_t *d;
+
+    if(!strip.open) {
+#if (CFG_TFT_STRIP_SKIP == ON)
+        strip.hashValid = FALSE;
+#endif
+        return FALSE;
+    }
+    if((d = stripAdd(x, y, w, h, color, color)) != NULL)
+        d->prim  = TFT_PRIM_FILL;
+    return TRUE;
+}
+
+// Record a character of the current font. FALSE if no frame is open.
+static boolean_t stripChar(int16_t x, int16_t y, unsigned char c, TFT_color_t color, TFT_color_t bg, uint8_t size){
+    TFT_dirty_t *d;
+    int16_t     ox = x, oy = y, w = 6 * size, h = 8 * size;
+
+    if(!strip.open) {
+#if (CFG_TFT_STRIP_SKIP == ON)
+        strip.hashValid = FALSE;
+#endif
+        return FALSE;
+    }
+    if(gfxFont) {
+        GFXglyph *glyph = &(((GFXglyph *)pgm_read_pointer(&gfxFont->glyph))[c - (uint8_t)pgm_read_byte(&gfxFont->first)]);
+        ox = x + (int8_t)pgm_read_byte(&glyph->xOffset) * size;
+        oy = y + (int8_t)pgm_read_byte(&glyph->yOffset) * size;
+        w  = pgm_read_byte(&glyph->width) * size;
+        h  = pgm_read_byte(&glyph->height) * size;
+    }
+    if((d = stripAdd(ox, oy, w, h, color, bg)) != NULL) {
+        d->prim  = gfxFont ? TFT_PRIM_GLYPH : TFT_PRIM_CHAR;
+        d->ox    = ox;
+        d->oy    = oy;
+        d->font  = gfxFont;
+        d->c     = c;
+        d->size  = size;
+    }
+    return TRUE;
+}
+
+// Paint the part of a primitive which falls into the strip starting at line s0
+static void stripRaster(const TFT_dirty_t *d, int16_t s0, int16_t n){
+    int16_t     y0 = (d->y > s0) ? d->y : s0;
+    int16_t     y1 = ((d->y + d->h) < (s0 + n)) ? d->y + d->h : s0 + n;
+    uint8_t     *bitmap = NULL;
+    uint16_t    bo = 0;
+    uint8_t     gw = 0;
+#if (CFG_TFT_FONT_RLE == ON)
+    boolean_t   rle = FALSE;
+#endif
+
+    if(d->prim == TFT_PRIM_GLYPH) {
+        GFXglyph *glyph = &(((GFXglyph *)pgm_read_pointer(&d->font->glyph))[d->c - (uint8_t)pgm_read_byte(&d->font->first)]);
+        bitmap = (uint8_t *)pgm_read_pointer(&d->font->bitmap);
+        bo = pgm_read_word(&glyph->bitmapOffset);
+        gw = pgm_read_byte(&glyph->width);
+#if (CFG_TFT_FONT_RLE == ON)
+        rle = (pgm_read_byte(&d->font->flags) & TFT_FONT_RLE) != 0;
+#endif
+    }
+
+    for(int16_t py=y0; py<y1; py++) {
+        uint8_t *buf  = strip.buf[py - s0];
+        uint8_t *mask = strip.mask[py - s0];
+        for(int16_t px=d->x; px<d->x+d->w; px++) {
+#if (CFG_TFT_STRIP_BPP < 16)
+            uint8_t     c = d->ci;
+#else
+            TFT_color_t c = d->color;
+#endif
+            if(d->prim == TFT_PRIM_CHAR) {
+                uint8_t i = (px - d->ox) / d->size, j = (py - d->oy) / d->size;
+                if(!((i < 5) && ((pgm_read_byte(&font[d->c * 5 + i]) >> j) & 1))) {
+                    if(d->bg == d->color) continue;    // Transparent
+#if (CFG_TFT_STRIP_BPP < 16)
+                    c = d->bi;
+#else
+                    c = d->bg;
+#endif
+                }
+            } else if(d->prim == TFT_PRIM_GLYPH) {
+                uint16_t  bit = ((py - d->oy) / d->size) * gw + (px - d->ox) / d->size;
+                boolean_t set;
+#if (CFG_TFT_FONT_RLE == ON)
+                if(rle)
+                    set = rlePixel(&bitmap[bo], bit);
+                else
+#endif
+                    set = (pgm_read_byte(&bitmap[bo + (bit >> 3)]) & (0x80 >> (bit & 7))) != 0;
+                if(!set)
+                    continue;
+            }
+#if (CFG_TFT_STRIP_BPP == 16)
+            buf[2 * px]     = c >> 8;
+            buf[2 * px + 1] = c;
+#elif (CFG_TFT_STRIP_BPP == 8)
+            buf[px]         = c;
+#else
+            buf[px >> 1]    = (px & 1) ? ((buf[px >> 1] & 0xF0) | c) : ((buf[px >> 1] & 0x0F) | (c << 4));
+#endif
+            mask[px >> 3]  |= 0x80 >> (px & 7);
+        }
+    }
+}
+
+// Send the written pixels of a strip. A fully covered rectangle goes out as
+// one address window, anything else as one window per run of a line.
+static void stripSend(uint8_t s, int16_t s0, int16_t n){
+    int16_t     x0 = _width, x1 = -1, r0 = -1, r1 = -1;
+    boolean_t   rect = TRUE;
+
+    for(int16_t r=0; r<n; r++) {
+        int16_t a = -1, b = -1, runs = 0;       // First run [a..b] and number of runs
+        for(int16_t px=0; px<=_width; px++) {
+            boolean_t set = (px < _width) && (strip.mask[r][px >> 3] & (0x80 >> (px & 7)));
+            if(set && ((px == 0) || !(strip.mask[r][(px - 1) >> 3] & (0x80 >> ((px - 1) & 7))))) {
+                if(runs++ == 0) a = px;
+            } else if(!set && (a >= 0) && (b < 0)) {
+                b = px - 1;
+            }
+        }
+        if(runs == 0) {
+            if((r0 >= 0) && (r1 < 0)) r1 = r - 1;   // End of the written lines
+            continue;
+        }
+        if(r0 < 0) {
+            r0 = r; x0 = a; x1 = b;
+        } else if((r1 >= 0) || (a != x0) || (b != x1)) {
+            rect = FALSE;                           // Gap between lines or different run
+        }
+        if(runs > 1) rect = FALSE;
+    }
+    if(r0 < 0)
+        return;                                     // Only transparent pixels
+    if(r1 < 0) r1 = n - 1;
+
+    if(rect) {
+#if (CFG_TFT_STRIP_SKIP == ON)
+        // Full width strips: skip the transfer if the content hash is unchanged
+        if((r0 == 0) && (r1 == n - 1) && (x0 == 0) && (x1 == _width - 1)) {
+            uint32_t h = 2166136261u;   // FNV-1a of the colors, palette indices differ between frames
+            for(int16_t r=0; r<n; r++) {
+                const uint8_t *p = stripLine(r, 0, _width - 1);
+                for(int16_t k=0; k<2*_width; k++)
+                    h = (h ^ p[k]) * 16777619u;
+            }
+            if(h == 0) h = 1;
+            if(h == strip.hash[s])
+                return;
+            strip.hash[s] = h;
+        } else {
+            strip.hash[s] = 0;
+        }
+#endif
+
+        setAddrWindow(x0, s0 + r0, x1, s0 + r1);
+#if (CFG_TFT_STRIP_BPP == 16)
+        if(2 * (x1 - x0 + 1) == (int16_t)sizeof(strip.buf[0])) {
+            // Full buffer lines are contiguous, one block for all of them
+            TFT_send_block(&strip.buf[r0][0], (r1 - r0 + 1) * sizeof(strip.buf[0]));
+            return;
+        }
+#endif
+        for(int16_t r=r0; r<=r1; r++)
+            TFT_send_block(stripLine(r, x0, x1), 2 * (x1 - x0 + 1));
+        return;
+    }
+
+#if (CFG_TFT_STRIP_SKIP == ON)
+    strip.hash[s] = 0;
+#endif
+    for(int16_t r=0; r<n; r++) {
+        int16_t a = -1;
+        for(int16_t px=0; px<=_width; px++) {
+            boolean_t set = (px < _width) && (strip.mask[r][px >> 3] & (0x80 >> (px & 7)));
+            if(set && (a < 0)) a = px;
+            if(!set && (a >= 0)) {
+                setAddrWindow(a, s0 + r, px - 1, s0 + r);
+                TFT_send_block(stripLine(r, a, px - 1), 2 * (px - a));
+                a = -1;
+            }
+        }
+    }
+}
+
+// Render the recorded primitives strip by strip and empty the list
+static void stripFlush(void){
+#if (CFG_TFT_STRIP_SKIP == ON)
+    if(!strip.hashValid) {
+        memset(strip.hash, 0, sizeof(strip.hash));
+        strip.hashValid = TRUE;
+    }
+#endif
+
+    for(uint8_t s=0; s*CFG_TFT_STRIP_LINES < _height; s++) {
+        int16_t   s0 = s * CFG_TFT_STRIP_LINES;
+        int16_t   n  = ((_height - s0) < CFG_TFT_STRIP_LINES) ? _height - s0 : CFG_TFT_STRIP_LINES;
+        boolean_t dirty = FALSE;
+
+        for(uint8_t k=0; k<strip.cnt; k++) {
+            const TFT_dirty_t *d = &strip.rect[k];
+            if((d->y < s0 + n) && (d->y + d->h > s0)) {
+                if(!dirty) {
+                    memset(strip.mask, 0, sizeof(strip.mask));
+                    dirty = TRUE;
+                }
+                stripRaster(d, s0, n);
+            }
+        }
+        if(dirty)
+            stripSend(s, s0, n);
+    }
+    strip.cnt = 0;
+#if (CFG_TFT_STRIP_BPP < 16)
+    strip.colors = 0;
+#endif
+}
+
+// RGB565 of the pixels x0..x1 of a strip line in SPI byte order. Palette
+// indices are expanded into the line buffer, it is sent before the next call.
+static const uint8_t* stripLine(int16_t r, int16_t x0, int16_t x1){
+#if (CFG_TFT_STRIP_BPP < 16)
+    uint8_t *p = strip.line;
+
+    for(int16_t px=x0; px<=x1; px++) {
+        TFT_color_t c = strip.palette[TFT_STRIP_INDEX(strip.buf[r], px)];
+        *p++ = c >> 8;
+        *p++ = c;
+    }
+    return strip.line;
+#else
+    (void)x1;
+    return &strip.buf[r][2 * x0];
+#endif
+}
+#endif
+
+//----------------- Bitmaps
+
+void TFT_drawBitmap565(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *bitmap){
+    int16_t  c0, c1, r0, r1;
+    uint16_t n = 0;
+
+    if((bitmap == NULL) || !blitWindow(x, y, w, h, &c0, &c1, &r0, &r1))
+        return;
+    for(int16_t r=r0; r<=r1; r++) {
+        const uint16_t *p = &bitmap[(int32_t)r * w];
+        for(int16_t c=c0; c<=c1; c++)
+            blitPut(&n, pgm_read_word(&p[c]));
+    }
+    if(n > 0)
+        TFT_send_block((const uint8_t*)blit, 2 * n);
+}
+
+void TFT_drawBitmap1(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *bitmap, TFT_color_t fg, TFT_color_t bg){
+    int16_t  c0, c1, r0, r1;
+    uint16_t n = 0;
+
+    if((bitmap == NULL) || !blitWindow(x, y, w, h, &c0, &c1, &r0, &r1))
+        return;
+    for(int16_t r=r0; r<=r1; r++) {
+        const uint8_t *p = &bitmap[(int32_t)r * ((w + 7) / 8)];
+        for(int16_t c=c0; c<=c1; c++)
+            blitPut(&n, (pgm_read_byte(&p[c >> 3]) & (0x80 >> (c & 7))) ? fg : bg);
+    }
+    if(n > 0)
+        TFT_send_block((const uint8_t*)blit, 2 * n);
+}
+
+RC_t TFT_drawBitmapStream(int16_t x, int16_t y, int16_t w, int16_t h, TFT_pixel_source_t source, void *arg){
+    int16_t   c0, c1, r0, r1;
+    int16_t   r = 0, c = 0;
+    uint32_t  left = (uint32_t)w * h;
+    boolean_t visible;
+
+    if(source == NULL)
+        return RC_ERROR_NULL;
+    if((w < 0) || (h < 0))
+        return RC_ERROR_BAD_PARAM;
+
+    // The source is drained also if nothing is visible
+    visible = blitWindow(x, y, w, h, &c0, &c1, &r0, &r1);
+    while(left > 0) {
+        uint16_t want = (left < CFG_TFT_BLIT_PX) ? left : CFG_TFT_BLIT_PX;
+        uint16_t got  = source(blit, want, arg);
+        uint16_t n    = 0;
+
+        if(got == 0)
+            break;
+        if(got > want)
+            got = want;
+        left -= got;
+
+        // Keep the visible pixels, n never passes i
+        for(uint16_t i=0; i<got; i++) {
+            if(visible && (r >= r0) && (r <= r1) && (c >= c0) && (c <= c1))
+                blitPut(&n, blit[i]);
+            if(++c == w) {
+                c = 0;
+                r++;
+            }
+        }
+        if(n > 0)
+            TFT_send_block((const uint8_t*)blit, 2 * n);
+    }
+    if(left == 0)
+        return RC_SUCCESS;
+
+    // Fill the rest of the window, the next pixels would land in the wrong place
+    if(visible && (r <= r1)) {
+        uint32_t px = 0;
+        if((r >= r0) && (c <= c1))
+            px = c1 - ((c > c0) ? c : c0) + 1;
+        r = (r + 1 > r0) ? r + 1 : r0;
+        if(r <= r1)
+            px += (uint32_t)(r1 - r + 1) * (c1 - c0 + 1);
+        if(px > 0)
+            TFT_send_repeat(0, px);
+    }
+    return RC_ERROR_BUFFER_EMTPY;
+}
+
+// Clip an image to the screen and open one address window for its visible
+// columns c0..c1 and rows r0..r1. FALSE if nothing is visible.
+static boolean_t blitWindow(int16_t x, int16_t y, int16_t w, int16_t h, int16_t *c0, int16_t *c1, int16_t *r0, int16_t *r1){
+    if((w <= 0) || (h <= 0) || (x >= _width) || (y >= (int16_t)_height) || (x + w <= 0) || (y + h <= 0))
+        return FALSE;
+    *c0 = (x < 0) ? -x : 0;
+    *r0 = (y < 0) ? -y : 0;
+    *c1 = (x + w > _width) ? _width - x - 1 : w - 1;
+    *r1 = (y + h > (int16_t)_height) ? (int16_t)_height - y - 1 : h - 1;
+#if (CFG_TFT_STRIP == ON)
+    if(strip.open)
+        stripFlush();               // The recorded primitives are below the image
+#if (CFG_TFT_STRIP_SKIP == ON)
+    strip.hashValid = FALSE;
+#endif
+#endif
+    setAddrWindow(x + *c0, y + *r0, x + *c1, y + *r1);
+    return TRUE;
+}
+
+// Append a pixel to the block buffer and send the buffer once it is full
+static void blitPut(uint16_t *n, TFT_color_t c){
+    uint8_t *p = (uint8_t*)&blit[*n];
+
+    p[0] = c >> 8;
+    p[1] = c;
+    if(++(*n) == CFG_TFT_BLIT_PX) {
+        TFT_send_block((const uint8_t*)blit, sizeof(blit));
+        *n = 0;
+    }
+}
+
+//----------------- Text fields
+
+TFT_field_t TFT_field_create(int16_t x, int16_t y, uint8_t width_chars, const GFXfont *font){
+    TFT_field_t      h;
+    TFT_field_data_t *f;
+
+    for(h=0; (h<CFG_TFT_FIELDS) && fields[h].len; h++);
+    if((h >= CFG_TFT_FIELDS) || (width_chars == 0))
+        return TFT_FIELD_INVALID;
+
+    f = &fields[h];
+    f->x     = x;
+    f->y     = y;
+    f->font  = font;
+    f->color = color;
+    f->bg    = bgcolor;
+    f->size  = textsize;
+    f->len   = (width_chars > CFG_TFT_FIELD_LEN) ? CFG_TFT_FIELD_LEN : width_chars;
+    f->valid = FALSE;
+
+    if(!font) {
+        f->pitch = 6 * textsize;
+    } else {
+        // Fixed pitch of the widest glyph, cell box over all glyphs
+        GFXglyph *glyph = (GFXglyph *)pgm_read_pointer(&font->glyph);
+        uint8_t  n = pgm_read_byte(&font->last) - pgm_read_byte(&font->first) + 1;
+        int16_t  top = 0, bottom = 0, pitch = 0;
+        for(uint8_t i=0; i<n; i++) {
+            int8_t  yo = pgm_read_byte(&glyph[i].yOffset);
+            uint8_t xa = pgm_read_byte(&glyph[i].xAdvance);
+            if(yo < top) top = yo;
+            if(yo + pgm_read_byte(&glyph[i].height) > bottom) bottom = yo + pgm_read_byte(&glyph[i].height);
+            if(xa > pitch) pitch = xa;
+        }
+        f->pitch  = pitch * textsize;
+        f->top    = top;
+        f->height = bottom - top;
+    }
+    return h;
+}
+
+RC_t TFT_field_set(TFT_field_t field, const char *text){
+    TFT_field_data_t *f;
+    GFXfont          *prev = gfxFont;
+    uint8_t          first = 0, last = 0;
+
+    if((field >= CFG_TFT_FIELDS) || !fields[field].len)
+        return RC_ERROR_BAD_PARAM;
+    if(!text)
+        return RC_ERROR_NULL;
+
+    f = &fields[field];
+    if(f->font) {
+        first = pgm_read_byte(&f->font->first);
+        last  = pgm_read_byte(&f->font->last);
+    }
+    gfxFont = (GFXfont *)f->font;       // TFT_drawChar renders with the current font
+    for(uint8_t i=0; i<f->len; i++) {
+        unsigned char c = *text ? *text++ : ' ';
+        int16_t       cx = f->x + i * f->pitch;
+
+        // Characters outside a subset font are blanks, a blank without
+        // a glyph only erases the cell
+        if(f->font && ((c < first) || (c > last)))
+            c = ' ';
+        if(f->valid && (f->shown[i] == c))
+            continue;
+
+        if(!f->font) {
+            // Opaque cell, covers the old character
+            TFT_drawChar(cx, f->y, c, f->color, f->bg, f->size);
+        } else {
+            // Glyphs are transparent: erase the old one with its own pixels
+            if(!f->valid)
+                TFT_fillRect(cx, f->y + f->top * f->size, f->pitch, f->height * f->size, f->bg);
+            else if(((unsigned char)f->shown[i] >= first) && ((unsigned char)f->shown[i] <= last))
+                TFT_drawChar(cx, f->y, f->shown[i], f->bg, f->bg, f->size);
+            if((c >= first) && (c <= last))
+                TFT_drawChar(cx, f->y, c, f->color, f->color, f->size);
+        }
+        f->shown[i] = c;
+    }
+    gfxFont = prev;
+    f->valid = TRUE;
+    return RC_SUCCESS;
+}
+
+void TFT_field_invalidate(TFT_field_t field){
+    if(field < CFG_TFT_FIELDS)
+        fields[field].valid = FALSE;
+}
+
+//----------------- Console
+
+RC_t TFT_console_start(uint8_t top, uint8_t bottom){
+#if (CFG_TFT_CONSOLE == ON)
+    uint8_t  height = 8 * textsize;
+    uint16_t area, bfa;
+
+#if (CFG_TFT_STRIP == ON)
+    if(strip.open)
+        return RC_ERROR_INVALID_STATE;
+#endif
+    // MY and MV map the screen rows to other memory rows or columns
+    if((rotation != TFT_rot_180) || (top + bottom + height > _height))
+        return RC_ERROR_BAD_PARAM;
+
+    console.active = TRUE;
+    console.top    = top;
+    console.height = height;
+    console.rows   = _height - top - bottom;
+    console.lines  = console.rows / height;
+    console.used   = 0;
+    console.first  = 0;
+    console.size   = textsize;
+    console.color  = color;
+    console.bg     = bgcolor;
+    TFT_fillRect(0, top, _width, console.rows, bgcolor);
+
+    // Top fixed, scroll and bottom fixed area, the rest of the frame memory joins the bottom
+    area = console.lines * height;
+    bfa  = CFG_TFT_SCROLL_LINES - (top + ystart) - area;
+    TFT_write_cmd(ST7735_SCRLAR);
+    TFT_write_data(0x00);
+    TFT_write_data(top + ystart);
+    TFT_write_data(area >> 8);
+    TFT_write_data(area & 0xFF);
+    TFT_write_data(bfa >> 8);
+    TFT_write_data(bfa & 0xFF);
+    consoleScroll(top + ystart);
+    return RC_SUCCESS;
+#else
+    return RC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+RC_t TFT_console_print(const char *text){
+#if (CFG_TFT_CONSOLE == ON)
+    GFXfont *prev = gfxFont;
+    uint8_t  cw = 6 * console.size;
+
+    if(!console.active)
+        return RC_ERROR_INVALID_STATE;
+    if(!text)
+        return RC_ERROR_NULL;
+
+    gfxFont = NULL;                     // TFT_drawChar renders with the current font
+    do {
+        uint8_t   slot;
+        int16_t   x = 0, y;
+        boolean_t full = (console.used == console.lines);
+
+        if(!full) {
+            slot = console.used++;
+        } else {
+            // The oldest line is at the top, overwrite it and move it to the bottom
+            slot = console.first;
+            console.first = (console.first + 1) % console.lines;
+        }
+        y = console.top + slot * console.height;
+        for(; *text && (*text != '\n'); text++) {
+            if(x + cw <= _width) {
+                TFT_drawChar(x, y, *text, console.color, console.bg, console.size);
+                x += cw;
+            }
+        }
+        if(x < _width)
+            TFT_fillRect(x, y, _width - x, console.height, console.bg);
+        if(full)
+            consoleScroll(console.top + ystart + console.first * console.height);
+    } while((*text == '\n') && *(++text));
+    gfxFont = prev;
+    return RC_SUCCESS;
+#else
+    return RC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+void TFT_console_stop(void){
+#if (CFG_TFT_CONSOLE == ON)
+    if(!console.active)
+        return;
+    TFT_write_cmd(ST7735_NORON);        // Leaves the scroll mode
+    console.active = FALSE;
+    TFT_fillRect(0, console.top, _width, console.rows, console.bg);
+#endif
+}
+
+#if (CFG_TFT_CONSOLE == ON)
+static void consoleScroll(uint16_t ssa){
+    TFT_write_cmd(ST7735_VSCSAD);       // Memory row shown at the top of the scroll area
+    TFT_write_data(ssa >> 8);
+    TFT_write_data(ssa & 0xFF);
+}
+#endif
+
+//----------------- Draw queue
+
+RC_t TFT_queue_fill(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color){
+#if (CFG_TFT_QUEUE == ON)
+    TFT_queue_cmd_t c;
+
+    if((w <= 0) || (h <= 0))
+        return RC_ERROR_BAD_PARAM;
+    c.kind  = TFT_QUEUE_FILL;
+    c.x     = x;
+    c.y     = y;
+    c.w     = w;
+    c.h     = h;
+    c.color = color;
+    c.bg    = color;
+    return queuePut(&c);
+#else
+    return RC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+RC_t TFT_queue_text(int16_t x, int16_t y, const char *text, TFT_color_t color, TFT_color_t bg, uint8_t size){
+#if (CFG_TFT_QUEUE == ON)
+    TFT_queue_cmd_t c;
+
+    if(!text)
+        return RC_ERROR_NULL;
+    if(size == 0)
+        return RC_ERROR_BAD_PARAM;
+    for(c.len=0; (c.len<CFG_TFT_QUEUE_TEXT) && text[c.len]; c.len++)
+        c.arg.text[c.len] = text[c.len];
+    c.kind  = TFT_QUEUE_TEXT;
+    c.size  = size;
+    c.x     = x;
+    c.y     = y;
+    c.w     = c.len * 6 * size;
+    c.h     = 8 * size;
+    c.color = color;
+    c.bg    = bg;
+    return queuePut(&c);
+#else
+    return RC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+RC_t TFT_queue_number(int16_t x, int16_t y, int32_t value, uint8_t digits, TFT_color_t color, TFT_color_t bg, uint8_t size){
+#if (CFG_TFT_QUEUE == ON)
+    TFT_queue_cmd_t c;
+
+    if((digits == 0) || (digits > 11) || (size == 0))
+        return RC_ERROR_BAD_PARAM;
+    c.kind      = TFT_QUEUE_NUMBER;
+    c.size      = size;
+    c.len       = digits;
+    c.x         = x;
+    c.y         = y;
+    c.w         = digits * 6 * size;
+    c.h         = 8 * size;
+    c.color     = color;
+    c.bg        = bg;
+    c.arg.value = value;
+    return queuePut(&c);
+#else
+    return RC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+uint8_t TFT_queue_render(void){
+#if (CFG_TFT_QUEUE == ON)
+    uint8_t drawn = 0;
+    uint8_t irq = CyEnterCriticalSection();
+    uint8_t n = queue.fill;
+
+    CyExitCriticalSection(irq);
+    // Producers only write free entries, the batch stays in place until it is released
+    while(n) {
+        queueMerge(n);
+        for(uint8_t i=0; i<n; i++) {
+            const TFT_queue_cmd_t *c = &queue.cmd[(queue.read + i) % CFG_TFT_QUEUE_CMDS];
+            if(c->drop) {
+                queue.dropped++;
+            } else {
+                queueDraw(c);
+                queue.drawn++;
+                drawn++;
+            }
+        }
+        irq = CyEnterCriticalSection();
+        queue.read  = (queue.read + n) % CFG_TFT_QUEUE_CMDS;
+        queue.fill -= n;
+        n = queue.fill;             // Queued without an event while the batch was drawn
+        CyExitCriticalSection(irq);
+    }
+    return drawn;
+#else
+    return 0;
+#endif
+}
+
+void TFT_getQueueStats(uint32_t *drawn, uint32_t *dropped){
+#if (CFG_TFT_QUEUE == ON)
+    if(drawn)   *drawn=queue.drawn;
+    if(dropped) *dropped=queue.dropped;
+#else
+    if(drawn)   *drawn=0;
+    if(dropped) *dropped=0;
+#endif
+}
+
+#if (CFG_TFT_QUEUE == ON)
+static RC_t queuePut(TFT_queue_cmd_t *c){
+    uint8_t irq = CyEnterCriticalSection();
+    uint8_t fill = queue.fill;
+
+    if(fill >= CFG_TFT_QUEUE_CMDS) {
+        CyExitCriticalSection(irq);
+        return RC_ERROR_BUFFER_FULL;
+    }
+    c->drop = FALSE;
+    queue.cmd[queue.write] = *c;
+    queue.write = (queue.write + 1) % CFG_TFT_QUEUE_CMDS;
+    queue.fill++;
+    CyExitCriticalSection(irq);
+
+    // One event per batch, the render task drains until the queue is empty
+    if(fill == 0)
+        SetEvent(CFG_TFT_QUEUE_TASK, CFG_TFT_QUEUE_EVENT);
+    return RC_SUCCESS;
+}
+
+static void queueMerge(uint8_t n){
+    for(uint8_t i=0; i<n; i++) {
+        TFT_queue_cmd_t *a = &queue.cmd[(queue.read + i) % CFG_TFT_QUEUE_CMDS];
+
+        for(uint8_t j=i+1; (j<n) && !a->drop; j++) {
+            const TFT_queue_cmd_t *b = &queue.cmd[(queue.read + j) % CFG_TFT_QUEUE_CMDS];
+
+            // Opaque text cells and fills cover their whole box
+            if((b->kind != TFT_QUEUE_FILL) && (b->color == b->bg))
+                continue;
+            a->drop = (b->x <= a->x) && (b->y <= a->y) && (b->x + b->w >= a->x + a->w) && (b->y + b->h >= a->y + a->h);
+        }
+    }
+}
+
+static void queueDraw(const TFT_queue_cmd_t *c){
+    GFXfont    *prev = gfxFont;
+    char        num[12];
+    const char *text = c->arg.text;
+
+    if(c->kind == TFT_QUEUE_FILL) {
+        TFT_fillRect(c->x, c->y, c->w, c->h, c->color);
+        return;
+    }
+    if(c->kind == TFT_QUEUE_NUMBER) {
+        if(snprintf(num, sizeof(num), "%*ld", c->len, (long)c->arg.value) > c->len)
+            memset(num, '#', c->len);
+        text = num;
+    }
+    gfxFont = NULL;                     // TFT_drawChar renders with the current font
+    for(uint8_t i=0; i<c->len; i++)
+        TFT_drawChar(c->x + i * 6 * c->size, c->y, text[i], c->color, c->bg, c->size);
+    gfxFont = prev;
+}
+#endif
+
+//----------------- Glyph cache
+
+void TFT_clearGlyphCache(void){
+#if (CFG_TFT_GLYPH_CACHE == ON)
+    for(uint8_t b=0; b<TFT_GLYPH_BLOCKS; b++) {
+        glyphCache.next[b]=b+1;
+        glyphCache.entry[b].used=0;
+    }
+    glyphCache.next[TFT_GLYPH_BLOCKS-1]=TFT_GLYPH_NONE;
+    glyphCache.free=0;
+    glyphCache.freeCnt=TFT_GLYPH_BLOCKS;
+#endif
+}
+
+void TFT_getGlyphCacheStats(uint32_t *hits, uint32_t *misses){
+#if (CFG_TFT_GLYPH_CACHE == ON)
+    if(hits)   *hits=glyphCache.hits;
+    if(misses) *misses=glyphCache.misses;
+#else
+    if(hits)   *hits=0;
+    if(misses) *misses=0;
+#endif
+}
+
+#if (CFG_TFT_GLYPH_CACHE == ON)
+// Give the blocks of a glyph back to the free chain
+static void glyphCacheRelease(TFT_glyph_t *g){
+    uint8_t b=g->block, n=1;
+
+    while(glyphCache.next[b]!=TFT_GLYPH_NONE) {
+        b=glyphCache.next[b];
+        n++;
+    }
+    glyphCache.next[b]=glyphCache.free;
+    glyphCache.free=g->block;
+    glyphCache.freeCnt+=n;
+    g->used=0;
+}
+
+// Look up a glyph, expand it on a miss. NULL if it does not fit into the budget at all.
+static TFT_glyph_t* glyphCacheGet(unsigned char c, TFT_color_t color, TFT_color_t bg, uint8_t size){
+    TFT_glyph_t *g, *slot=NULL;
+    uint16_t need=(uint16_t)size*size;
+
+    if(need>TFT_GLYPH_BLOCKS)
+        return NULL;
+
+    glyphCache.clock++;
+    for(g=glyphCache.entry; g<&glyphCache.entry[TFT_GLYPH_BLOCKS]; g++) {
+        if(!g->used) {
+            if(!slot) slot=g;
+        } else if((g->c==c) && (g->size==size) && (g->color==color) && (g->bg==bg)) {
+            g->used=glyphCache.clock;
+            glyphCache.hits++;
+            return g;
+        }
+    }
+    glyphCache.misses++;
+
+    // Evict the least recently used glyphs until the new one fits. Every
+    // entry holds at least one block, so a free entry exists afterwards.
+    while(glyphCache.freeCnt<need) {
+        TFT_glyph_t *lru=NULL;
+        for(g=glyphCache.entry; g<&glyphCache.entry[TFT_GLYPH_BLOCKS]; g++)
+            if(g->used && (!lru || (g->used<lru->used)))
+                lru=g;
+        glyphCacheRelease(lru);
+        if(!slot) slot=lru;
+    }
+
+    // Take the chain from the free list
+    uint8_t b=glyphCache.free;
+    for(uint16_t n=need-1; n>0; n--)
+        b=glyphCache.next[b];
+    slot->block=glyphCache.free;
+    glyphCache.free=glyphCache.next[b];
+    glyphCache.next[b]=TFT_GLYPH_NONE;
+    glyphCache.freeCnt-=need;
+
+    slot->used=glyphCache.clock;
+    slot->c=c;
+    slot->size=size;
+    slot->color=color;
+    slot->bg=bg;
+
+    // Expand in raster order of the address window, a block holds whole pixels
+    uint8_t cols[6], k=0;
+    uint8_t fhi = color >> 8, flo = color, bhi = bg >> 8, blo = bg;
+    uint8_t *p;
+
+    for(int8_t i=0; i<5; i++)
+        cols[i] = pgm_read_byte(&font[c * 5 + i]);
+    cols[5] = 0;                        // Spacing column
+
+    b=slot->block;
+    p=glyphCache.pool[b];
+    for(int8_t j=0; j<8; j++) {
+        for(uint8_t sy=size; sy>0; sy--) {
+            for(int8_t i=0; i<6; i++) {
+                boolean_t set = (cols[i] >> j) & 1;
+                for(uint8_t sx=size; sx>0; sx--) {
+                    if(k==TFT_GLYPH_BLOCK_SZ) {
+                        b=glyphCache.next[b];
+                        p=glyphCache.pool[b];
+                        k=0;
+                    }
+                    p[k++] = set ? fhi : bhi;
+                    p[k++] = set ? flo : blo;
+                }
+            }
+        }
+    }
+    return slot;
+}
+#endif
+
+#if (CFG_TFT_GFX_SPANS == ON) || (CFG_TFT_FONT_RLE == ON)
+// Fill one run of set glyph bits. fastHLine and fillRect only clip right and
+// bottom, glyphs of custom fonts may start left of or above the screen.
+static void charSpan(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color){
+    if(x < 0) { w += x; x = 0; }
+    if(y < 0) { h += y; y = 0; }
+    if((w <= 0) || (h <= 0))
+        return;
+
+    if(h == 1) TFT_fastHLine(x, y, w, color);
+    else       TFT_fillRect(x, y, w, h, color);
+}
+#endif
+
+#if (CFG_TFT_FONT_RLE == ON) && (CFG_TFT_STRIP == ON)
+// Test one pixel of a run length coded glyph for the strip renderer, walks the runs up to it
+static boolean_t rlePixel(const uint8_t *p, uint16_t bit){
+    uint16_t pos = 0;
+    uint8_t  pair;
+
+    while((pair = pgm_read_byte(p++)) != 0) {
+        pos += pair >> 4;
+        if(bit < pos) return FALSE;
+        pos += pair & 0x0F;
+        if(bit < pos) return TRUE;
+    }
+    return FALSE;
+}
+#endif
+
 // Draw a character
 void TFT_drawChar(int16_t x, int16_t y, unsigned char c,  TFT_color_t color, TFT_color_t bg, uint8_t size) {
 
+#if (CFG_TFT_STRIP == ON)
+    if(stripChar(x, y, c, color, bg, size)) return;
+#endif
+
     if(!gfxFont) { // 'Classic' built-in font
 
         if((x >= _width)            || // Clip right
@@ -879,6 +3027,44 @@ void TFT_drawChar(int16_t x, int16_t y, unsigned char c,  TFT_color_t color, TFT
            ((y + 8 * size - 1) < 0))   // Clip top
             return;
 
+        // Opaque and fully visible: one address window for the whole 6x8
+        // cell (scaled), all pixels streamed in raster order.
+        if((bg != color) && (x >= 0) && (y >= 0) &&
+           ((x + 6 * size) <= _width) && ((y + 8 * size) <= _height)) {
+#if (CFG_TFT_GLYPH_CACHE == ON)
+            // Cached glyphs are a plain memory to SPI stream
+            TFT_glyph_t *g = glyphCacheGet(c, color, bg, size);
+            if(g) {
+                setAddrWindow(x, y, x + 6 * size - 1, y + 8 * size - 1);
+
+                for(uint8_t b=g->block; b!=TFT_GLYPH_NONE; b=glyphCache.next[b])
+                    TFT_send_block(glyphCache.pool[b], TFT_GLYPH_BLOCK_SZ);
+                return;
+            }
+#endif
+            uint8_t cols[6];
+            uint8_t fhi = color >> 8, flo = color, bhi = bg >> 8, blo = bg;
+
+            for(int8_t i=0; i<5; i++)
+                cols[i] = pgm_read_byte(&font[c * 5 + i]);
+            cols[5] = 0;                // Spacing column
+
+            setAddrWindow(x, y, x + 6 * size - 1, y + 8 * size - 1);
+
+            for(int8_t j=0; j<8; j++) {
+                for(uint8_t sy=size; sy>0; sy--) {
+                    for(int8_t i=0; i<6; i++) {
+                        boolean_t set = (cols[i] >> j) & 1;
+                        for(uint8_t sx=size; sx>0; sx--) {
+                            TFT_write_stream(set ? fhi : bhi);
+                            TFT_write_stream(set ? flo : blo);
+                        }
+                    }
+                }
+            }
+            return;
+        }
+
         for(int8_t i=0; i<5; i++ ) { // Char bitmap = 5 columns
             uint8_t line = pgm_read_byte(&font[c * 5 + i]);
             for(int8_t j=0; j<8; j++, line >>= 1) {
@@ -915,7 +3101,8 @@ void TFT_drawChar(int16_t x, int16_t y, unsigned char c,  TFT_color_t color, TFT
                  h  = pgm_read_byte(&glyph->height);
         int8_t   xo = pgm_read_byte(&glyph->xOffset),
                  yo = pgm_read_byte(&glyph->yOffset);
-        uint8_t  xx, yy, bits = 0, bit = 0;
+        uint8_t  yy, bits = 0, bit = 0;
+        uint16_t xx;
         int16_t  xo16 = 0, yo16 = 0;
 
         if(size > 1) {
@@ -940,6 +3127,58 @@ void TFT_drawChar(int16_t x, int16_t y, unsigned char c,  TFT_color_t color, TFT
         // this (a canvas object type for MCUs that can afford the RAM and
         // displays supporting setAddrWindow() and pushColors()), but haven't
         // implemented this yet.
+#if (CFG_TFT_FONT_RLE == ON)
+        if(pgm_read_byte(&gfxFont->flags) & TFT_FONT_RLE) {
+            // Runs come from the font. Set runs continued over several
+            // pairs are merged, a run wrapping into the next row is cut.
+            int16_t  gx = x + xo * size, gy = y + yo * size;
+            uint16_t pos = 0, run = 0, end = (uint16_t)w * h;
+
+            for(;;) {
+                uint8_t pair = (pos < end) ? pgm_read_byte(&bitmap[bo++]) : 0;
+                if(!pair || (pair >> 4)) {
+                    while(run < pos) {  // Set pixels run..pos-1
+                        uint8_t col = run % w;
+                        uint8_t len = ((pos - run) < (uint16_t)(w - col)) ? (pos - run) : (w - col);
+                        charSpan(gx + col * size, gy + (run / w) * size, len * size, size, color);
+                        run += len;
+                    }
+                    if(!pair) break;
+                    pos += pair >> 4;
+                    run  = pos;
+                }
+                pos += pair & 0x0F;
+            }
+            return;
+        }
+#endif
+#if (CFG_TFT_GFX_SPANS == ON)
+        // One address window per horizontal run of set bits
+        for(yy=0; yy<h; yy++) {
+            int16_t run = -1;           // Start of the current run
+            for(xx=0; xx<=w; xx++) {
+                boolean_t set = FALSE;
+                if(xx < w) {
+                    if(!(bit++ & 7)) {
+                        bits = pgm_read_byte(&bitmap[bo++]);
+                    }
+                    set = (bits & 0x80) != 0;
+                    bits <<= 1;
+                }
+                if(set) {
+                    if(run < 0) run = xx;
+                } else if(run >= 0) {
+                    if(size == 1) {
+                        charSpan(x+xo+run, y+yo+yy, xx-run, 1, color);
+                    } else {
+                        charSpan(x+(xo16+run)*size, y+(yo16+yy)*size,
+                          (xx-run)*size, size, color);
+                    }
+                    run = -1;
+                }
+            }
+        }
+#else
         for(yy=0; yy<h; yy++) {
             for(xx=0; xx<w; xx++) {
                 if(!(bit++ & 7)) {
@@ -956,6 +3195,7 @@ void TFT_drawChar(int16_t x, int16_t y, unsigned char c,  TFT_color_t color, TFT
                 bits <<= 1;
             }
         }
+#endif
 
     } // End classic vs custom font
 }
@@ -37,15 +37,76 @@
 #endif
 
 #define CFG_TFT_ORIENTATION         TFT_rot_180  
-#define CFG_TFT_RB_OUT_SZ           100                     /**< \brief TFT Ringbuffer OUT size for SPI communication*/
+#define CFG_TFT_RB_OUT_SZ           800                     /**< \brief TFT Ringbuffer OUT size in bytes for SPI communication, holds packed command and data records*/
 #define CFG_TFT_BACKLIGHT           100                     /**< \brief TFT backlight brightness after start (0-100). Can be adjusted with #TFT_setBacklight during runtime*/
 #define CFG_TFT_SPRINTF_BUF_L       128                     /**< \brief Buffer length for #TFT_printf */   
 #define CFG_TFT_COLOR_TEXT          WHITE                   /**< \brief Default text color */
 #define CFG_TFT_COLOR_TEXTBG        BLACK                   /**< \brief Default text background color */
+#ifndef CFG_TFT_GLYPH_CACHE
+#define CFG_TFT_GLYPH_CACHE         ON                      /**< \brief Keep recently drawn classic font glyphs expanded to RGB565 in RAM (ON/OFF)*/
+#endif
+#define CFG_TFT_GLYPH_CACHE_BYTES   4608                    /**< \brief RAM budget of the glyph cache, a glyph needs 96 * size^2 bytes*/
+#ifndef CFG_TFT_GFX_SPANS
+#define CFG_TFT_GFX_SPANS           ON                      /**< \brief Draw custom font glyphs as horizontal runs instead of single pixels (ON/OFF)*/
+#endif
+#ifndef CFG_TFT_FONT_RLE
+#define CFG_TFT_FONT_RLE            ON                      /**< \brief Decode run length coded custom fonts (#TFT_FONT_RLE) straight into runs (ON/OFF). OFF saves the decoder, such fonts must not be used then*/
+#endif
+#ifndef CFG_TFT_SHAPE_SPANS
+#define CFG_TFT_SHAPE_SPANS         ON                      /**< \brief Draw lines, circles, round rects and triangles as merged spans and skip unchanged CASET/RASET (ON/OFF)*/
+#endif
+#ifndef CFG_TFT_STRIP
+#define CFG_TFT_STRIP               ON                      /**< \brief Strip renderer for #TFT_beginFrame / #TFT_endFrame (ON/OFF)*/
+#endif
+#define CFG_TFT_STRIP_LINES         8                       /**< \brief Lines per strip, the strip buffer takes lines * 160 * #CFG_TFT_STRIP_BPP / 8 bytes*/
+#ifndef CFG_TFT_STRIP_BPP
+#define CFG_TFT_STRIP_BPP           16                      /**< \brief Bits per strip pixel: 16 = RGB565, 8 or 4 = index into a palette of the frame colors, expanded to RGB565 line by line while sending. A frame with more than 256 or 16 colors is rendered in between*/
+#endif
+#define CFG_TFT_STRIP_CMDS          48                      /**< \brief Primitives recorded per frame, a full list is rendered in between*/
+#ifndef CFG_TFT_STRIP_SKIP
+#define CFG_TFT_STRIP_SKIP          OFF                     /**< \brief Skip full width strips whose 32 bit hash equals the one of the last frame (ON/OFF). A hash collision leaves stale pixels until the strip changes again*/
+#endif
+#define CFG_TFT_FIELDS              24                      /**< \brief Number of text fields, see #TFT_field_create. Every ui label and number takes one*/
+#define CFG_TFT_FIELD_LEN           21                      /**< \brief Maximum width of a text field in characters*/
+#ifndef CFG_TFT_CONSOLE
+#define CFG_TFT_CONSOLE             ON                      /**< \brief Console mode with the hardware vertical scrolling, see #TFT_console_start (ON/OFF)*/
+#endif
+#define CFG_TFT_SCROLL_LINES        162                     /**< \brief Lines of the controller frame memory, the three scroll areas have to add up to it*/
+#define CFG_TFT_BLIT_PX             64                      /**< \brief Pixels converted per block by the bitmap functions, the block buffer takes twice as many bytes*/
+#ifndef CFG_TFT_QUEUE
+#define CFG_TFT_QUEUE               ON                      /**< \brief Draw command queue, other tasks enqueue and #CFG_TFT_QUEUE_TASK draws, see #TFT_queue_render (ON/OFF)*/
+#endif
+#define CFG_TFT_QUEUE_CMDS          16                      /**< \brief Commands in the draw queue, a command takes 28 bytes*/
+#define CFG_TFT_QUEUE_TEXT          12                      /**< \brief Characters of a queued text, longer texts are cut*/
+#define CFG_TFT_QUEUE_TASK          tsk_tft                 /**< \brief Task which calls #TFT_queue_render, set #CFG_TFT_QUEUE_EVENT by the first command of a batch*/
+#define CFG_TFT_QUEUE_EVENT         ev_tft                  /**< \brief OSEK event of #CFG_TFT_QUEUE_TASK for queued commands, may be shared with its other notifications*/
+#ifndef CFG_TFT_BOUNDS_CACHE
+#define CFG_TFT_BOUNDS_CACHE        8                       /**< \brief Strings remembered by #TFT_getTextBounds with font and size (0 = no cache), an entry takes 20 + #CFG_TFT_BOUNDS_LEN bytes*/
+#endif
+#define CFG_TFT_BOUNDS_LEN          16                      /**< \brief Longest string kept by the #TFT_getTextBounds cache, longer ones are measured every time*/
 
 #define CFG_TFT_WIDTH               128                     /**< \brief TFT width, 128px for our CP11001*/
 #define CFG_TFT_HEIGHT              160                     /**< \brief TFT height, 160px for our CP11001*/
 #define CFG_TFT_SPI_MODULE          TFT_SPI                 /**< \brief Module Name of the SPI, which serves the TFT*/
+#ifndef CFG_TFT_SPI_TX_IRQ
+#define CFG_TFT_SPI_TX_IRQ          OFF                     /**< \brief Feed the SPI TX FIFO from its interrupt (ON) or by polling (OFF). ON needs an isr component on the tx_interrupt terminal of the SPI*/
+#endif
+#define CFG_TFT_TX_ISR_MODULE       isr_tftTx               /**< \brief Module Name of the isr component of the SPI TX interrupt*/
+#ifndef CFG_TFT_TX_BLOCKING
+#define CFG_TFT_TX_BLOCKING         OFF                     /**< \brief With #CFG_TFT_SPI_TX_IRQ: #CFG_TFT_TX_TASK sleeps on #CFG_TFT_TX_EVENT while the ringbuffer is full instead of halting the CPU with WFI (ON/OFF). ON needs the TX interrupt as category 2 ISR isr_tftTx, see #TFT_txIsr*/
+#endif
+#define CFG_TFT_TX_TASK             tsk_tft                 /**< \brief Extended task which sleeps on #CFG_TFT_TX_EVENT for room in the ringbuffer, other callers serve the SPI themselves*/
+#define CFG_TFT_TX_EVENT            ev_tft                  /**< \brief OSEK event set by the TX interrupt at the low watermark, may be shared with other notifications of #CFG_TFT_TX_TASK*/
+#define CFG_TFT_RB_OUT_LOW          (CFG_TFT_RB_OUT_SZ / 4) /**< \brief Low watermark of the ringbuffer in bytes, wakes #CFG_TFT_TX_TASK*/
+#ifndef CFG_TFT_DMA
+#define CFG_TFT_DMA                 OFF                     /**< \brief Stream fills and pixel blocks with DMA (ON/OFF). ON needs a DMA component on the tx_interrupt terminal (TX FIFO not full, level) and the category 2 ISR isr_tftDma on its nrq, excludes #CFG_TFT_SPI_TX_IRQ*/
+#endif
+#define CFG_TFT_DMA_MODULE          TFT_TxDma               /**< \brief Module Name of the DMA component, which feeds the SPI TX FIFO*/
+#define CFG_TFT_DMA_TDS             16                      /**< \brief Transfer descriptors of one chain, a chain sends up to 4094 bytes per TD*/
+#define CFG_TFT_DMA_MIN_BYTES       64                      /**< \brief Shorter blocks are written by the CPU, below this the DMA setup costs more than it saves*/
+#define CFG_TFT_DMA_FILL_PX         160                     /**< \brief Pixels of the pattern line which is repeated by the TDs of a fill, one display line*/
+#define CFG_TFT_DMA_TASK            tsk_tft                 /**< \brief Extended task which sleeps on #CFG_TFT_DMA_EVENT while a transfer runs, other callers sleep with WFI*/
+#define CFG_TFT_DMA_EVENT           ev_tft                  /**< \brief OSEK event set at the end of a transfer, may be shared with other notifications of #CFG_TFT_DMA_TASK*/
 #define CFG_TFT_LED_MODULE          TFT_BackLight           /**< \brief Module Name of the PWM, which serves the TFT Backlight*/
 #define CFG_TFT_DC_PIN              TFT_DC                  /**< \brief Pin Name of the DC pin*/
 #define CFG_TFT_RES_PIN             TFT_RES                 /**< \brief Pin Name of the RES pin*/
@@ -55,6 +116,15 @@
 
 typedef uint16_t TFT_color_t;
 
+typedef uint8_t TFT_field_t;                                /**< \brief Handle of a text field, see #TFT_field_create*/
+#define TFT_FIELD_INVALID           0xFF                    /**< \brief No text field*/
+
+/**
+* \brief Source of #TFT_drawBitmapStream: stores up to n RGB565 pixels of the image in row order and returns
+*        how many it stored, 0 = no more data. Must not call TFT functions.
+*/
+typedef uint16_t (*TFT_pixel_source_t)(TFT_color_t *pixels, uint16_t n, void *arg);
+
 /** 
 * \brief Data stored PER GLYPH
 */
@@ -73,8 +143,19 @@ typedef struct {
 	GFXglyph *glyph;                                        /**< \brief Glyph array*/
 	uint8_t   first, last;                                  /**< \brief ASCII extents*/
 	uint8_t   yAdvance;                                     /**< \brief Newline distance (y axis)*/
+	uint8_t   flags;                                        /**< \brief Bitmap format, 0 for plain Adafruit fonts or #TFT_FONT_RLE*/
 } GFXfont;
 
+/** 
+* \brief GFXfont->flags: the glyph bitmaps are run length coded
+*
+* Each byte is one pair of runs in raster order over the whole glyph, the
+* high nibble counts clear and the low nibble the following set pixels. A
+* zero byte ends the glyph early, the remaining pixels are clear. Such
+* fonts are written by the host tool fontsubset (host/tools).
+*/
+#define TFT_FONT_RLE                0x01
+
 /** 
 * \brief Screen rotation
 */
@@ -123,6 +204,36 @@ typedef enum{
  */
 void TFT_init();
 
+/**
+ * \brief   Gets the number of SPI TX service routine runs since #TFT_init (interrupts with #CFG_TFT_SPI_TX_IRQ, otherwise polled kicks)
+ * \return  number of runs
+ */
+uint32_t TFT_getTxIsrCount(void);
+
+/**
+ * \brief   Gets the number of times a producer found the ringbuffer full and waited for room since #TFT_init
+ * \return  number of waits, 0 without #CFG_TFT_SPI_TX_IRQ
+ */
+uint32_t TFT_getTxWaitCount(void);
+
+/**
+ * \brief   SPI TX interrupt, to be called by the category 2 ISR isr_tftTx with #CFG_TFT_TX_BLOCKING
+ * \return  none
+ */
+void TFT_txIsr(void);
+
+/**
+ * \brief   Gets the number of DMA transfers (TD chains) started since #TFT_init, 0 without #CFG_TFT_DMA
+ * \return  number of transfers
+ */
+uint32_t TFT_getDmaCount(void);
+
+/**
+ * \brief   End of a DMA transfer, to be called by the category 2 ISR on the nrq of #CFG_TFT_DMA_MODULE
+ * \return  none
+ */
+void TFT_dmaIsr(void);
+
 //-------------------------------------[Screen API]
 
 /**
@@ -176,6 +287,23 @@ void TFT_clearScreen(void);
  */
 void TFT_fillScreen(TFT_color_t color);
 
+/**
+ * \brief   Starts recording a frame. Until #TFT_endFrame the draw functions only record their
+ *          dirty rectangle, nothing is sent to the TFT. Needs #CFG_TFT_STRIP, otherwise drawing stays immediate.
+ * \return  none
+ * \note    Must not be mixed with drawing from other tasks or ISRs, the rotation must not change within a frame.
+ */
+void TFT_beginFrame(void);
+
+/**
+ * \brief   Rasterises the recorded frame into a strip buffer of #CFG_TFT_STRIP_LINES lines and sends every
+ *          dirty strip with as few address windows as possible. With #CFG_TFT_STRIP_SKIP full width strips
+ *          with the same content hash as in the last frame are skipped. With a palette (#CFG_TFT_STRIP_BPP 8 or 4) the recorded colors
+ *          get indices in the order of their first use.
+ * \return  none
+ */
+void TFT_endFrame(void);
+
 /**
  * \brief   Sets the foreground and background color, needed for #TFT_print, #TFT_write, #TFT_println, #TFT_printf etc.
  * \param   color
@@ -364,6 +492,20 @@ int16_t TFT_getCursorY(void);
  */
 void TFT_drawChar(int16_t x, int16_t y, unsigned char c, TFT_color_t color, uint16_t bg, uint8_t size);
 
+/**
+ * \brief   Drops all glyphs of the glyph cache, see #CFG_TFT_GLYPH_CACHE
+ * \return  none
+ */
+void TFT_clearGlyphCache(void);
+
+/**
+ * \brief   Gets the hit statistics of the glyph cache since #TFT_init
+ * \param   number of opaque classic font characters streamed from the cache (may be NULL)
+ * \param   number of opaque classic font characters which had to be expanded (may be NULL)
+ * \return  none
+ */
+void TFT_getGlyphCacheStats(uint32_t *hits, uint32_t *misses);
+
 /**
  * \brief   Sets the text cursor to a position, needed for #TFT_print, #TFT_write, #TFT_println, #TFT_printf etc.
  * \param   x position of the cursor
@@ -393,6 +535,12 @@ void TFT_setTextWrap(boolean_t w);
  */
 void TFT_setTextSize(uint8_t s);
 
+/**
+ * \brief   Gets the text size
+ * \return  text size
+ */
+uint8_t TFT_getTextSize(void);
+
 /**
  * \brief   Sets the font, which shall be used for all text functions.
  * \param   font
@@ -413,6 +561,35 @@ void TFT_setFont(const GFXfont *f);
  */
 void TFT_getTextBounds(char *string, int16_t x, int16_t y,  int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
 
+/**
+ * \brief   Gets the hit statistics of the #TFT_getTextBounds cache since #TFT_init, see #CFG_TFT_BOUNDS_CACHE
+ *
+ * Strings are looked up by hash, length, font and text size. Strings with a
+ * newline and strings which wrap at the given position are always measured.
+ * \param   number of strings whose bounds came from the cache (may be NULL)
+ * \param   number of strings which had to be measured (may be NULL)
+ * \return  none
+ */
+void TFT_getBoundsCacheStats(uint32_t *hits, uint32_t *misses);
+
+/**
+ * \brief   Width of a number of digits in the current font and text size
+ *
+ * Uses the widest digit, which is the advance of every digit for fonts with
+ * tabular digits (all fonts in fonts/). Meant to reserve room for right
+ * aligned or centred values. The advances are kept in a table per font.
+ * \param   number of digits
+ * \return  cursor advance in pixels
+ */
+uint16_t TFT_getDigitsWidth(uint8_t digits);
+
+/**
+ * \brief   Width of a decimal number in the current font and text size, as printed by #TFT_printf("%ld")
+ * \param   the number
+ * \return  cursor advance in pixels, wrapping is not considered
+ */
+uint16_t TFT_getNumberWidth(int32_t value);
+
 /**
  * \brief   Write a single char with current position and settings
  * \param   char
@@ -444,14 +621,172 @@ void TFT_printInt(uint16_t num);
  */
 #define TFT_printf(...) {char tft_buf[CFG_TFT_SPRINTF_BUF_L]; sprintf(tft_buf,__VA_ARGS__); TFT_print(tft_buf);}
 
+//-------------------------------------[text field API]
+
+/**
+ * \brief   Creates a fixed pitch text field which only redraws changed characters.
+ *          The current text colors and text size are used.
+ * \param   x position of the field (classic font: top left, custom font: left end of the baseline)
+ * \param   y position of the field
+ * \param   width of the field in characters (max #CFG_TFT_FIELD_LEN)
+ * \param   font, NULL for the classic font. Custom fonts use the widest glyph as pitch.
+ * \return  handle of the field, #TFT_FIELD_INVALID if all #CFG_TFT_FIELDS are in use
+ */
+TFT_field_t TFT_field_create(int16_t x, int16_t y, uint8_t width_chars, const GFXfont *font);
+
+/**
+ * \brief   Shows a text in a field. Only character cells which differ from the shown text are drawn,
+ *          the old character is overwritten with the background color, no clear is needed.
+ * \param   handle of the field
+ * \param   text, shorter texts are padded with blanks, longer ones are cut. Characters outside
+ *          the font of the field are shown as blanks (erased cells if the font has no ' ')
+ * \return  RC_SUCCESS, RC_ERROR_BAD_PARAM for an invalid handle, RC_ERROR_NULL
+ */
+RC_t TFT_field_set(TFT_field_t field, const char *text);
+
+/**
+ * \brief   Forgets the shown text, e.g. after the screen was cleared. The next #TFT_field_set draws all cells.
+ * \param   handle of the field
+ * \return  none
+ */
+void TFT_field_invalidate(TFT_field_t field);
+
+//-------------------------------------[console API]
+
+/**
+ * \brief   Starts the console mode: text lines are added at the bottom of a band of the screen and the
+ *          band scrolls up by one line with the hardware vertical scrolling instead of being redrawn.
+ *          The band is cleared, the rows above and below it stay fixed. Lines use the classic font with
+ *          the current text colors and text size. Other drawing into the band lands at its unscrolled position.
+ *          Only in #TFT_rot_180, where the screen rows are the rows of the frame memory, and not within
+ *          #TFT_beginFrame / #TFT_endFrame. #TFT_setRotation stops the console.
+ * \param   rows fixed at the top of the screen
+ * \param   rows fixed at the bottom of the screen, rows which do not make a whole line are added to them
+ * \return  RC_SUCCESS, RC_ERROR_BAD_PARAM if no line fits or for another rotation, RC_ERROR_INVALID_STATE in a frame,
+ *          RC_ERROR_NOT_IMPLEMENTED without #CFG_TFT_CONSOLE
+ */
+RC_t TFT_console_start(uint8_t top, uint8_t bottom);
+
+/**
+ * \brief   Adds a line to the console. Once the band is full, the oldest line is overwritten and the band
+ *          scrolls, one line of pixels is sent per call.
+ * \param   text, cut at the right edge. A '\n' starts another line.
+ * \return  RC_SUCCESS, RC_ERROR_NULL, RC_ERROR_INVALID_STATE if the console is not started
+ */
+RC_t TFT_console_print(const char *text);
+
+/**
+ * \brief   Stops the console mode, the display shows the frame memory unscrolled again and the band is cleared.
+ * \return  none
+ */
+void TFT_console_stop(void);
+
+//-------------------------------------[draw queue API]
+
+/**
+ * \brief   Queues a filled rectangle for #CFG_TFT_QUEUE_TASK. The queue functions copy their arguments
+ *          into the queue and return without touching the SPI, they may be called from any task.
+ * \param   x position
+ * \param   y position
+ * \param   width
+ * \param   height
+ * \param   color
+ * \return  RC_SUCCESS, RC_ERROR_BAD_PARAM for an empty rectangle, RC_ERROR_BUFFER_FULL,
+ *          RC_ERROR_NOT_IMPLEMENTED without #CFG_TFT_QUEUE
+ */
+RC_t TFT_queue_fill(int16_t x, int16_t y, int16_t w, int16_t h, TFT_color_t color);
+
+/**
+ * \brief   Queues a text in the classic font, see #TFT_queue_fill
+ * \param   x position of the top left corner
+ * \param   y position of the top left corner
+ * \param   text, cut to #CFG_TFT_QUEUE_TEXT characters
+ * \param   text color
+ * \param   background color, equal to the text color = transparent
+ * \param   text size
+ * \return  RC_SUCCESS, RC_ERROR_NULL, RC_ERROR_BAD_PARAM for size 0, RC_ERROR_BUFFER_FULL,
+ *          RC_ERROR_NOT_IMPLEMENTED without #CFG_TFT_QUEUE
+ */
+RC_t TFT_queue_text(int16_t x, int16_t y, const char *text, TFT_color_t color, TFT_color_t bg, uint8_t size);
+
+/**
+ * \brief   Queues a right aligned decimal number in the classic font, see #TFT_queue_fill.
+ *          It is formatted by the render task, too many digits are shown as '#'.
+ * \param   x position of the top left corner
+ * \param   y position of the top left corner
+ * \param   value
+ * \param   width in characters including the sign, 1 ... 11
+ * \param   text color
+ * \param   background color, equal to the text color = transparent
+ * \param   text size
+ * \return  RC_SUCCESS, RC_ERROR_BAD_PARAM for the width or size 0, RC_ERROR_BUFFER_FULL,
+ *          RC_ERROR_NOT_IMPLEMENTED without #CFG_TFT_QUEUE
+ */
+RC_t TFT_queue_number(int16_t x, int16_t y, int32_t value, uint8_t digits, TFT_color_t color, TFT_color_t bg, uint8_t size);
+
+/**
+ * \brief   Draws the queued commands, called by #CFG_TFT_QUEUE_TASK on #CFG_TFT_QUEUE_EVENT.
+ *          A command which is covered completely by a later opaque command of the same batch
+ *          is dropped. Commands queued meanwhile are drawn before returning.
+ * \return  Number of commands drawn
+ */
+uint8_t TFT_queue_render(void);
+
+/**
+ * \brief   Gets the statistics of the draw queue since #TFT_init
+ * \param   number of commands drawn (may be NULL)
+ * \param   number of commands dropped as overdrawn (may be NULL)
+ * \return  none
+ */
+void TFT_getQueueStats(uint32_t *drawn, uint32_t *dropped);
+
+//-------------------------------------[bitmap API]
+
+/**
+ * \brief   Draws an RGB565 image through one address window, the pixels outside the screen are skipped.
+ *          Only the visible pixels are sent, 2 bytes each. A recorded frame is rendered first, the image
+ *          itself is drawn immediately.
+ * \param   x position of the top left corner, may be outside the screen
+ * \param   y position of the top left corner, may be outside the screen
+ * \param   width
+ * \param   height
+ * \param   w * h pixels in row order
+ * \return  none
+ */
+void TFT_drawBitmap565(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *bitmap);
+
+/**
+ * \brief   Draws a 1 bit image like #TFT_drawBitmap565, set bits in the foreground color, cleared bits in the background color
+ * \param   x position of the top left corner, may be outside the screen
+ * \param   y position of the top left corner, may be outside the screen
+ * \param   width
+ * \param   height
+ * \param   rows of (w + 7) / 8 bytes, most significant bit first
+ * \param   foreground color
+ * \param   background color
+ * \return  none
+ */
+void TFT_drawBitmap1(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *bitmap, TFT_color_t fg, TFT_color_t bg);
+
+/**
+ * \brief   Draws an RGB565 image like #TFT_drawBitmap565, the pixels are fetched in chunks from a source,
+ *          e.g. a ringbuffer filled by the UART or a flash reader. All w * h pixels are fetched, also the invisible ones.
+ * \param   x position of the top left corner, may be outside the screen
+ * \param   y position of the top left corner, may be outside the screen
+ * \param   width
+ * \param   height
+ * \param   source of the pixels
+ * \param   argument of the source
+ * \return  RC_SUCCESS, RC_ERROR_NULL, RC_ERROR_BAD_PARAM for a negative size,
+ *          RC_ERROR_BUFFER_EMTPY if the source ended early, the rest of the image is black
+ */
+RC_t TFT_drawBitmapStream(int16_t x, int16_t y, int16_t w, int16_t h, TFT_pixel_source_t source, void *arg);
+
 //TODO
 /*
 void
-    TFT_drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color),
-    TFT_drawBitmap_w_BG(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg),
     TFT_drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h),
     TFT_drawGrayscaleBitmap_masked(int16_t x, int16_t y, uint8_t *bitmap, uint8_t *mask, int16_t w, int16_t h),
-    TFT_drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h),
     TFT_drawRGBBitmap_masked(int16_t x, int16_t y, uint16_t *bitmap, uint8_t *mask, int16_t w, int16_t h);
  */      
         
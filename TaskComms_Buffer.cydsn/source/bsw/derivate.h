@@ -35,8 +35,10 @@
 
 //-------------------------------------------------------------------- [Target Selection]
 
-/** \brief Target selection by Identifier */
+/** \brief Target selection by Identifier, can be overridden by the build (e.g. host build) */
+#ifndef TARGET_ID
 #define TARGET_ID   			    TARGET_PSOC5LP
+#endif
 
 //------------------------------------- [supported targets, select from here]
 
@@ -61,6 +63,7 @@
 // ------------------------- [ others ]
 
 #define TARGET_ESP32				30		 /**< \brief Target is a Espressif ESP32*/
+#define TARGET_HOST				    40		 /**< \brief Target is a POSIX host (simulation build)*/
 
 
 
@@ -71,6 +74,7 @@
 #define ARCH_PSOC			        1		/**< \brief Target is a Cypress PSoC */
 #define ARCH_AURIX_1G				2		/**< \brief Target is a Infineon AURIX Gernation 1 */
 #define ARCH_ESP32			        3		/**< \brief Target is a Espressif ESP32 */
+#define ARCH_HOST			        4		/**< \brief Target is a POSIX host */
 
 
 //---------------------------------------------- [common symbols]
@@ -118,6 +122,10 @@
     #define ARCHITECTURE			ARCH_ESP32
 	#define DERIVATE_NAME   		ESP32
 	#define DERIVATE_NUM_CORES		2
+#elif (TARGET_ID==TARGET_HOST)
+    #define ARCHITECTURE			ARCH_HOST
+	#define DERIVATE_NAME   		HOST
+	#define DERIVATE_NUM_CORES		1
 #endif
 
 
@@ -69,6 +69,8 @@
     //#include <project.h>    //Delay etc. 
 #elif(ARCHITECTURE== ARCH_ESP32)
 
+#elif(ARCHITECTURE== ARCH_HOST)
+    #include <stdint.h>     //LP64 host, the fixed width types below would not match
 #else
 #error "Unknown Target"
 #endif
@@ -135,12 +137,25 @@
         vTaskDelayUntil( &__LastWakeTime,   \
         ms*portTICK_PERIOD_MS);}            \
 
+#elif(ARCHITECTURE==ARCH_HOST)
+    #define DELAY_MS(ms)    CyDelay(ms)         				/**< \brief milliseconds Delay Macro, provided by the host stubs*/
+    #define DELAY_US(us)    CyDelayUs(us)       				/**< \brief microseconds Delay Macro, provided by the host stubs*/
+
+	#define PPCAT_NX(A, B)  A ## _ ## B							/**< \brief Concatenate tokens, see PSoC */
+	#define PPCAT(A, B)     PPCAT_NX(A, B)						/**< \brief Concatenate tokens after expansion, see PSoC */
+
 #else /*(ARCHITECTURE== ARCH_PSOC)*/
 	#error "Unknown Target"
 #endif
 
 //-------------------------------------------------------------------- [Datatypes and related definitions]
 
+#if(ARCHITECTURE==ARCH_HOST)
+typedef int8_t                  sint8_t;            /**< \brief         -128 .. +127            */
+typedef int16_t                 sint16_t;           /**< \brief       -32768 .. +32767          */
+typedef int32_t                 sint32_t;           /**< \brief  -2147483648 .. +2147483647     */
+typedef int64_t                 sint64_t;           /**< \brief -9223372036854775808 .. +9223372036854775807     */
+#else
 typedef signed 		char    	sint8_t;            /**< \brief         -128 .. +127            */
 typedef unsigned 	char  		uint8_t;            /**< \brief            0 .. 255             */
 typedef signed 		short   	sint16_t;           /**< \brief       -32768 .. +32767          */
@@ -149,10 +164,11 @@ typedef signed 		long    	sint32_t;           /**< \brief  -2147483648 .. +21474
 #ifndef uint32_t
 typedef unsigned 	long  		uint32_t;           /**< \brief            0 .. 4294967295      */
 #endif
-typedef 			float   	float32_t;	        /**< \brief  single precision floating point number (4 byte) */
-typedef 			double  	float64_t;	        /**< \brief  double precision floating point number (8 byte) */
 typedef signed 		long long   sint64_t;           /**< \brief -9223372036854775808 .. +9223372036854775807     */
 typedef unsigned 	long long 	uint64_t;           /**< \brief                    0 .. 18446744073709551615     */
+#endif
+typedef 			float   	float32_t;	        /**< \brief  single precision floating point number (4 byte) */
+typedef 			double  	float64_t;	        /**< \brief  double precision floating point number (8 byte) */
 typedef unsigned	char  		boolean_t; 	        /**< \brief  for use with TRUE/FALSE        */
 typedef 			char    	char_t;		        /**< \brief	Character Datatype*/
 
@@ -0,0 +1,165 @@
+/**
+* \file cpuload.c
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief CPU load measurement based on idle loop iterations
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <project.h>
+#include "global.h"
+#include "cpuload.h"
+#include "logging.h"
+
+/*****************************************************************************/
+/* Local definitions                                                         */
+/*****************************************************************************/
+
+#if (ARCHITECTURE==ARCH_PSOC)
+    #define CPULOAD_CLK_HZ          BCLK__BUS_CLK__HZ                   /**< \brief Cycle counter frequency, DWT runs with the CPU clock */
+    #define CPULOAD_CYCLES()        (DWT->CYCCNT)                       /**< \brief Free running 32 bit cycle counter */
+    /** \brief Enable the DWT cycle counter (trace has to be enabled first) */
+    #define CPULOAD_CYCLES_START()                          \
+    {                                                       \
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     \
+        DWT->CYCCNT = 0;                                    \
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                \
+    }
+#elif (ARCHITECTURE==ARCH_HOST)
+    #define CPULOAD_CLK_HZ          HOST_CYCLES_HZ                      /**< \brief Host counter frequency, see host stubs */
+    #define CPULOAD_CYCLES()        HOST_getCycles()                    /**< \brief Free running 32 bit counter of the host stubs */
+    #define CPULOAD_CYCLES_START()  {}                                  /**< \brief Host counter is always running */
+#else
+    #error "No cycle counter for this architecture"
+#endif
+
+/** \brief Length of one measurement window in cycles */
+#define CPULOAD_WINDOW_CYCLES       ((uint32_t)(CPULOAD_CLK_HZ / 1000u) * CFG_CPULOAD_WINDOW_MS)
+
+/*****************************************************************************/
+/* Local variables                                                           */
+/*****************************************************************************/
+
+static const char* TAG = "CPU";
+
+static uint32_t cpuload_baseline;       /**< \brief Idle iterations of one window without load, 0 while calibrating */
+static uint32_t cpuload_idleCount;      /**< \brief Idle iterations of the current window */
+static uint32_t cpuload_windowStart;    /**< \brief Cycle counter value at the start of the current window */
+static uint16_t cpuload_windows;        /**< \brief Completed windows since the last log output */
+static uint8_t  cpuload_load;           /**< \brief Load of the last completed window in % */
+static uint8_t  cpuload_peak;           /**< \brief Highest load seen in % */
+
+/*****************************************************************************/
+/* API functions                                                             */
+/*****************************************************************************/
+
+/**
+ * Start the cycle counter and measure the idle baseline for one window.
+ * @return RC_SUCCESS
+ */
+RC_t CPULOAD_init(void)
+{
+    CPULOAD_CYCLES_START();
+
+    cpuload_baseline    = 0;
+    cpuload_idleCount   = 0;
+    cpuload_windows     = 0;
+    cpuload_load        = 0;
+    cpuload_peak        = 0;
+    cpuload_windowStart = CPULOAD_CYCLES();
+
+    /* Run the regular idle path, so baseline and measurement cost the same. */
+    while (0 == cpuload_baseline)
+    {
+        CPULOAD_idle();
+    }
+
+    LOG_I(TAG, "Baseline %lu idle loops / %u ms", (unsigned long)cpuload_baseline, CFG_CPULOAD_WINDOW_MS);
+
+    return RC_SUCCESS;
+}
+
+/**
+ * Count one idle iteration and evaluate the window once it has elapsed.
+ */
+void CPULOAD_idle(void)
+{
+    uint32_t now = CPULOAD_CYCLES();
+
+    cpuload_idleCount++;
+
+    if ((uint32_t)(now - cpuload_windowStart) < CPULOAD_WINDOW_CYCLES)
+    {
+        return;
+    }
+
+    uint32_t idleCount = cpuload_idleCount;
+
+    /* Next window starts at the end of this one, so logging is accounted to it. */
+    cpuload_idleCount   = 0;
+    cpuload_windowStart = now;
+
+    /* The first window after init is the unloaded reference. */
+    if (0 == cpuload_baseline)
+    {
+        cpuload_baseline = idleCount;
+    }
+    else
+    {
+        uint32_t idle = (idleCount * 100u) / cpuload_baseline;
+
+        cpuload_load = (idle >= 100u) ? 0 : (uint8_t)(100u - idle);
+        if (cpuload_load > cpuload_peak)
+        {
+            cpuload_peak = cpuload_load;
+        }
+
+#if (CFG_CPULOAD_LOG_WINDOWS > 0)
+        if (++cpuload_windows >= CFG_CPULOAD_LOG_WINDOWS)
+        {
+            cpuload_windows = 0;
+            LOG_I(TAG, "Load %u%% Peak %u%%", cpuload_load, cpuload_peak);
+        }
+#endif
+    }
+}
+
+/**
+ * Load of the last completed window.
+ * @return CPU utilization in %
+ */
+uint8_t CPULOAD_getLoad(void)
+{
+    return cpuload_load;
+}
+
+/**
+ * Highest load since init or the last reset.
+ * @return CPU utilization in %
+ */
+uint8_t CPULOAD_getPeak(void)
+{
+    return cpuload_peak;
+}
+
+/**
+ * Restart peak tracking with the current load.
+ */
+void CPULOAD_resetPeak(void)
+{
+    cpuload_peak = cpuload_load;
+}
+
+/* [cpuload.c] END OF FILE */
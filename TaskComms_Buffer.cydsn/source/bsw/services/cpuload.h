@@ -0,0 +1,76 @@
+/**
+* \file cpuload.h
+* \author V.S. Agilan
+* \date 18.10.26
+*
+* \brief CPU load measurement based on idle loop iterations
+*
+* The lowest priority task calls #CPULOAD_idle in its endless loop. The number
+* of idle iterations per measurement window is compared against a baseline,
+* which is recorded by #CPULOAD_init while no other task is active.
+*
+* Copyright YOUR COMPANY, THE YEAR
+* All Rights Reserved
+* UNPUBLISHED, LICENSED SOFTWARE.
+*
+* CONFIDENTIAL AND PROPRIETARY INFORMATION
+* WHICH IS THE PROPERTY OF your company.
+*
+* ========================================
+*/
+
+#ifndef CPULOAD_H
+#define CPULOAD_H
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include "global.h"
+
+/*****************************************************************************/
+/* Configuration                                                             */
+/*****************************************************************************/
+
+#define CFG_CPULOAD_WINDOW_MS       100     /**< \brief Length of one measurement window in milliseconds */
+#define CFG_CPULOAD_LOG_WINDOWS     50      /**< \brief Log load and peak every N windows via LOG_I, 0 disables logging */
+
+/*****************************************************************************/
+/* API functions                                                             */
+/*****************************************************************************/
+
+/**
+ * \brief Starts the cycle counter and records the idle baseline
+ *
+ * Blocks for one measurement window. Must be called before any other task
+ * is activated, otherwise the baseline (= 0% load) is too low.
+ * @return RC_SUCCESS
+ */
+RC_t CPULOAD_init(void);
+
+/**
+ * \brief Counts one idle iteration, closes the window once it has elapsed
+ *
+ * To be called from the endless loop of the lowest priority task.
+ */
+void CPULOAD_idle(void);
+
+/**
+ * \brief Load of the last completed measurement window
+ * @return CPU utilization in % (0-100)
+ */
+uint8_t CPULOAD_getLoad(void);
+
+/**
+ * \brief Highest load of all windows since init or #CPULOAD_resetPeak
+ * @return CPU utilization in % (0-100)
+ */
+uint8_t CPULOAD_getPeak(void);
+
+/**
+ * \brief Restarts peak tracking
+ */
+void CPULOAD_resetPeak(void);
+
+#endif /*CPULOAD_H*/
+
+/* [cpuload.h] END OF FILE */
@@ -48,6 +48,7 @@ RC_t LOG_Init(void){
     MODULE_LOG(PutString)("UART started");
     MODULE_LOG(PutString)(CFG_LOGGING_NL_CHAR);
 
+    return RC_SUCCESS;
 #else
     return RC_ERROR_INVALID_STATE;
 #endif
@@ -42,7 +42,7 @@
 */
 
 #define CFG_TFT_ORIENTATION         TFT_rot_180  
-#define CFG_TFT_RB_OUT_SZ           100                     /**< \brief TFT Ringbuffer OUT size for SPI communication*/
+#define CFG_TFT_RB_OUT_SZ           800                     /**< \brief TFT Ringbuffer OUT size in bytes for SPI communication, holds packed command and data records*/
 #define CFG_TFT_BACKLIGHT           100                     /**< \brief TFT backlight brightness after start (0-100). Can be adjusted with #TFT_setBacklight during runtime*/
 #define CFG_TFT_SPRINTF_BUF_L       128                     /**< \brief Buffer length for #TFT_printf */   
 #define CFG_TFT_COLOR_TEXT          WHITE                   /**< \brief Default text color */